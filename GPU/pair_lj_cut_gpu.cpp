@@ -65,6 +65,8 @@ PairLJCutGPU::PairLJCutGPU(LAMMPS *lmp) : PairLJCut(lmp), gpu_mode(GPU_FORCE)
 {
   respa_enable = 0;
   cpu_time = 0.0;
+  // compute() does not support split calls over ilist
+  overlap_flag = 0;
   GPU_EXTRA::gpu_ready(lmp->modify, lmp->error); 
 }
 
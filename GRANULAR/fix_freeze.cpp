@@ -37,6 +37,7 @@ FixFreeze::FixFreeze(LAMMPS *lmp, int narg, char **arg) :
   size_vector = 3;
   global_freq = 1;
   extvector = 1;
+  fuse_flag = 1;
 
   force_flag = 0;
   foriginal[0] = foriginal[1] = foriginal[2] = 0.0;
@@ -85,16 +86,28 @@ void FixFreeze::setup(int vflag)
 
 void FixFreeze::post_force(int vflag)
 {
-  double **f = atom->f;
-  double **torque = atom->torque;
-  int *mask = atom->mask;
-  int nlocal = atom->nlocal;
-  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+  post_force_setup(vflag);
+  post_force_range(0,atom->nlocal);
+}
 
+/* ---------------------------------------------------------------------- */
+
+void FixFreeze::post_force_setup(int vflag)
+{
   foriginal[0] = foriginal[1] = foriginal[2] = 0.0;
   force_flag = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixFreeze::post_force_range(int ifirst, int ilast)
+{
+  double **f = atom->f;
+  double **torque = atom->torque;
+  int *mask = atom->mask;
+  if (igroup == atom->firstgroup) ilast = MIN(ilast,atom->nfirst);
 
-  for (int i = 0; i < nlocal; i++)
+  for (int i = ifirst; i < ilast; i++)
     if (mask[i] & groupbit) {
       foriginal[0] += f[i][0];
       foriginal[1] += f[i][1];
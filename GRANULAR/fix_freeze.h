@@ -32,6 +32,8 @@ class FixFreeze : public Fix {
   void setup(int);
   void post_force(int);
   void post_force_respa(int, int, int);
+  void post_force_setup(int);
+  void post_force_range(int, int);
   double compute_vector(int);
 
  private:
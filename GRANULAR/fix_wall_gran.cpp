@@ -26,6 +26,9 @@
 #include "pair.h"
 #include "modify.h"
 #include "respa.h"
+#include "neighbor.h"
+#include "mesh_bvh.h"
+#include "my_page.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -34,10 +37,14 @@ using namespace LAMMPS_NS;
 using namespace FixConst;
 using namespace MathConst;
 
-enum{XPLANE,YPLANE,ZPLANE,ZCYLINDER};    // XYZ PLANE need to be 0,1,2
+enum{XPLANE,YPLANE,ZPLANE,ZCYLINDER,MESH};    // XYZ PLANE need to be 0,1,2
 enum{HOOKE,HOOKE_HISTORY,HERTZ_HISTORY};
 
 #define BIG 1.0e20
+#define MAXMESHTOUCH 6        // max # of triangles one atom keeps history for
+#define MAXMESHCAND 1024      // max # of candidate triangles per atom
+#define MESHPGSIZE 65536      // size of candidate triangle pages
+#define EPSMESH 1.0e-8        // rel tolerance for identical contact points
 
 /* ---------------------------------------------------------------------- */
 
@@ -80,6 +87,8 @@ FixWallGran::FixWallGran(LAMMPS *lmp, int narg, char **arg) :
 
   // wallstyle args
 
+  mesh = NULL;
+
   int iarg = 9;
   if (strcmp(arg[iarg],"xplane") == 0) {
     if (narg < iarg+3) error->all(FLERR,"Illegal fix wall/gran command");
@@ -111,6 +120,13 @@ FixWallGran::FixWallGran(LAMMPS *lmp, int narg, char **arg) :
     lo = hi = 0.0;
     cylradius = atof(arg[iarg+1]);
     iarg += 2;
+  } else if (strcmp(arg[iarg],"mesh") == 0) {
+    if (narg < iarg+2) error->all(FLERR,"Illegal fix wall/gran command");
+    wallstyle = MESH;
+    lo = hi = 0.0;
+    mesh = new MeshBVH(lmp);
+    mesh->read_stl(arg[iarg+1]);
+    iarg += 2;
   }
   
   // check for trailing keyword/values
@@ -151,6 +167,8 @@ FixWallGran::FixWallGran(LAMMPS *lmp, int narg, char **arg) :
     error->all(FLERR,"Cannot use wall in periodic dimension");
 
   if (wiggle && wshear) error->all(FLERR,"Cannot wiggle and shear fix wall/gran");
+  if ((wiggle || wshear) && wallstyle == MESH)
+    error->all(FLERR,"Cannot wiggle or shear fix wall/gran mesh");
   if (wiggle && wallstyle == ZCYLINDER && axis != 2)
     error->all(FLERR,"Invalid wiggle direction for fix wall/gran");
   if (wshear && wallstyle == XPLANE && axis == 0)
@@ -164,9 +182,27 @@ FixWallGran::FixWallGran(LAMMPS *lmp, int narg, char **arg) :
 
   if (wiggle) omega = 2.0*MY_PI / period;
 
+  // candidate triangles of mesh wall, built in pre_neighbor()
+  // empty box so first pre_neighbor() filters the triangles
+
+  meshlo[0] = meshlo[1] = meshlo[2] = BIG;
+  meshhi[0] = meshhi[1] = meshhi[2] = -BIG;
+  maxcand = 0;
+  numcand = NULL;
+  firstcand = NULL;
+  candbuf = NULL;
+  cpage = NULL;
+  if (wallstyle == MESH) {
+    memory->create(candbuf,MAXMESHCAND,"fix_wall_gran:candbuf");
+    cpage = new MyPage<int>(MAXMESHCAND,MESHPGSIZE);
+  }
+
   // perform initial allocation of atom-based arrays
   // register with Atom class
 
+  if (wallstyle == MESH) nshear = 4*MAXMESHTOUCH;
+  else nshear = 3;
+
   shear = NULL;
   grow_arrays(atom->nmax);
   atom->add_callback(0);
@@ -175,8 +211,7 @@ FixWallGran::FixWallGran(LAMMPS *lmp, int narg, char **arg) :
   // initialize as if particle is not touching wall
 
   int nlocal = atom->nlocal;
-  for (int i = 0; i < nlocal; i++)
-    shear[i][0] = shear[i][1] = shear[i][2] = 0.0;
+  for (int i = 0; i < nlocal; i++) set_arrays(i);
 
   time_origin = update->ntimestep;
   laststep = -1;
@@ -194,6 +229,12 @@ FixWallGran::~FixWallGran()
   // delete locally stored arrays
 
   memory->destroy(shear);
+
+  delete mesh;
+  delete cpage;
+  memory->destroy(numcand);
+  memory->sfree(firstcand);
+  memory->destroy(candbuf);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -203,6 +244,7 @@ int FixWallGran::setmask()
   int mask = 0;
   mask |= POST_FORCE;
   mask |= POST_FORCE_RESPA;
+  if (wallstyle == MESH) mask |= PRE_NEIGHBOR;
   return mask;
 }
 
@@ -228,12 +270,17 @@ void FixWallGran::init()
   else if (force->pair_match("gran/hertz/history/omp",1))
     pairstyle = HERTZ_HISTORY;
   else error->all(FLERR,"Fix wall/gran is incompatible with Pair style");
+
+  if (wallstyle == MESH && domain->triclinic)
+    error->all(FLERR,"Fix wall/gran mesh cannot be used with triclinic box");
 }
 
 /* ---------------------------------------------------------------------- */
 
 void FixWallGran::setup(int vflag)
 {
+  if (wallstyle == MESH) pre_neighbor();
+
   if (strstr(update->integrate_style,"verlet"))
     post_force(vflag);
   else {
@@ -245,10 +292,84 @@ void FixWallGran::setup(int vflag)
 
 /* ---------------------------------------------------------------------- */
 
+void FixWallGran::pre_neighbor()
+{
+  // triangles near my sub-domain, extended by max neighbor cutoff
+  //   so atoms moving up to half the skin before next reneighbor are covered
+  // hierarchy is built once, triangles are only refiltered
+  //   if sub-domain or cutoff changed
+
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+  double cut = neighbor->cutneighmax;
+  double boxlo[3],boxhi[3];
+
+  int change = 0;
+  for (int k = 0; k < 3; k++) {
+    boxlo[k] = sublo[k] - cut;
+    boxhi[k] = subhi[k] + cut;
+    if (boxlo[k] != meshlo[k] || boxhi[k] != meshhi[k]) change = 1;
+  }
+
+  if (change) {
+    mesh->setup(boxlo,boxhi);
+    for (int k = 0; k < 3; k++) {
+      meshlo[k] = boxlo[k];
+      meshhi[k] = boxhi[k];
+    }
+  }
+
+  // candidate triangles of each atom are valid until next reneighbor
+  // since atoms move less than half the skin in between
+
+  if (atom->nmax > maxcand) {
+    maxcand = atom->nmax;
+    memory->destroy(numcand);
+    memory->sfree(firstcand);
+    memory->create(numcand,maxcand,"fix_wall_gran:numcand");
+    firstcand = (int **)
+      memory->smalloc(maxcand*sizeof(int *),"fix_wall_gran:firstcand");
+  }
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double skin = neighbor->skin;
+
+  cpage->reset();
+
+  for (int i = 0; i < nlocal; i++) {
+    numcand[i] = 0;
+    firstcand[i] = NULL;
+    if (!(mask[i] & groupbit)) continue;
+
+    int n = mesh->query(x[i],radius[i]+skin,candbuf,MAXMESHCAND);
+    if (n == 0) continue;
+    if (n > MAXMESHCAND)
+      error->one(FLERR,"Too many mesh triangles near one particle");
+
+    int *ptr = cpage->get(n);
+    if (ptr == NULL)
+      error->one(FLERR,
+                 "Fix wall/gran mesh ran out of memory for candidate triangles");
+    memcpy(ptr,candbuf,n*sizeof(int));
+    firstcand[i] = ptr;
+    numcand[i] = n;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
 void FixWallGran::post_force(int vflag)
 {
   double vwall[3],dx,dy,dz,del1,del2,delxy,delr,rsq;
 
+  if (wallstyle == MESH) {
+    post_force_mesh();
+    return;
+  }
+
   // set position of wall to initial settings and velocity to 0.0
   // if wiggle or shear, set wall position and velocity accordingly
 
@@ -349,6 +470,113 @@ void FixWallGran::post_force(int vflag)
 
 /* ---------------------------------------------------------------------- */
 
+void FixWallGran::post_force_mesh()
+{
+  double vwall[3],delta[3],sheartmp[3];
+  double dcontact[MAXMESHTOUCH][3];
+  int touched[MAXMESHTOUCH];
+  int s;
+
+  // mesh is stationary
+  // loop over candidate triangles of each of my atoms
+  // a sphere on an edge or vertex shared by several triangles gets the
+  //   same contact from each of them, only the first one is applied
+  // shear history is kept per touching triangle,
+  //   a contact that finds no free slot is computed without history
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double **omega = atom->omega;
+  double **torque = atom->torque;
+  double *radius = atom->radius;
+  double *rmass = atom->rmass;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  vwall[0] = vwall[1] = vwall[2] = 0.0;
+
+  if (update->ntimestep > laststep) shearupdate = 1;
+  else shearupdate = 0;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+
+    double *hist = shear[i];
+    double radsq = radius[i]*radius[i];
+    int *cand = firstcand[i];
+    int ncand = numcand[i];
+    int ncontact = 0;
+    for (s = 0; s < MAXMESHTOUCH; s++) touched[s] = 0;
+
+    for (int k = 0; k < ncand; k++) {
+      int t = cand[k];
+      double rsq = mesh->distance(t,x[i],delta);
+      if (rsq > radsq) continue;
+
+      int duplicate = 0;
+      for (int c = 0; c < ncontact; c++) {
+        double ddx = dcontact[c][0] - delta[0];
+        double ddy = dcontact[c][1] - delta[1];
+        double ddz = dcontact[c][2] - delta[2];
+        if (ddx*ddx + ddy*ddy + ddz*ddz < EPSMESH*radsq) duplicate = 1;
+      }
+      if (duplicate) continue;
+      if (ncontact < MAXMESHTOUCH) {
+        dcontact[ncontact][0] = delta[0];
+        dcontact[ncontact][1] = delta[1];
+        dcontact[ncontact][2] = delta[2];
+        ncontact++;
+      }
+
+      if (pairstyle == HOOKE) {
+        hooke(rsq,delta[0],delta[1],delta[2],vwall,v[i],f[i],omega[i],
+              torque[i],radius[i],rmass[i]);
+        continue;
+      }
+
+      double *sh = NULL;
+      for (s = 0; s < MAXMESHTOUCH; s++)
+        if (static_cast<int> (hist[4*s]) == t) break;
+      if (s == MAXMESHTOUCH) {
+        for (s = 0; s < MAXMESHTOUCH; s++)
+          if (hist[4*s] < 0.0) break;
+        if (s < MAXMESHTOUCH) {
+          hist[4*s] = t;
+          hist[4*s+1] = hist[4*s+2] = hist[4*s+3] = 0.0;
+        }
+      }
+      if (s < MAXMESHTOUCH) {
+        touched[s] = 1;
+        sh = &hist[4*s+1];
+      } else {
+        sheartmp[0] = sheartmp[1] = sheartmp[2] = 0.0;
+        sh = sheartmp;
+      }
+
+      if (pairstyle == HOOKE_HISTORY)
+        hooke_history(rsq,delta[0],delta[1],delta[2],vwall,v[i],f[i],
+                      omega[i],torque[i],radius[i],rmass[i],sh);
+      else if (pairstyle == HERTZ_HISTORY)
+        hertz_history(rsq,delta[0],delta[1],delta[2],vwall,v[i],f[i],
+                      omega[i],torque[i],radius[i],rmass[i],sh);
+    }
+
+    // release history of triangles no longer touched
+
+    if (pairstyle != HOOKE)
+      for (s = 0; s < MAXMESHTOUCH; s++)
+        if (!touched[s] && hist[4*s] >= 0.0) {
+          hist[4*s] = -1.0;
+          hist[4*s+1] = hist[4*s+2] = hist[4*s+3] = 0.0;
+        }
+  }
+
+  laststep = update->ntimestep;
+}
+
+/* ---------------------------------------------------------------------- */
+
 void FixWallGran::post_force_respa(int vflag, int ilevel, int iloop)
 {
   if (ilevel == nlevels_respa-1) post_force(vflag);
@@ -683,7 +911,12 @@ double FixWallGran::memory_usage()
 {
   int nmax = atom->nmax;
   double bytes = nmax * sizeof(int);
-  bytes += 3*nmax * sizeof(double);
+  bytes += nshear*nmax * sizeof(double);
+  if (wallstyle == MESH) {
+    bytes += mesh->memory_usage();
+    bytes += maxcand * (sizeof(int) + sizeof(int *));
+    bytes += cpage->size();
+  }
   return bytes;
 }
 
@@ -693,7 +926,7 @@ double FixWallGran::memory_usage()
 
 void FixWallGran::grow_arrays(int nmax)
 {
-  memory->grow(shear,nmax,3,"fix_wall_gran:shear");
+  memory->grow(shear,nmax,nshear,"fix_wall_gran:shear");
 }
 
 /* ----------------------------------------------------------------------
@@ -702,9 +935,7 @@ void FixWallGran::grow_arrays(int nmax)
 
 void FixWallGran::copy_arrays(int i, int j)
 {
-  shear[j][0] = shear[i][0];
-  shear[j][1] = shear[i][1];
-  shear[j][2] = shear[i][2];
+  for (int m = 0; m < nshear; m++) shear[j][m] = shear[i][m];
 }
 
 /* ----------------------------------------------------------------------
@@ -713,7 +944,9 @@ void FixWallGran::copy_arrays(int i, int j)
 
 void FixWallGran::set_arrays(int i)
 {
-  shear[i][0] = shear[i][1] = shear[i][2] = 0.0;
+  for (int m = 0; m < nshear; m++) shear[i][m] = 0.0;
+  if (wallstyle == MESH)
+    for (int m = 0; m < nshear; m += 4) shear[i][m] = -1.0;
 }
 
 /* ----------------------------------------------------------------------
@@ -722,10 +955,8 @@ void FixWallGran::set_arrays(int i)
 
 int FixWallGran::pack_exchange(int i, double *buf)
 {
-  buf[0] = shear[i][0];
-  buf[1] = shear[i][1];
-  buf[2] = shear[i][2];
-  return 3;
+  for (int m = 0; m < nshear; m++) buf[m] = shear[i][m];
+  return nshear;
 }
 
 /* ----------------------------------------------------------------------
@@ -734,10 +965,8 @@ int FixWallGran::pack_exchange(int i, double *buf)
 
 int FixWallGran::unpack_exchange(int nlocal, double *buf)
 {
-  shear[nlocal][0] = buf[0];
-  shear[nlocal][1] = buf[1];
-  shear[nlocal][2] = buf[2];
-  return 3;
+  for (int m = 0; m < nshear; m++) shear[nlocal][m] = buf[m];
+  return nshear;
 }
 
 /* ----------------------------------------------------------------------
@@ -747,10 +976,8 @@ int FixWallGran::unpack_exchange(int nlocal, double *buf)
 int FixWallGran::pack_restart(int i, double *buf)
 {
   int m = 0;
-  buf[m++] = 4;
-  buf[m++] = shear[i][0];
-  buf[m++] = shear[i][1];
-  buf[m++] = shear[i][2];
+  buf[m++] = nshear + 1;
+  for (int k = 0; k < nshear; k++) buf[m++] = shear[i][k];
   return m;
 }
 
@@ -768,9 +995,7 @@ void FixWallGran::unpack_restart(int nlocal, int nth)
   for (int i = 0; i < nth; i++) m += static_cast<int> (extra[nlocal][m]);
   m++;
 
-  shear[nlocal][0] = extra[nlocal][m++];
-  shear[nlocal][1] = extra[nlocal][m++];
-  shear[nlocal][2] = extra[nlocal][m++];
+  for (int k = 0; k < nshear; k++) shear[nlocal][k] = extra[nlocal][m++];
 }
 
 /* ----------------------------------------------------------------------
@@ -779,7 +1004,7 @@ void FixWallGran::unpack_restart(int nlocal, int nth)
 
 int FixWallGran::maxsize_restart()
 {
-  return 4;
+  return nshear + 1;
 }
 
 /* ----------------------------------------------------------------------
@@ -788,7 +1013,7 @@ int FixWallGran::maxsize_restart()
 
 int FixWallGran::size_restart(int nlocal)
 {
-  return 4;
+  return nshear + 1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -24,6 +24,8 @@ FixStyle(wall/gran,FixWallGran)
 
 namespace LAMMPS_NS {
 
+template<class T> class MyPage;
+
 class FixWallGran : public Fix {
  public:
   FixWallGran(class LAMMPS *, int, char **);
@@ -31,6 +33,7 @@ class FixWallGran : public Fix {
   int setmask();
   void init();
   void setup(int);
+  void pre_neighbor();
   virtual void post_force(int);
   virtual void post_force_respa(int, int, int);
 
@@ -58,8 +61,23 @@ class FixWallGran : public Fix {
   bigint laststep;
   int *touch;
   double **shear;
+  int nshear;                 // # of values per atom in shear
   int shearupdate;
 
+  // mesh wall
+  // shear stores MAXMESHTOUCH (triangle ID, shear[3]) tuples per atom
+  // firstcand/numcand = triangles an atom may touch until next reneighbor
+
+  class MeshBVH *mesh;
+  double meshlo[3],meshhi[3];
+  int maxcand;
+  int *numcand;
+  int **firstcand;
+  int *candbuf;
+  MyPage<int> *cpage;
+
+  void post_force_mesh();
+
   void hooke(double, double, double, double, double *,
 	     double *, double *, double *, double *, double, double);
   void hooke_history(double, double, double, double, double *,
@@ -103,6 +121,24 @@ E: Invalid shear direction for fix wall/gran
 
 Self-explanatory.
 
+E: Cannot wiggle or shear fix wall/gran mesh
+
+Mesh walls are stationary.
+
+E: Fix wall/gran mesh cannot be used with triclinic box
+
+Self-explanatory.
+
+E: Too many mesh triangles near one particle
+
+The bounding boxes of too many triangles are within the particle
+radius plus neighbor skin of one particle.  Coarsen the mesh or reduce
+the neighbor skin.
+
+E: Fix wall/gran mesh ran out of memory for candidate triangles
+
+Self-explanatory.
+
 E: Fix wall/gran is incompatible with Pair style
 
 Must use a granular pair style to define the parameters needed for
@@ -0,0 +1,448 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "stdio.h"
+#include "string.h"
+#include "mesh_bvh.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define LEAFSIZE 4             // max # of triangles in a leaf node
+#define MAXDEPTH 128           // max depth of node stack in query()
+#define DELTA 16384
+
+/* ---------------------------------------------------------------------- */
+
+MeshBVH::MeshBVH(LAMMPS *lmp) : Pointers(lmp)
+{
+  MPI_Comm_rank(world,&me);
+
+  ntri_all = ntri = 0;
+  tri_all = NULL;
+  tri = active = NULL;
+  maxtri = 0;
+
+  nnode = maxnode = 0;
+  nodebox = NULL;
+  nodechild = nodefirst = nodenum = nodeactive = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+MeshBVH::~MeshBVH()
+{
+  memory->destroy(tri_all);
+  memory->destroy(tri);
+  memory->destroy(active);
+  memory->destroy(nodebox);
+  memory->destroy(nodechild);
+  memory->destroy(nodefirst);
+  memory->destroy(nodenum);
+  memory->destroy(nodeactive);
+}
+
+/* ----------------------------------------------------------------------
+   read ASCII or binary STL file on proc 0 and broadcast triangles
+   binary if file size matches 84 + 50 bytes per triangle in header
+------------------------------------------------------------------------- */
+
+void MeshBVH::read_stl(const char *file)
+{
+  if (me == 0) {
+    FILE *fp = fopen(file,"rb");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open mesh file %s",file);
+      error->one(FLERR,str);
+    }
+
+    char header[80];
+    uint32_t n = 0;
+    int binary = 0;
+    if (fread(header,sizeof(char),80,fp) == 80 &&
+        fread(&n,sizeof(uint32_t),1,fp) == 1) {
+      fseek(fp,0,SEEK_END);
+      long size = ftell(fp);
+      if (size == 84 + 50*static_cast<long>(n)) binary = 1;
+    }
+    rewind(fp);
+
+    if (binary) read_stl_binary(fp);
+    else read_stl_ascii(fp);
+    fclose(fp);
+
+    if (ntri_all < 0) {
+      char str[128];
+      sprintf(str,"Invalid mesh file %s",file);
+      error->one(FLERR,str);
+    }
+  }
+
+  MPI_Bcast(&ntri_all,1,MPI_INT,0,world);
+  if (ntri_all == 0) {
+    char str[128];
+    sprintf(str,"Mesh file %s has no triangles",file);
+    error->all(FLERR,str);
+  }
+
+  if (me) memory->create(tri_all,ntri_all,9,"mesh_bvh:tri_all");
+  MPI_Bcast(tri_all[0],9*ntri_all,MPI_DOUBLE,0,world);
+
+  // new triangles, hierarchy is rebuilt by next setup()
+
+  ntri = nnode = 0;
+}
+
+/* ----------------------------------------------------------------------
+   parse ASCII STL, only vertex lines are used
+   set ntri_all = -1 if a vertex line is malformed
+------------------------------------------------------------------------- */
+
+void MeshBVH::read_stl_ascii(FILE *fp)
+{
+  char word[256];
+  int nvert = 0;
+  int maxtri_all = 0;
+  ntri_all = 0;
+
+  while (fscanf(fp,"%255s",word) == 1) {
+    if (strcmp(word,"vertex") != 0) continue;
+    if (nvert == 0 && ntri_all == maxtri_all) {
+      maxtri_all += DELTA;
+      grow_tri_all(maxtri_all);
+    }
+    double *v = &tri_all[ntri_all][3*nvert];
+    if (fscanf(fp,"%lg %lg %lg",&v[0],&v[1],&v[2]) != 3) {
+      ntri_all = -1;
+      return;
+    }
+    if (++nvert == 3) {
+      nvert = 0;
+      ntri_all++;
+    }
+  }
+
+  if (nvert) ntri_all = -1;
+}
+
+/* ----------------------------------------------------------------------
+   parse binary STL: 80 byte header, triangle count, then per triangle
+   normal and 3 vertices as 12 floats followed by a 2 byte attribute
+------------------------------------------------------------------------- */
+
+void MeshBVH::read_stl_binary(FILE *fp)
+{
+  char header[80];
+  uint32_t n;
+  if (fread(header,sizeof(char),80,fp) != 80)
+    error->one(FLERR,"Unexpected end of binary mesh file");
+  if (fread(&n,sizeof(uint32_t),1,fp) != 1)
+    error->one(FLERR,"Unexpected end of binary mesh file");
+
+  ntri_all = n;
+  grow_tri_all(ntri_all);
+
+  float facet[12];
+  uint16_t attr;
+  for (int i = 0; i < ntri_all; i++) {
+    if (fread(facet,sizeof(float),12,fp) != 12)
+      error->one(FLERR,"Unexpected end of binary mesh file");
+    if (fread(&attr,sizeof(uint16_t),1,fp) != 1)
+      error->one(FLERR,"Unexpected end of binary mesh file");
+    for (int k = 0; k < 9; k++) tri_all[i][k] = facet[3+k];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void MeshBVH::grow_tri_all(int n)
+{
+  memory->grow(tri_all,n,9,"mesh_bvh:tri_all");
+}
+
+/* ----------------------------------------------------------------------
+   flag triangles whose bounding box overlaps box lo/hi as active
+   build hierarchy over all triangles the first time,
+     afterwards only the flags and node counts are refreshed
+   called when my sub-domain changes
+------------------------------------------------------------------------- */
+
+void MeshBVH::setup(double *lo, double *hi)
+{
+  if (nnode == 0) {
+    if (ntri_all > maxtri) {
+      maxtri = ntri_all;
+      memory->destroy(tri);
+      memory->destroy(active);
+      memory->create(tri,maxtri,"mesh_bvh:tri");
+      memory->create(active,maxtri,"mesh_bvh:active");
+    }
+
+    // binary tree with at least one triangle per leaf has < 2*ntri_all nodes
+
+    if (2*ntri_all > maxnode) {
+      maxnode = 2*ntri_all;
+      memory->destroy(nodebox);
+      memory->destroy(nodechild);
+      memory->destroy(nodefirst);
+      memory->destroy(nodenum);
+      memory->destroy(nodeactive);
+      memory->create(nodebox,maxnode,6,"mesh_bvh:nodebox");
+      memory->create(nodechild,maxnode,"mesh_bvh:nodechild");
+      memory->create(nodefirst,maxnode,"mesh_bvh:nodefirst");
+      memory->create(nodenum,maxnode,"mesh_bvh:nodenum");
+      memory->create(nodeactive,maxnode,"mesh_bvh:nodeactive");
+    }
+
+    for (int t = 0; t < ntri_all; t++) tri[t] = t;
+    nnode = 1;
+    build(0,0,ntri_all);
+  }
+
+  double box[6];
+  ntri = 0;
+  for (int t = 0; t < ntri_all; t++) {
+    tri_box(t,box);
+    if (box[3] < lo[0] || box[0] > hi[0] ||
+        box[4] < lo[1] || box[1] > hi[1] ||
+        box[5] < lo[2] || box[2] > hi[2]) active[t] = 0;
+    else {
+      active[t] = 1;
+      ntri++;
+    }
+  }
+
+  // children are stored after their parent, so count bottom-up
+
+  for (int inode = nnode-1; inode >= 0; inode--) {
+    if (nodechild[inode] >= 0) {
+      nodeactive[inode] = nodeactive[nodechild[inode]] +
+        nodeactive[nodechild[inode]+1];
+      continue;
+    }
+    int n = 0;
+    int last = nodefirst[inode] + nodenum[inode];
+    for (int i = nodefirst[inode]; i < last; i++) n += active[tri[i]];
+    nodeactive[inode] = n;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   setup node inode owning tri[first] to tri[first+n-1]
+   split at median centroid along longest extent of the node box
+------------------------------------------------------------------------- */
+
+void MeshBVH::build(int inode, int first, int n)
+{
+  double *nbox = nodebox[inode];
+  double box[6];
+  int k;
+
+  tri_box(tri[first],nbox);
+  for (int i = first+1; i < first+n; i++) {
+    tri_box(tri[i],box);
+    for (k = 0; k < 3; k++) {
+      if (box[k] < nbox[k]) nbox[k] = box[k];
+      if (box[k+3] > nbox[k+3]) nbox[k+3] = box[k+3];
+    }
+  }
+
+  nodefirst[inode] = first;
+  nodenum[inode] = n;
+
+  if (n <= LEAFSIZE) {
+    nodechild[inode] = -1;
+    return;
+  }
+
+  int dim = 0;
+  for (k = 1; k < 3; k++)
+    if (nbox[k+3]-nbox[k] > nbox[dim+3]-nbox[dim]) dim = k;
+
+  // quickselect so tri[first:mid-1] have centroids <= those of tri[mid:]
+  // centroid coord is compared as sum of 3 vertex coords
+
+  int mid = first + n/2;
+  int left = first;
+  int right = first + n-1;
+  while (left < right) {
+    double pivot = centroid_sum(tri[mid],dim);
+    int i = left;
+    int j = right;
+    do {
+      while (centroid_sum(tri[i],dim) < pivot) i++;
+      while (pivot < centroid_sum(tri[j],dim)) j--;
+      if (i <= j) {
+        int tmp = tri[i];
+        tri[i] = tri[j];
+        tri[j] = tmp;
+        i++;
+        j--;
+      }
+    } while (i <= j);
+    if (j < mid) left = i;
+    if (mid < i) right = j;
+  }
+
+  int child = nnode;
+  nnode += 2;
+  nodechild[inode] = child;
+  build(child,first,mid-first);
+  build(child+1,mid,first+n-mid);
+}
+
+/* ----------------------------------------------------------------------
+   find active triangles whose bounding box is within cut of point x
+   store up to max global triangle indices in list
+   return # of triangles found, may be > max
+------------------------------------------------------------------------- */
+
+int MeshBVH::query(double *x, double cut, int *list, int max)
+{
+  if (ntri == 0) return 0;
+
+  int stack[MAXDEPTH];
+  int nstack = 0;
+  int n = 0;
+  double cutsq = cut*cut;
+  double box[6];
+
+  stack[nstack++] = 0;
+  while (nstack) {
+    int inode = stack[--nstack];
+    if (nodeactive[inode] == 0) continue;
+    double *nbox = nodebox[inode];
+
+    double rsq = 0.0;
+    for (int k = 0; k < 3; k++) {
+      double d = 0.0;
+      if (x[k] < nbox[k]) d = nbox[k] - x[k];
+      else if (x[k] > nbox[k+3]) d = x[k] - nbox[k+3];
+      rsq += d*d;
+    }
+    if (rsq > cutsq) continue;
+
+    if (nodechild[inode] >= 0) {
+      if (nstack+2 > MAXDEPTH)
+        error->one(FLERR,"Mesh hierarchy is too deep");
+      stack[nstack++] = nodechild[inode];
+      stack[nstack++] = nodechild[inode]+1;
+      continue;
+    }
+
+    int last = nodefirst[inode] + nodenum[inode];
+    for (int i = nodefirst[inode]; i < last; i++) {
+      if (!active[tri[i]]) continue;
+      tri_box(tri[i],box);
+      if (x[0] < box[0]-cut || x[0] > box[3]+cut ||
+          x[1] < box[1]-cut || x[1] > box[4]+cut ||
+          x[2] < box[2]-cut || x[2] > box[5]+cut) continue;
+      if (n < max) list[n] = tri[i];
+      n++;
+    }
+  }
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   closest point on triangle t to point x
+   return squared distance and delta = x - closest point
+------------------------------------------------------------------------- */
+
+double MeshBVH::distance(int t, double *x, double *delta)
+{
+  double *a = &tri_all[t][0];
+  double *b = &tri_all[t][3];
+  double *c = &tri_all[t][6];
+  double ab[3],ac[3],ap[3],bp[3],cp[3],q[3];
+  int k;
+
+  for (k = 0; k < 3; k++) {
+    ab[k] = b[k] - a[k];
+    ac[k] = c[k] - a[k];
+    ap[k] = x[k] - a[k];
+  }
+
+  double d1 = ab[0]*ap[0] + ab[1]*ap[1] + ab[2]*ap[2];
+  double d2 = ac[0]*ap[0] + ac[1]*ap[1] + ac[2]*ap[2];
+
+  if (d1 <= 0.0 && d2 <= 0.0) {
+    for (k = 0; k < 3; k++) q[k] = a[k];
+  } else {
+    for (k = 0; k < 3; k++) bp[k] = x[k] - b[k];
+    double d3 = ab[0]*bp[0] + ab[1]*bp[1] + ab[2]*bp[2];
+    double d4 = ac[0]*bp[0] + ac[1]*bp[1] + ac[2]*bp[2];
+    for (k = 0; k < 3; k++) cp[k] = x[k] - c[k];
+    double d5 = ab[0]*cp[0] + ab[1]*cp[1] + ab[2]*cp[2];
+    double d6 = ac[0]*cp[0] + ac[1]*cp[1] + ac[2]*cp[2];
+    double vc = d1*d4 - d3*d2;
+    double vb = d5*d2 - d1*d6;
+    double va = d3*d6 - d5*d4;
+
+    if (d3 >= 0.0 && d4 <= d3) {
+      for (k = 0; k < 3; k++) q[k] = b[k];
+    } else if (d6 >= 0.0 && d5 <= d6) {
+      for (k = 0; k < 3; k++) q[k] = c[k];
+    } else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+      double s = d1 / (d1-d3);
+      for (k = 0; k < 3; k++) q[k] = a[k] + s*ab[k];
+    } else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+      double s = d2 / (d2-d6);
+      for (k = 0; k < 3; k++) q[k] = a[k] + s*ac[k];
+    } else if (va <= 0.0 && (d4-d3) >= 0.0 && (d5-d6) >= 0.0) {
+      double s = (d4-d3) / ((d4-d3) + (d5-d6));
+      for (k = 0; k < 3; k++) q[k] = b[k] + s*(c[k]-b[k]);
+    } else {
+      double denom = 1.0 / (va+vb+vc);
+      double s = vb*denom;
+      double u = vc*denom;
+      for (k = 0; k < 3; k++) q[k] = a[k] + s*ab[k] + u*ac[k];
+    }
+  }
+
+  for (k = 0; k < 3; k++) delta[k] = x[k] - q[k];
+  return delta[0]*delta[0] + delta[1]*delta[1] + delta[2]*delta[2];
+}
+
+/* ----------------------------------------------------------------------
+   bounding box of triangle t as xlo,ylo,zlo,xhi,yhi,zhi
+------------------------------------------------------------------------- */
+
+void MeshBVH::tri_box(int t, double *box)
+{
+  double *v = tri_all[t];
+  for (int k = 0; k < 3; k++) {
+    box[k] = box[k+3] = v[k];
+    if (v[k+3] < box[k]) box[k] = v[k+3];
+    if (v[k+3] > box[k+3]) box[k+3] = v[k+3];
+    if (v[k+6] < box[k]) box[k] = v[k+6];
+    if (v[k+6] > box[k+3]) box[k+3] = v[k+6];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of triangles and hierarchy
+------------------------------------------------------------------------- */
+
+double MeshBVH::memory_usage()
+{
+  double bytes = 9.0*ntri_all * sizeof(double);
+  bytes += 2.0*maxtri * sizeof(int);
+  bytes += 6.0*maxnode * sizeof(double);
+  bytes += 4.0*maxnode * sizeof(int);
+  return bytes;
+}
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_MESH_BVH_H
+#define LMP_MESH_BVH_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class MeshBVH : protected Pointers {
+ public:
+  int ntri_all;                    // # of triangles in mesh
+  int ntri;                        // # of triangles near my sub-domain
+
+  MeshBVH(class LAMMPS *);
+  ~MeshBVH();
+  void read_stl(const char *);
+  void setup(double *, double *);
+  int query(double *, double, int *, int);
+  double distance(int, double *, double *);
+  double memory_usage();
+
+ private:
+  int me;
+  double **tri_all;                // 3 vertices of each triangle, 9 values
+
+  // bounding volume hierarchy over all triangles, built once per mesh
+  // leaf nodes have child = -1 and own tri[first] to tri[first+num-1]
+  // inner nodes own children child and child+1
+  // triangles near my sub-domain are flagged in active,
+  //   nodes without any are skipped by query()
+
+  int *tri;                        // global triangle indices in leaf order
+  int *active;                     // 1 if triangle t is near my sub-domain
+  int maxtri;
+  int nnode,maxnode;               // nnode = 0 until hierarchy is built
+  double **nodebox;                // xlo,ylo,zlo,xhi,yhi,zhi of each node
+  int *nodechild;
+  int *nodefirst,*nodenum;
+  int *nodeactive;                 // # of active triangles below each node
+
+  void read_stl_ascii(FILE *);
+  void read_stl_binary(FILE *);
+  void grow_tri_all(int);
+  void build(int, int, int);
+  void tri_box(int, double *);
+
+  inline double centroid_sum(int t, int dim) {
+    double *v = tri_all[t];
+    return v[dim] + v[dim+3] + v[dim+6];
+  }
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot open mesh file %s
+
+The specified STL file cannot be opened.  Check that the path and
+name are correct.
+
+E: Invalid mesh file %s
+
+The STL file could not be parsed as either ASCII or binary STL.
+
+E: Unexpected end of binary mesh file
+
+The binary STL file is shorter than its header and triangle count
+imply.
+
+E: Mesh file %s has no triangles
+
+Self-explanatory.
+
+E: Mesh hierarchy is too deep
+
+The bounding volume hierarchy over the mesh triangles exceeded the
+maximum depth of its query stack.  This should not happen for a median
+split hierarchy.
+
+*/
@@ -0,0 +1,15 @@
+# Install/unInstall package files in LAMMPS
+
+if (test $1 = 1) then
+
+  cp dump_col_mpiio.cpp ..
+
+  cp dump_col_mpiio.h ..
+
+elif (test $1 = 0) then
+
+  rm -f ../dump_col_mpiio.cpp
+
+  rm -f ../dump_col_mpiio.h
+
+fi
@@ -0,0 +1,439 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   file layout, all values in native byte order:
+     file header
+       char magic[8] = "LMPCOL01"
+       int ncol, int realsize = 4 or 8 bytes for real columns
+       bigint nsnap = # of snapshots in index
+       bigint index_offset = byte offset of index
+       char name[16] for each column
+     each snapshot
+       bigint timestep, bigint natoms
+       int triclinic, int unused
+       double xlo,xhi,ylo,yhi,zlo,zhi,xy,xz,yz
+       one contiguous block of natoms values per column,
+         int for id and type, realsize for all others,
+         lines are in proc order, so use id column to identify atoms
+     index, written after last snapshot and rewritten after each one
+       bigint timestep,natoms,offset for each snapshot
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "dump_col_mpiio.h"
+#include "atom.h"
+#include "domain.h"
+#include "group.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define MAGIC "LMPCOL01"
+#define NAMELEN 16
+#define FILEHEADER 32
+#define SNAPHEADER 96
+#define DELTA 64
+
+enum{ID,TYPE,X,Y,Z,VX,VY,VZ,OMEGAX,OMEGAY,OMEGAZ,RADIUS,NQUANTITY};
+
+static const char *colname[NQUANTITY] =
+  {"id","type","x","y","z","vx","vy","vz",
+   "omegax","omegay","omegaz","radius"};
+
+/* ---------------------------------------------------------------------- */
+
+DumpColMPIIO::DumpColMPIIO(LAMMPS *lmp, int narg, char **arg) :
+  Dump(lmp, narg, arg)
+{
+  if (narg < 5) error->all(FLERR,"Illegal dump col/mpiio command");
+  if (compressed || multiproc)
+    error->all(FLERR,"Invalid dump col/mpiio filename");
+
+  // flag requested quantities, default = all the atom style defines
+
+  int flag[NQUANTITY];
+  for (int i = 0; i < NQUANTITY; i++) flag[i] = 0;
+
+  if (narg == 5) {
+    flag[ID] = flag[TYPE] = 1;
+    flag[X] = flag[Y] = flag[Z] = 1;
+    flag[VX] = flag[VY] = flag[VZ] = 1;
+    if (atom->omega_flag) flag[OMEGAX] = flag[OMEGAY] = flag[OMEGAZ] = 1;
+    if (atom->radius_flag) flag[RADIUS] = 1;
+  }
+
+  char str[128];
+  for (int iarg = 5; iarg < narg; iarg++) {
+    if (strcmp(arg[iarg],"id") == 0) flag[ID] = 1;
+    else if (strcmp(arg[iarg],"type") == 0) flag[TYPE] = 1;
+    else if (strcmp(arg[iarg],"x") == 0) flag[X] = flag[Y] = flag[Z] = 1;
+    else if (strcmp(arg[iarg],"v") == 0) flag[VX] = flag[VY] = flag[VZ] = 1;
+    else if (strcmp(arg[iarg],"omega") == 0 && atom->omega_flag)
+      flag[OMEGAX] = flag[OMEGAY] = flag[OMEGAZ] = 1;
+    else if (strcmp(arg[iarg],"radius") == 0 && atom->radius_flag)
+      flag[RADIUS] = 1;
+    else {
+      sprintf(str,"Invalid dump col/mpiio column %s",arg[iarg]);
+      error->all(FLERR,str);
+    }
+  }
+
+  // columns are stored in fixed order, int columns first
+
+  ncol = nint = 0;
+  col = new int[NQUANTITY];
+  for (int i = 0; i < NQUANTITY; i++)
+    if (flag[i]) {
+      col[ncol++] = i;
+      if (i == ID || i == TYPE) nint++;
+    }
+
+  size_one = ncol;
+  realsize = sizeof(double);
+  flush_flag = 0;
+  format_default = NULL;
+
+  file_open = 0;
+  offset_next = 0;
+  nsnap = maxsnap = 0;
+  snapindex = NULL;
+
+  maxibuf = maxfbuf = 0;
+  ibuf = NULL;
+  fbuf = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpColMPIIO::~DumpColMPIIO()
+{
+  closefile();
+
+  delete [] col;
+  memory->destroy(snapindex);
+  memory->destroy(ibuf);
+  memory->destroy(fbuf);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpColMPIIO::init_style()
+{
+  if (append_flag)
+    error->all(FLERR,"Cannot append to dump col/mpiio file");
+}
+
+/* ----------------------------------------------------------------------
+   all procs write their slab of each column into the shared file
+   replaces Dump::write(), which funnels output thru proc 0
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::write()
+{
+  openfile();
+
+  if (domain->triclinic == 0) {
+    boxxlo = domain->boxlo[0];
+    boxxhi = domain->boxhi[0];
+    boxylo = domain->boxlo[1];
+    boxyhi = domain->boxhi[1];
+    boxzlo = domain->boxlo[2];
+    boxzhi = domain->boxhi[2];
+    boxxy = boxxz = boxyz = 0.0;
+  } else {
+    boxxlo = domain->boxlo_bound[0];
+    boxxhi = domain->boxhi_bound[0];
+    boxylo = domain->boxlo_bound[1];
+    boxyhi = domain->boxhi_bound[1];
+    boxzlo = domain->boxlo_bound[2];
+    boxzhi = domain->boxhi_bound[2];
+    boxxy = domain->xy;
+    boxxz = domain->xz;
+    boxyz = domain->yz;
+  }
+
+  // nme = # of lines from me, nme_before = # from lower procs
+
+  nme = count();
+  bigint bnme = nme;
+  MPI_Allreduce(&bnme,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Scan(&bnme,&nme_before,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  nme_before -= bnme;
+
+  if ((bigint) nme*size_one > MAXSMALLINT)
+    error->one(FLERR,"Too much per-proc info for dump");
+
+  if (nme*(ncol-nint) > maxbuf) {
+    maxbuf = nme*(ncol-nint);
+    memory->destroy(buf);
+    memory->create(buf,maxbuf,"dump:buf");
+  }
+  if (nme*nint > maxibuf) {
+    maxibuf = nme*nint;
+    memory->destroy(ibuf);
+    memory->create(ibuf,maxibuf,"dump:ibuf");
+  }
+  if (realsize == sizeof(float) && nme > maxfbuf) {
+    maxfbuf = nme;
+    memory->destroy(fbuf);
+    memory->create(fbuf,maxfbuf,"dump:fbuf");
+  }
+
+  write_header(ntotal);
+  pack(NULL);
+  write_data(nme,buf);
+
+  // index after each snapshot keeps file readable if run stops early
+
+  offset_next += SNAPHEADER + ntotal*(nint*sizeof(int) + (ncol-nint)*realsize);
+  write_index();
+
+  if (flush_flag) MPI_File_sync(mpifh);
+  if (multifile) closefile();
+}
+
+/* ----------------------------------------------------------------------
+   open shared file and write file header
+   all procs must call, since MPI_File_open is collective
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::openfile()
+{
+  if (file_open) return;
+
+  char *filecurrent = filename;
+  if (multifile) {
+    filecurrent = new char[strlen(filename) + 16];
+    char *ptr = strchr(filename,'*');
+    *ptr = '\0';
+    if (padflag == 0)
+      sprintf(filecurrent,"%s" BIGINT_FORMAT "%s",
+              filename,update->ntimestep,ptr+1);
+    else {
+      char bif[8],pad[16];
+      strcpy(bif,BIGINT_FORMAT);
+      sprintf(pad,"%%s%%0%d%s%%s",padflag,&bif[1]);
+      sprintf(filecurrent,pad,filename,update->ntimestep,ptr+1);
+    }
+    *ptr = '*';
+  }
+
+  int err = MPI_File_open(world,filecurrent,MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                          MPI_INFO_NULL,&mpifh);
+  if (multifile) delete [] filecurrent;
+  if (err != MPI_SUCCESS) error->all(FLERR,"Cannot open dump file");
+  MPI_File_set_size(mpifh,0);
+  file_open = 1;
+  nsnap = 0;
+
+  if (me == 0) {
+    int n = FILEHEADER + NAMELEN*ncol;
+    char *header = new char[n];
+    memset(header,0,n);
+    memcpy(header,MAGIC,8);
+    memcpy(&header[8],&ncol,sizeof(int));
+    memcpy(&header[12],&realsize,sizeof(int));
+    for (int i = 0; i < ncol; i++)
+      strncpy(&header[FILEHEADER+NAMELEN*i],colname[col[i]],NAMELEN-1);
+    MPI_Status status;
+    MPI_File_write_at(mpifh,0,header,n,MPI_CHAR,&status);
+    delete [] header;
+  }
+  offset_next = FILEHEADER + NAMELEN*ncol;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpColMPIIO::closefile()
+{
+  if (!file_open) return;
+  MPI_File_close(&mpifh);
+  file_open = 0;
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes snapshot header at start of snapshot
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::write_header(bigint ndump)
+{
+  if (me) return;
+
+  char header[SNAPHEADER];
+  bigint ntimestep = update->ntimestep;
+  int flags[2];
+  flags[0] = domain->triclinic;
+  flags[1] = 0;
+  double box[9];
+  box[0] = boxxlo; box[1] = boxxhi;
+  box[2] = boxylo; box[3] = boxyhi;
+  box[4] = boxzlo; box[5] = boxzhi;
+  box[6] = boxxy; box[7] = boxxz; box[8] = boxyz;
+
+  memcpy(&header[0],&ntimestep,sizeof(bigint));
+  memcpy(&header[8],&ndump,sizeof(bigint));
+  memcpy(&header[16],flags,2*sizeof(int));
+  memcpy(&header[24],box,9*sizeof(double));
+
+  MPI_Status status;
+  MPI_File_write_at(mpifh,offset_next,header,SNAPHEADER,MPI_CHAR,&status);
+
+  if (nsnap == maxsnap) {
+    maxsnap += DELTA;
+    memory->grow(snapindex,3*maxsnap,"dump:snapindex");
+  }
+  snapindex[3*nsnap] = ntimestep;
+  snapindex[3*nsnap+1] = ndump;
+  snapindex[3*nsnap+2] = offset_next;
+  nsnap++;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpColMPIIO::count()
+{
+  if (igroup == 0) return atom->nlocal;
+
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  int m = 0;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) m++;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   pack my atoms column by column, ints into ibuf, reals into buf
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::pack(int *dummy)
+{
+  int *tag = atom->tag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  double **x = atom->x;
+  double **v = atom->v;
+  double **omega = atom->omega;
+  double *radius = atom->radius;
+  int nlocal = atom->nlocal;
+
+  for (int icol = 0; icol < ncol; icol++) {
+    int which = col[icol];
+    int m = 0;
+    if (icol < nint) {
+      int *ivec = &ibuf[icol*nme];
+      int *src = (which == ID) ? tag : type;
+      for (int i = 0; i < nlocal; i++)
+        if (mask[i] & groupbit) ivec[m++] = src[i];
+    } else {
+      double *vec = &buf[(icol-nint)*nme];
+      if (which == RADIUS) {
+        for (int i = 0; i < nlocal; i++)
+          if (mask[i] & groupbit) vec[m++] = radius[i];
+      } else {
+        double **src = x;
+        int k = which - X;
+        if (which >= OMEGAX) {
+          src = omega;
+          k = which - OMEGAX;
+        } else if (which >= VX) {
+          src = v;
+          k = which - VX;
+        }
+        for (int i = 0; i < nlocal; i++)
+          if (mask[i] & groupbit) vec[m++] = src[i][k];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   collective write of my slab of each column
+   column block starts after all preceding blocks of this snapshot
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::write_data(int n, double *mybuf)
+{
+  MPI_Status status;
+  MPI_Offset start = offset_next + SNAPHEADER;
+
+  for (int icol = 0; icol < ncol; icol++) {
+    if (icol < nint) {
+      MPI_File_write_at_all(mpifh,start + nme_before*sizeof(int),
+                            &ibuf[icol*n],n,MPI_INT,&status);
+      start += ntotal*sizeof(int);
+    } else {
+      double *vec = &mybuf[(icol-nint)*n];
+      if (realsize == sizeof(float)) {
+        for (int i = 0; i < n; i++) fbuf[i] = vec[i];
+        MPI_File_write_at_all(mpifh,start + nme_before*realsize,
+                              fbuf,n,MPI_FLOAT,&status);
+      } else
+        MPI_File_write_at_all(mpifh,start + nme_before*realsize,
+                              vec,n,MPI_DOUBLE,&status);
+      start += ntotal*realsize;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 writes index at end of file and points file header to it
+   next snapshot overwrites it, and is always longer than old index
+------------------------------------------------------------------------- */
+
+void DumpColMPIIO::write_index()
+{
+  if (me) return;
+
+  MPI_Status status;
+  bigint nbig = nsnap;
+  bigint offset = offset_next;
+  MPI_File_write_at(mpifh,offset_next,snapindex,3*nsnap,MPI_LMP_BIGINT,
+                    &status);
+  MPI_File_write_at(mpifh,16,&nbig,1,MPI_LMP_BIGINT,&status);
+  MPI_File_write_at(mpifh,24,&offset,1,MPI_LMP_BIGINT,&status);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpColMPIIO::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"precision") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (file_open && nsnap)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"single") == 0) realsize = sizeof(float);
+    else if (strcmp(arg[1],"double") == 0) realsize = sizeof(double);
+    else error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory in buf, ibuf, fbuf and snapindex
+------------------------------------------------------------------------- */
+
+bigint DumpColMPIIO::memory_usage()
+{
+  bigint bytes = Dump::memory_usage();
+  bytes += memory->usage(ibuf,maxibuf);
+  bytes += memory->usage(fbuf,maxfbuf);
+  bytes += memory->usage(snapindex,3*maxsnap);
+  return bytes;
+}
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(col/mpiio,DumpColMPIIO)
+
+#else
+
+#ifndef LMP_DUMP_COL_MPIIO_H
+#define LMP_DUMP_COL_MPIIO_H
+
+#include "mpi.h"
+#include "dump.h"
+
+namespace LAMMPS_NS {
+
+class DumpColMPIIO : public Dump {
+ public:
+  DumpColMPIIO(class LAMMPS *, int, char **);
+  ~DumpColMPIIO();
+  void write();
+
+ private:
+  int ncol;                   // # of columns in each snapshot
+  int *col;                   // which quantity is stored in each column
+  int nint;                   // leading columns that are ints (id, type)
+  int realsize;               // bytes per real column value, 4 or 8
+
+  MPI_File mpifh;             // shared file, opened by all procs
+  int file_open;              // 1 if mpifh is open
+  MPI_Offset offset_next;     // where next snapshot starts in file
+  bigint nme_before;          // # of snapshot lines on lower procs
+
+  int nsnap,maxsnap;          // # of snapshots in index, size of index
+  bigint *snapindex;          // timestep,natoms,offset of each snapshot
+
+  int maxibuf,maxfbuf;
+  int *ibuf;                  // int columns of my atoms
+  float *fbuf;                // single precision copy of one column
+
+  void init_style();
+  int modify_param(int, char **);
+  void openfile();
+  void closefile();
+  void write_header(bigint);
+  int count();
+  void pack(int *);
+  void write_data(int, double *);
+  void write_index();
+  bigint memory_usage();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Invalid dump col/mpiio filename
+
+Filenames used with the dump col/mpiio style cannot be compressed or
+contain a '%' character, since all procs write to one file.
+
+E: Invalid dump col/mpiio column %s
+
+The column is not recognized, or requires a per-atom quantity the
+atom style does not define, e.g. omega and radius for atom style
+sphere.
+
+E: Cannot append to dump col/mpiio file
+
+The file header and snapshot index are rewritten as the dump
+proceeds, so an existing file cannot be extended.
+
+E: Cannot open dump file
+
+The output file for the dump command cannot be opened.  Check that the
+path and name are correct.
+
+*/
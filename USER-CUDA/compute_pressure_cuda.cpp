@@ -66,6 +66,7 @@ ComputePressureCuda::ComputePressureCuda(LAMMPS *lmp, int narg, char **arg) :
    if(cuda == NULL)
         error->all(FLERR,"You cannot use a /cuda class, without activating 'cuda' acceleration. Provide '-c on' as command-line argument to LAMMPS..");
   cudable = 1;
+  reduceflag = 0;
   
   // store temperature ID used by pressure computation
   // insure it is valid for temperature computation
@@ -47,6 +47,7 @@ FixViscousCuda::FixViscousCuda(LAMMPS *lmp, int narg, char **arg) :
         error->all(FLERR,"You cannot use a /cuda class, without activating 'cuda' acceleration. Provide '-c on' as command-line argument to LAMMPS..");
 
 	cu_gamma=NULL;
+	fuse_flag = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -72,6 +72,7 @@ PairGranHookeCuda::PairGranHookeCuda(LAMMPS *lmp) : PairGranHooke(lmp)
         error->all(FLERR,"You cannot use a /cuda class, without activating 'cuda' acceleration. Provide '-c on' as command-line argument to LAMMPS..");
 
 	allocated2 = false;
+	overlap_flag = 0;
 	cuda->shared_data.pair.cudable_force = 1;
 	cuda->setSystemParams();
 }
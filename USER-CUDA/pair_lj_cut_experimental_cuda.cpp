@@ -70,6 +70,7 @@ PairLJCutExperimentalCuda::PairLJCutExperimentalCuda(LAMMPS *lmp) : PairLJCut(lm
         error->all(FLERR,"You cannot use a /cuda class, without activating 'cuda' acceleration. Provide '-c on' as command-line argument to LAMMPS..");
 
 	allocated2 = false;
+	overlap_flag = 0;
 	cuda->shared_data.pair.cudable_force = 1;
 	cuda->setSystemParams();
 }
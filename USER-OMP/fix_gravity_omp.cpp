@@ -34,7 +34,7 @@ enum{CHUTE,SPHERICAL,GRADIENT,VECTOR};
 /* ---------------------------------------------------------------------- */
 
 FixGravityOMP::FixGravityOMP(LAMMPS *lmp, int narg, char **arg) :
-  FixGravity(lmp, narg, arg) { }
+  FixGravity(lmp, narg, arg) { fuse_flag = 0; }
 
 /* ---------------------------------------------------------------------- */
 
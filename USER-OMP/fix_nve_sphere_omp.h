@@ -27,7 +27,7 @@ namespace LAMMPS_NS {
 class FixNVESphereOMP : public FixNVESphere {
  public:
   FixNVESphereOMP(class LAMMPS *lmp, int narg, char **arg) :
-    FixNVESphere(lmp, narg, arg) {};
+    FixNVESphere(lmp, narg, arg) { fuse_flag = 0; };
 
   virtual void initial_integrate(int);
   virtual void final_integrate();
@@ -31,24 +31,31 @@
 using namespace LAMMPS_NS;
 using namespace FixConst;
 
-#define MAXTOUCH 15
-
 /* ----------------------------------------------------------------------
    copy shear partner info from neighbor lists to atom arrays
    so can be exchanged with atoms
+   counting and filling are threaded, each thread owns a fixed chunk
+   of local atoms, chunks of the shared pages are handed out serially
 ------------------------------------------------------------------------- */
 
-void FixShearHistoryOMP::pre_exchange()
+void FixShearHistoryOMP::pre_exchange_full()
 {
-
   const int nlocal = atom->nlocal;
-  const int nghost = atom->nghost;
-  const int nall = nlocal + nghost;
   const int nthreads = comm->nthreads;
 
-  int flag = 0;
+  NeighList *list = pair->list;
+  const int inum = list->inum;
+  int * const ilist = list->ilist;
+  int * const numneigh = list->numneigh;
+  int ** const firstneigh = list->firstneigh;
+  int ** const firsttouch = list->listgranhistory->firstneigh;
+  double ** const firstshear = list->listgranhistory->firstdouble;
+  int * const tag = atom->tag;
+
+  // count touching partners of owned atoms
+
 #if defined(_OPENMP)
-#pragma omp parallel default(none) shared(flag)
+#pragma omp parallel default(none)
 #endif
   {
 
@@ -58,38 +65,67 @@ void FixShearHistoryOMP::pre_exchange()
     const int tid = 0;
 #endif
 
-    // each thread works on a fixed chunk of local and ghost atoms.
     const int ldelta = 1 + nlocal/nthreads;
     const int lfrom = tid*ldelta;
     const int lmax = lfrom +ldelta;
     const int lto = (lmax > nlocal) ? nlocal : lmax;
 
-    const int gdelta = 1 + nghost/nthreads;
-    const int gfrom = nlocal + tid*gdelta;
-    const int gmax = gfrom + gdelta;
-    const int gto = (gmax > nall) ? nall : gmax;
+    int i,j,ii,jj,jnum;
+    int *jlist,*touch;
 
-    
-    int i,j,ii,jj,m,inum,jnum;
-    int *ilist,*jlist,*numneigh,**firstneigh;
-    int *touch,**firsttouch;
-    double *shear,*allshear,**firstshear;
+    for (i = lfrom; i < lto; i++) npartner[i] = 0;
 
-    // zero npartners for all current atoms
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      jlist = firstneigh[i];
+      jnum = numneigh[i];
+      touch = firsttouch[i];
 
-    for (i = lfrom; i < lto; i++) npartner[i] = 0;
+      for (jj = 0; jj < jnum; jj++) {
+	if (touch[jj]) {
+	  j = jlist[jj];
+	  j &= NEIGHMASK;
+	  if ((i >= lfrom) && (i < lto)) npartner[i]++;
+	  if ((j >= lfrom) && (j < lto)) npartner[j]++;
+	}
+      }
+    }
+  }
+
+  // get a chunk of exactly the right size for each owned atom
+
+  ipage->reset();
+  dpage->reset();
 
-    // copy shear info from neighbor list atoms to atom arrays
+  for (int i = 0; i < nlocal; i++) {
+    partner[i] = ipage->get(npartner[i]);
+    shearpartner[i] = dpage->get(dnum*npartner[i]);
+    if (!partner[i] || !shearpartner[i])
+      error->one(FLERR,"Shear history overflow, boost neigh_modify one");
+    npartner[i] = 0;
+  }
 
-    int *tag = atom->tag;
+  // copy shear info from neighbor list atoms to atom arrays
 
-    NeighList *list = pair->list;
-    inum = list->inum;
-    ilist = list->ilist;
-    numneigh = list->numneigh;
-    firstneigh = list->firstneigh;
-    firsttouch = list->listgranhistory->firstneigh;
-    firstshear = list->listgranhistory->firstdouble;
+#if defined(_OPENMP)
+#pragma omp parallel default(none)
+#endif
+  {
+
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+
+    const int ldelta = 1 + nlocal/nthreads;
+    const int lfrom = tid*ldelta;
+    const int lmax = lfrom +ldelta;
+    const int lto = (lmax > nlocal) ? nlocal : lmax;
+
+    int i,j,k,ii,jj,m,jnum;
+    int *jlist,*touch;
+    double *shear,*allshear;
 
     for (ii = 0; ii < inum; ii++) {
       i = ilist[ii];
@@ -102,50 +138,23 @@ void FixShearHistoryOMP::pre_exchange()
 	if (touch[jj]) {
 	  j = jlist[jj];
 	  j &= NEIGHMASK;
-	  shear = &allshear[3*jj];
-	  
+	  shear = &allshear[dnum*jj];
+
 	  if ((i >= lfrom) && (i < lto)) {
-	    if (npartner[i] < MAXTOUCH) {
-	      m = npartner[i];
-	      partner[i][m] = tag[j];
-	      shearpartner[i][m][0] = shear[0];
-	      shearpartner[i][m][1] = shear[1];
-	      shearpartner[i][m][2] = shear[2];
-	    }
-	    npartner[i]++;
+	    m = npartner[i]++;
+	    partner[i][m] = tag[j];
+	    for (k = 0; k < dnum; k++)
+	      shearpartner[i][dnum*m+k] = shear[k];
 	  }
 
 	  if ((j >= lfrom) && (j < lto)) {
-	    if (npartner[j] < MAXTOUCH) {
-	      m = npartner[j];
-	      partner[j][m] = tag[i];
-	      shearpartner[j][m][0] = -shear[0];
-	      shearpartner[j][m][1] = -shear[1];
-	      shearpartner[j][m][2] = -shear[2];
-	    }
-	    npartner[j]++;
-	  }
-	  
-	  if ((j >= gfrom) && (j < gto)) {
-	    npartner[j]++;
+	    m = npartner[j]++;
+	    partner[j][m] = tag[i];
+	    for (k = 0; k < dnum; k++)
+	      shearpartner[j][dnum*m+k] = -shear[k];
 	  }
 	}
       }
     }
-  
-    // test for too many touching neighbors
-    int myflag = 0;
-    for (i = lfrom; i < lto; i++)
-      if (npartner[i] >= MAXTOUCH) myflag = 1;
-  
-    if (myflag)
-#if defined(_OPENMP)
-#pragma omp atomic
-#endif
-      ++flag;
   }
-
-  int flag_all;
-  MPI_Allreduce(&flag,&flag_all,1,MPI_INT,MPI_SUM,world);
-  if (flag_all) error->all(FLERR,"Too many touching neighbors - boost MAXTOUCH");
 }
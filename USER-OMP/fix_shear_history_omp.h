@@ -29,7 +29,9 @@ class FixShearHistoryOMP : public FixShearHistory {
  public:
   FixShearHistoryOMP(class LAMMPS *lmp, int narg, char **argv)
     : FixShearHistory(lmp,narg,argv) {};
-  virtual void pre_exchange();
+
+ protected:
+  virtual void pre_exchange_full();
 };
 
 }
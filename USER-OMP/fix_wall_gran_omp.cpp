@@ -24,7 +24,7 @@ using namespace LAMMPS_NS;
 using namespace FixConst;
 
 
-enum{XPLANE,YPLANE,ZPLANE,ZCYLINDER};    // XYZ PLANE need to be 0,1,2
+enum{XPLANE,YPLANE,ZPLANE,ZCYLINDER,MESH};    // XYZ PLANE need to be 0,1,2
 enum{HOOKE,HOOKE_HISTORY,HERTZ_HISTORY};
 
 #define BIG 1.0e20
@@ -40,6 +40,11 @@ void FixWallGranOMP::post_force(int vflag)
 {
   double vwall[3];
 
+  if (wallstyle == MESH) {
+    post_force_mesh();
+    return;
+  }
+
   // set position of wall to initial settings and velocity to 0.0
   // if wiggle or shear, set wall position and velocity accordingly
 
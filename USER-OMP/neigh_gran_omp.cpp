@@ -49,20 +49,17 @@ void Neighbor::granular_nsq_no_newton_omp(NeighList *list)
 #endif
   NEIGH_OMP_SETUP(nlocal);
 
-  int i,j,m,n,nn;
+  int i,j,n,nn,d,dnum;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
-  int *neighptr,*touchptr;
-  double *shearptr;
+  int *neighptr,*touchptr,*neighpage,*touchpage;
+  double *shearptr,*shearpage;
 
-  int *npartner,**partner;
-  double ***shearpartner;
   int **firsttouch;
   double **firstshear;
 
   double **x = atom->x;
   double *radius = atom->radius;
-  int *tag = atom->tag;
   int *type = atom->type;
   int *mask = atom->mask;
   int *molecule = atom->molecule;
@@ -73,38 +70,54 @@ void Neighbor::granular_nsq_no_newton_omp(NeighList *list)
   int **firstneigh = list->firstneigh;
 
   if (fix_history) {
-    npartner = fix_history->npartner;
-    partner = fix_history->partner;
-    shearpartner = fix_history->shearpartner;
+    dnum = fix_history->dnum;
     firsttouch = listgranhistory->firstneigh;
     firstshear = listgranhistory->firstdouble;
   }
 
+  // each thread fills its own pages, tid + k*nthreads
+  // pages array can be reallocated by another thread,
+  // so it is only accessed in a critical section when a page is taken
+
   int npage = tid;
   int npnt = 0;
 
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+  {
+    neighpage = list->pages[npage];
+    if (fix_history) {
+      touchpage = listgranhistory->pages[npage];
+      shearpage = listgranhistory->dpages[npage];
+    }
+  }
+
   for (i = ifrom; i < ito; i++) {
 
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage += nthreads;
 #if defined(_OPENMP)
 #pragma omp critical
 #endif
-    {
-      if (pgsize - npnt < oneatom) {
-	npnt = 0;
-	npage += nthreads;
-	if (npage >= list->maxpage) {
-	  list->add_pages(nthreads);
-	  if (fix_history)
+      {
+	while (npage >= list->maxpage) list->add_pages(nthreads);
+	neighpage = list->pages[npage];
+	if (fix_history) {
+	  while (npage >= listgranhistory->maxpage)
 	    listgranhistory->add_pages(nthreads);
+	  touchpage = listgranhistory->pages[npage];
+	  shearpage = listgranhistory->dpages[npage];
 	}
       }
+    }
 
-      n = nn = 0;
-      neighptr = &(list->pages[npage][npnt]);
-      if (fix_history) {
-	touchptr = &(listgranhistory->pages[npage][npnt]);
-	shearptr = &(listgranhistory->dpages[npage][3*npnt]);
-      }
+    n = nn = 0;
+    neighptr = &neighpage[npnt];
+    if (fix_history) {
+      touchptr = &touchpage[npnt];
+      shearptr = &shearpage[dnum*npnt];
     }
 
     xtmp = x[i][0];
@@ -129,25 +142,12 @@ void Neighbor::granular_nsq_no_newton_omp(NeighList *list)
 	neighptr[n] = j;
 
 	if (fix_history) {
-	  if (rsq < radsum*radsum) {
-	    for (m = 0; m < npartner[i]; m++)
-	      if (partner[i][m] == tag[j]) break;
-	    if (m < npartner[i]) {
-	      touchptr[n] = 1;
-	      shearptr[nn++] = shearpartner[i][m][0];
-	      shearptr[nn++] = shearpartner[i][m][1];
-	      shearptr[nn++] = shearpartner[i][m][2];
-	    } else {
-	      touchptr[n] = 0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	    }
+	  if (rsq < radsum*radsum && fix_history->lookup(i,j,&shearptr[nn])) {
+	    touchptr[n] = 1;
+	    nn += dnum;
 	  } else {
 	    touchptr[n] = 0;
-	    shearptr[nn++] = 0.0;
-	    shearptr[nn++] = 0.0;
-	    shearptr[nn++] = 0.0;
+	    for (d = 0; d < dnum; d++) shearptr[nn++] = 0.0;
 	  }
 	}
 
@@ -193,7 +193,7 @@ void Neighbor::granular_nsq_newton_omp(NeighList *list)
   int i,j,n,itag,jtag;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
-  int *neighptr;
+  int *neighptr,*neighpage;
 
   double **x = atom->x;
   double *radius = atom->radius;
@@ -207,22 +207,34 @@ void Neighbor::granular_nsq_newton_omp(NeighList *list)
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
 
+  // each thread fills its own pages, tid + k*nthreads
+  // pages array can be reallocated by another thread,
+  // so it is only accessed in a critical section when a page is taken
+
   int npage = tid;
   int npnt = 0;
 
-  for (i = ifrom; i < ito; i++) {
-
 #if defined(_OPENMP)
 #pragma omp critical
 #endif
+  neighpage = list->pages[npage];
+
+  for (i = ifrom; i < ito; i++) {
+
     if (pgsize - npnt < oneatom) {
       npnt = 0;
       npage += nthreads;
-      if (npage >= list->maxpage) list->add_pages(nthreads);
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      {
+	while (npage >= list->maxpage) list->add_pages(nthreads);
+	neighpage = list->pages[npage];
+      }
     }
 
-    neighptr = &(list->pages[npage][npnt]);
     n = 0;
+    neighptr = &neighpage[npnt];
 
     itag = tag[i];
     xtmp = x[i][0];
@@ -304,14 +316,12 @@ void Neighbor::granular_bin_no_newton_omp(NeighList *list)
 #endif
   NEIGH_OMP_SETUP(nlocal);
 
-  int i,j,k,m,n,nn,ibin;
+  int i,j,k,n,nn,d,dnum,ibin;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
-  int *neighptr,*touchptr;
-  double *shearptr;
+  int *neighptr,*touchptr,*neighpage,*touchpage;
+  double *shearptr,*shearpage;
 
-  int *npartner,**partner;
-  double ***shearpartner;
   int **firsttouch;
   double **firstshear;
 
@@ -319,7 +329,6 @@ void Neighbor::granular_bin_no_newton_omp(NeighList *list)
 
   double **x = atom->x;
   double *radius = atom->radius;
-  int *tag = atom->tag;
   int *type = atom->type;
   int *mask = atom->mask;
   int *molecule = atom->molecule;
@@ -331,38 +340,54 @@ void Neighbor::granular_bin_no_newton_omp(NeighList *list)
   int *stencil = list->stencil;
 
   if (fix_history) {
-    npartner = fix_history->npartner;
-    partner = fix_history->partner;
-    shearpartner = fix_history->shearpartner;
+    dnum = fix_history->dnum;
     firsttouch = listgranhistory->firstneigh;
     firstshear = listgranhistory->firstdouble;
   }
 
+  // each thread fills its own pages, tid + k*nthreads
+  // pages array can be reallocated by another thread,
+  // so it is only accessed in a critical section when a page is taken
+
   int npage = tid;
   int npnt = 0;
 
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+  {
+    neighpage = list->pages[npage];
+    if (fix_history) {
+      touchpage = listgranhistory->pages[npage];
+      shearpage = listgranhistory->dpages[npage];
+    }
+  }
+
   for (i = ifrom; i < ito; i++) {
 
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage += nthreads;
 #if defined(_OPENMP)
 #pragma omp critical
 #endif
-    {
-      if (pgsize - npnt < oneatom) {
-	npnt = 0;
-	npage += nthreads;
-	if (npage >= list->maxpage) {
-	  list->add_pages(nthreads);
-	  if (fix_history)
+      {
+	while (npage >= list->maxpage) list->add_pages(nthreads);
+	neighpage = list->pages[npage];
+	if (fix_history) {
+	  while (npage >= listgranhistory->maxpage)
 	    listgranhistory->add_pages(nthreads);
+	  touchpage = listgranhistory->pages[npage];
+	  shearpage = listgranhistory->dpages[npage];
 	}
       }
+    }
 
-      n = nn = 0;
-      neighptr = &(list->pages[npage][npnt]);
-      if (fix_history) {
-	touchptr = &(listgranhistory->pages[npage][npnt]);
-	shearptr = &(listgranhistory->dpages[npage][3*npnt]);
-      }
+    n = nn = 0;
+    neighptr = &neighpage[npnt];
+    if (fix_history) {
+      touchptr = &touchpage[npnt];
+      shearptr = &shearpage[dnum*npnt];
     }
 
     xtmp = x[i][0];
@@ -392,25 +417,13 @@ void Neighbor::granular_bin_no_newton_omp(NeighList *list)
 	  neighptr[n] = j;
 
 	  if (fix_history) {
-	    if (rsq < radsum*radsum) {
-	      for (m = 0; m < npartner[i]; m++)
-		if (partner[i][m] == tag[j]) break;
-	      if (m < npartner[i]) {
-		touchptr[n] = 1;
-		shearptr[nn++] = shearpartner[i][m][0];
-		shearptr[nn++] = shearpartner[i][m][1];
-		shearptr[nn++] = shearpartner[i][m][2];
-	      } else {
-		touchptr[n] = 0;
-		shearptr[nn++] = 0.0;
-		shearptr[nn++] = 0.0;
-		shearptr[nn++] = 0.0;
-	      }
+	    if (rsq < radsum*radsum && 
+		fix_history->lookup(i,j,&shearptr[nn])) {
+	      touchptr[n] = 1;
+	      nn += dnum;
 	    } else {
 	      touchptr[n] = 0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
+	      for (d = 0; d < dnum; d++) shearptr[nn++] = 0.0;
 	    }
 	  }
 
@@ -459,7 +472,7 @@ void Neighbor::granular_bin_newton_omp(NeighList *list)
   int i,j,k,n,ibin;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
-  int *neighptr;
+  int *neighptr,*neighpage;
 
   // loop over each atom, storing neighbors
 
@@ -475,22 +488,34 @@ void Neighbor::granular_bin_newton_omp(NeighList *list)
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
+  // each thread fills its own pages, tid + k*nthreads
+  // pages array can be reallocated by another thread,
+  // so it is only accessed in a critical section when a page is taken
+
   int npage = tid;
   int npnt = 0;
 
-  for (i = ifrom; i < ito; i++) {
-
 #if defined(_OPENMP)
 #pragma omp critical
 #endif
+  neighpage = list->pages[npage];
+
+  for (i = ifrom; i < ito; i++) {
+
     if (pgsize - npnt < oneatom) {
       npnt = 0;
       npage += nthreads;
-      if (npage >= list->maxpage) list->add_pages(nthreads);
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      {
+	while (npage >= list->maxpage) list->add_pages(nthreads);
+	neighpage = list->pages[npage];
+      }
     }
 
     n = 0;
-    neighptr = &(list->pages[npage][npnt]);
+    neighptr = &neighpage[npnt];
 
     xtmp = x[i][0];
     ytmp = x[i][1];
@@ -576,7 +601,7 @@ void Neighbor::granular_bin_newton_tri_omp(NeighList *list)
   int i,j,k,n,ibin;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
-  int *neighptr;
+  int *neighptr,*neighpage;
 
   // loop over each atom, storing neighbors
 
@@ -592,22 +617,34 @@ void Neighbor::granular_bin_newton_tri_omp(NeighList *list)
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
+  // each thread fills its own pages, tid + k*nthreads
+  // pages array can be reallocated by another thread,
+  // so it is only accessed in a critical section when a page is taken
+
   int npage = tid;
   int npnt = 0;
 
-  for (i = ifrom; i < ito; i++) {
-
 #if defined(_OPENMP)
 #pragma omp critical
 #endif
+  neighpage = list->pages[npage];
+
+  for (i = ifrom; i < ito; i++) {
+
     if (pgsize - npnt < oneatom) {
       npnt = 0;
       npage += nthreads;
-      if (npage >= list->maxpage) list->add_pages(nthreads);
+#if defined(_OPENMP)
+#pragma omp critical
+#endif
+      {
+	while (npage >= list->maxpage) list->add_pages(nthreads);
+	neighpage = list->pages[npage];
+      }
     }
 
     n = 0;
-    neighptr = &(list->pages[npage][npnt]);
+    neighptr = &neighpage[npnt];
 
     xtmp = x[i][0];
     ytmp = x[i][1];
@@ -31,6 +31,8 @@ PairGranHertzHistoryOMP::PairGranHertzHistoryOMP(LAMMPS *lmp) :
 {
   suffix_flag |= Suffix::OMP;
   respa_enable = 0;
+  // compute() does not support split calls over ilist
+  overlap_flag = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -33,6 +33,8 @@ PairGranHookeHistoryOMP::PairGranHookeHistoryOMP(LAMMPS *lmp) :
 {
   suffix_flag |= Suffix::OMP;
   respa_enable = 0;
+  // compute() does not support split calls over ilist
+  overlap_flag = 0;
   // trigger use of OpenMP version of FixShearHistory
   suffix = new char[4];
   memcpy(suffix,"omp",4);
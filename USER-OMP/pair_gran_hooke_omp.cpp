@@ -30,6 +30,8 @@ PairGranHookeOMP::PairGranHookeOMP(LAMMPS *lmp) :
 {
   suffix_flag |= Suffix::OMP;
   respa_enable = 0;
+  // compute() does not support split calls over ilist
+  overlap_flag = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -41,6 +41,16 @@ using namespace LAMMPS_NS;
 #define DELTA_MEMSTR 1024
 #define EPSILON 1.0e-6
 #define CUDA_CHUNK 3000
+#define MAXCURVEBITS 21
+
+enum{ROWMAJOR,MORTON,HILBERT};
+
+// curve key of one sort bin, sorted to assign binrank
+
+struct SortKey {
+  uint64_t key;
+  int bin;
+};
 
 /* ---------------------------------------------------------------------- */
 
@@ -61,6 +71,8 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   maxbin = maxnext = 0;
   binhead = NULL;
   next = permute = NULL;
+  binrank = NULL;
+  sortcurve = ROWMAJOR;
 
   // initialize atom arrays
   // customize by adding new array
@@ -161,6 +173,7 @@ Atom::~Atom()
 
   delete [] firstgroupname;
   memory->destroy(binhead);
+  memory->destroy(binrank);
   memory->destroy(next);
   memory->destroy(permute);
 
@@ -426,6 +439,13 @@ void Atom::modify_params(int narg, char **arg)
 	error->all(FLERR,"Atom_modify sort and first options "
 		   "cannot be used together");
       iarg += 3;
+    } else if (strcmp(arg[iarg],"curve") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal atom_modify command");
+      if (strcmp(arg[iarg+1],"rowmajor") == 0) sortcurve = ROWMAJOR;
+      else if (strcmp(arg[iarg+1],"morton") == 0) sortcurve = MORTON;
+      else if (strcmp(arg[iarg+1],"hilbert") == 0) sortcurve = HILBERT;
+      else error->all(FLERR,"Illegal atom_modify command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal atom_modify command");
   }
 }
@@ -750,9 +770,12 @@ int Atom::count_words(const char *line)
 /* ----------------------------------------------------------------------
    unpack n lines from Atom section of data file
    call style-specific routine to parse line
+   if subflag = 1, all procs see same lines, keep atoms in my sub-domain
+   if subflag = 0, procs see different lines, keep all atoms in the box,
+     caller migrates them to owning procs
 ------------------------------------------------------------------------- */
 
-void Atom::data_atoms(int n, char *buf)
+void Atom::data_atoms(int n, char *buf, int subflag)
 {
   int m,imagedata,xptr,iptr;
   double xdata[3],lamda[3];
@@ -764,12 +787,14 @@ void Atom::data_atoms(int n, char *buf)
   int nwords = count_words(buf);
   *next = '\n';
 
-  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3)
-    error->all(FLERR,"Incorrect atom format in data file");
+  if (nwords != avec->size_data_atom && nwords != avec->size_data_atom + 3) {
+    if (subflag) error->all(FLERR,"Incorrect atom format in data file");
+    else error->one(FLERR,"Incorrect atom format in data file");
+  }
 
   char **values = new char*[nwords];
 
-  // set bounds for my proc
+  // set bounds for my proc, or for entire box if not subflag
   // if periodic and I am lo/hi proc, adjust bounds by EPSILON
   // insures all data atoms will be owned even with round-off
 
@@ -784,27 +809,45 @@ void Atom::data_atoms(int n, char *buf)
   }
 
   double sublo[3],subhi[3];
-  if (triclinic == 0) {
-    sublo[0] = domain->sublo[0]; subhi[0] = domain->subhi[0];
-    sublo[1] = domain->sublo[1]; subhi[1] = domain->subhi[1];
-    sublo[2] = domain->sublo[2]; subhi[2] = domain->subhi[2];
+  int lo[3],hi[3];
+  if (subflag) {
+    for (m = 0; m < 3; m++) {
+      lo[m] = (comm->myloc[m] == 0);
+      hi[m] = (comm->myloc[m] == comm->procgrid[m]-1);
+    }
+    if (triclinic == 0) {
+      sublo[0] = domain->sublo[0]; subhi[0] = domain->subhi[0];
+      sublo[1] = domain->sublo[1]; subhi[1] = domain->subhi[1];
+      sublo[2] = domain->sublo[2]; subhi[2] = domain->subhi[2];
+    } else {
+      sublo[0] = domain->sublo_lamda[0]; subhi[0] = domain->subhi_lamda[0];
+      sublo[1] = domain->sublo_lamda[1]; subhi[1] = domain->subhi_lamda[1];
+      sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
+    }
   } else {
-    sublo[0] = domain->sublo_lamda[0]; subhi[0] = domain->subhi_lamda[0];
-    sublo[1] = domain->sublo_lamda[1]; subhi[1] = domain->subhi_lamda[1];
-    sublo[2] = domain->sublo_lamda[2]; subhi[2] = domain->subhi_lamda[2];
+    for (m = 0; m < 3; m++) lo[m] = hi[m] = 1;
+    if (triclinic == 0) {
+      sublo[0] = domain->boxlo[0]; subhi[0] = domain->boxhi[0];
+      sublo[1] = domain->boxlo[1]; subhi[1] = domain->boxhi[1];
+      sublo[2] = domain->boxlo[2]; subhi[2] = domain->boxhi[2];
+    } else {
+      sublo[0] = domain->boxlo_lamda[0]; subhi[0] = domain->boxhi_lamda[0];
+      sublo[1] = domain->boxlo_lamda[1]; subhi[1] = domain->boxhi_lamda[1];
+      sublo[2] = domain->boxlo_lamda[2]; subhi[2] = domain->boxhi_lamda[2];
+    }
   }
 
   if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += epsilon[0];
+    if (lo[0]) sublo[0] -= epsilon[0];
+    if (hi[0]) subhi[0] += epsilon[0];
   }
   if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= epsilon[1];
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] += epsilon[1];
+    if (lo[1]) sublo[1] -= epsilon[1];
+    if (hi[1]) subhi[1] += epsilon[1];
   }
   if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= epsilon[2];
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] += epsilon[2];
+    if (lo[2]) sublo[2] -= epsilon[2];
+    if (hi[2]) subhi[2] += epsilon[2];
   }
 
   // xptr = which word in line starts xyz coords
@@ -825,12 +868,11 @@ void Atom::data_atoms(int n, char *buf)
     next = strchr(buf,'\n');
 
     values[0] = strtok(buf," \t\n\r\f");
-    if (values[0] == NULL) 
-      error->all(FLERR,"Incorrect atom format in data file");
-    for (m = 1; m < nwords; m++) {
+    for (m = 1; m < nwords; m++)
       values[m] = strtok(NULL," \t\n\r\f");
-      if (values[m] == NULL) 
-	error->all(FLERR,"Incorrect atom format in data file");
+    if (values[0] == NULL || values[nwords-1] == NULL) {
+      if (subflag) error->all(FLERR,"Incorrect atom format in data file");
+      else error->one(FLERR,"Incorrect atom format in data file");
     }
 
     if (imageflag)
@@ -1379,11 +1421,15 @@ void Atom::sort()
 
   if (nlocal == nmax) avec->grow(0);
 
-  // bin atoms in reverse order so linked list will be in forward order
+  // bin of each atom, stored temporarily in permute
+  // for sort curve, bins are numbered by position along curve
 
-  for (i = 0; i < nbins; i++) binhead[i] = -1;
+  int *abin = permute;
 
-  for (i = nlocal-1; i >= 0; i--) {
+#if defined(_OPENMP)
+#pragma omp parallel for private(ix,iy,iz,ibin) default(shared)
+#endif
+  for (i = 0; i < nlocal; i++) {
     ix = static_cast<int> ((x[i][0]-bboxlo[0])*bininvx);
     iy = static_cast<int> ((x[i][1]-bboxlo[1])*bininvy);
     iz = static_cast<int> ((x[i][2]-bboxlo[2])*bininvz);
@@ -1394,6 +1440,16 @@ void Atom::sort()
     iy = MIN(iy,nbiny-1);
     iz = MIN(iz,nbinz-1);
     ibin = iz*nbiny*nbinx + iy*nbinx + ix;
+    if (binrank) ibin = binrank[ibin];
+    abin[i] = ibin;
+  }
+
+  // bin atoms in reverse order so linked list will be in forward order
+
+  for (i = 0; i < nbins; i++) binhead[i] = -1;
+
+  for (i = nlocal-1; i >= 0; i--) {
+    ibin = abin[i];
     next[i] = binhead[ibin];
     binhead[ibin] = i;
   }
@@ -1516,9 +1572,96 @@ void Atom::setup_sort_bins()
 
   if (nbins > maxbin) {
     memory->destroy(binhead);
+    memory->destroy(binrank);
     maxbin = nbins;
     memory->create(binhead,maxbin,"atom:binhead");
   }
+
+  setup_sort_curve();
+}
+
+/* ----------------------------------------------------------------------
+   set binrank = position of each row-major bin along Morton or Hilbert curve
+   curve is laid over smallest power-of-2 grid that covers all bins,
+     then ranks are made contiguous by sorting the curve keys
+   Hilbert key is Skilling's transpose of the axes, then interleaved
+------------------------------------------------------------------------- */
+
+void Atom::setup_sort_curve()
+{
+  if (sortcurve == ROWMAJOR) {
+    memory->destroy(binrank);
+    return;
+  }
+
+  int nmaxbin = MAX(nbinx,nbiny);
+  nmaxbin = MAX(nmaxbin,nbinz);
+  int nbits = 1;
+  while ((1 << nbits) < nmaxbin) nbits++;
+  if (nbits > MAXCURVEBITS)
+    error->one(FLERR,"Too many atom sorting bins for sort curve");
+
+  int ndim = domain->dimension;
+  if (binrank == NULL) memory->create(binrank,maxbin,"atom:binrank");
+  SortKey *keys = (SortKey *)
+    memory->smalloc(nbins*sizeof(SortKey),"atom:sortkeys");
+
+  unsigned int c[3],p,q,t;
+
+  int ibin = 0;
+  for (int iz = 0; iz < nbinz; iz++)
+    for (int iy = 0; iy < nbiny; iy++)
+      for (int ix = 0; ix < nbinx; ix++) {
+	c[0] = ix;
+	c[1] = iy;
+	c[2] = iz;
+
+	if (sortcurve == HILBERT) {
+	  for (q = 1U << (nbits-1); q > 1; q >>= 1) {
+	    p = q - 1;
+	    for (int d = 0; d < ndim; d++)
+	      if (c[d] & q) c[0] ^= p;
+	      else {
+		t = (c[0] ^ c[d]) & p;
+		c[0] ^= t;
+		c[d] ^= t;
+	      }
+	  }
+	  for (int d = 1; d < ndim; d++) c[d] ^= c[d-1];
+	  t = 0;
+	  for (q = 1U << (nbits-1); q > 1; q >>= 1)
+	    if (c[ndim-1] & q) t ^= q - 1;
+	  for (int d = 0; d < ndim; d++) c[d] ^= t;
+	}
+
+	uint64_t key = 0;
+	for (int b = nbits-1; b >= 0; b--)
+	  for (int d = 0; d < ndim; d++)
+	    key = (key << 1) | ((c[d] >> b) & 1);
+
+	keys[ibin].key = key;
+	keys[ibin].bin = ibin;
+	ibin++;
+      }
+
+  qsort(keys,nbins,sizeof(SortKey),keycompare);
+  for (int i = 0; i < nbins; i++) binrank[keys[i].bin] = i;
+  memory->sfree(keys);
+}
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort()
+   sort bins by curve key
+------------------------------------------------------------------------- */
+
+int Atom::keycompare(const void *pi, const void *pj)
+{
+  uint64_t ikey = ((SortKey *) pi)->key;
+  uint64_t jkey = ((SortKey *) pj)->key;
+
+  if (ikey < jkey) return -1;
+  if (ikey > jkey) return 1;
+  return 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -1648,6 +1791,7 @@ bigint Atom::memory_usage()
     bytes += memory->usage(next,maxnext);
     bytes += memory->usage(permute,maxnext);
   }
+  if (binrank) bytes += memory->usage(binrank,maxbin);
 
   return bytes;
 }
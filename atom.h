@@ -137,7 +137,7 @@ class Atom : protected Pointers {
   int parse_data(const char *);
   int count_words(const char *);
 
-  void data_atoms(int, char *);
+  void data_atoms(int, char *, int);
   void data_vels(int, char *);
   void data_bonus(int, char *, class AtomVec *);
 
@@ -216,6 +216,8 @@ class Atom : protected Pointers {
   int *binhead;                   // 1st atom in each bin
   int *next;                      // next atom in bin
   int *permute;                   // permutation vector
+  int *binrank;                   // position of each bin along sort curve
+  int sortcurve;                  // ROWMAJOR, MORTON, or HILBERT bin order
   double userbinsize;             // requested sort bin size
   double bininvx,bininvy,bininvz; // inverse actual bin sizes
   double bboxlo[3],bboxhi[3];     // bounding box of my sub-domain
@@ -224,6 +226,8 @@ class Atom : protected Pointers {
   char *memstr;                   // string of array names already counted
 
   void setup_sort_bins();
+  void setup_sort_curve();
+  static int keycompare(const void *, const void *);
 };
 
 }
@@ -361,6 +365,11 @@ The neighbor cutoff is being used as the bin size, but it is zero.
 Thus you must explicitly list a bin size in the atom_modify sort
 command or turn off sorting.
 
+E: Too many atom sorting bins for sort curve
+
+Morton and Hilbert ordering need at most 2^21 sorting bins in each
+dimension.  Use a larger bin size.
+
 E: Too many atom sorting bins
 
 This is likely due to an immense simulation box that has blown up
@@ -32,9 +32,9 @@ enum{NONE,UNIFORM,USER,DYNAMIC};
 enum{X,Y,Z};
 enum{EXPAND,CONTRACT};
 
-#define BIG
+#define BIG 1.0e20
 
-#define BALANCE_DEBUG 1
+//#define BALANCE_DEBUG 1
 
 /* ---------------------------------------------------------------------- */
 
@@ -45,6 +45,9 @@ Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
 
   memory->create(pcount,nprocs,"balance:pcount");
   memory->create(allcount,nprocs,"balance:allcount");
+  memory->create(pweight,nprocs,"balance:pweight");
+  memory->create(allweight,nprocs,"balance:allweight");
+  weight = NULL;
 
   user_xsplit = user_ysplit = user_zsplit = NULL;
   dflag = 0;
@@ -58,6 +61,8 @@ Balance::~Balance()
 {
   memory->destroy(pcount);
   memory->destroy(allcount);
+  memory->destroy(pweight);
+  memory->destroy(allweight);
 
   delete [] user_xsplit;
   delete [] user_ysplit;
@@ -380,6 +385,7 @@ double Balance::imbalance_nlocal(int &max)
    map atoms to 3d grid of procs
    return max = max atom per proc
    return imbalance factor = max atom per proc / ave atom per proc
+     or max weight per proc / ave weight per proc if weights are set
 ------------------------------------------------------------------------- */
 
 double Balance::imbalance_splits(int &max)
@@ -393,25 +399,51 @@ double Balance::imbalance_splits(int &max)
   int nz = comm->procgrid[2];
 
   for (int i = 0; i < nprocs; i++) pcount[i] = 0;
+  if (weight)
+    for (int i = 0; i < nprocs; i++) pweight[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
-  int ix,iy,iz;
+  int ix,iy,iz,index;
 
   for (int i = 0; i < nlocal; i++) {
     ix = binary(x[i][0],nx,xsplit);
     iy = binary(x[i][1],ny,ysplit);
     iz = binary(x[i][2],nz,zsplit);
-    pcount[iz*nx*ny + iy*nx + ix]++;
+    index = iz*nx*ny + iy*nx + ix;
+    pcount[index]++;
+    if (weight) pweight[index] += weight[i];
   }
 
   MPI_Allreduce(pcount,allcount,nprocs,MPI_INT,MPI_SUM,world);
   max = 0;
   for (int i = 0; i < nprocs; i++) max = MAX(max,allcount[i]);
   double imbalance = max / (1.0 * atom->natoms / nprocs);
+
+  if (weight) {
+    MPI_Allreduce(pweight,allweight,nprocs,MPI_DOUBLE,MPI_SUM,world);
+    double wmax = 0.0;
+    double wsum = 0.0;
+    for (int i = 0; i < nprocs; i++) {
+      wmax = MAX(wmax,allweight[i]);
+      wsum += allweight[i];
+    }
+    if (wsum > 0.0) imbalance = wmax / (wsum/nprocs);
+  }
+
   return imbalance;
 }
 
+/* ----------------------------------------------------------------------
+   set per-atom cost used by dynamic(), NULL to balance atom counts
+   must stay valid until dynamic() returns
+------------------------------------------------------------------------- */
+
+void Balance::set_weight(double *weight_in)
+{
+  weight = weight_in;
+}
+
 /* ----------------------------------------------------------------------
    setup static load balance operations
    called from command
@@ -432,14 +464,14 @@ void Balance::dynamic_setup(char *str)
   splits[1] = comm->ysplit;
   splits[2] = comm->zsplit;
 
-  counts[0] = new bigint[comm->procgrid[0]];
-  counts[1] = new bigint[comm->procgrid[1]];
-  counts[2] = new bigint[comm->procgrid[2]];
+  counts[0] = new double[comm->procgrid[0]];
+  counts[1] = new double[comm->procgrid[1]];
+  counts[2] = new double[comm->procgrid[2]];
 
   int max = MAX(comm->procgrid[0],comm->procgrid[1]);
   max = MAX(max,comm->procgrid[2]);
   cuts = new double[max+1];
-  onecount = new bigint[max];
+  onecount = new double[max];
 
   //MPI_Comm_split(world,comm->myloc[0],0,&commslice[0]);
   //MPI_Comm_split(world,comm->myloc[1],0,&commslice[1]);
@@ -503,6 +535,7 @@ int Balance::dynamic_once()
 /* ----------------------------------------------------------------------
    perform dynamic load balance by changing xyz split proc boundaries in Comm
    called from fix balance
+   set imbinit/imbfinal, no change if imbinit is already below thresh
    return actual iteration count
 ------------------------------------------------------------------------- */
 
@@ -519,6 +552,12 @@ int Balance::dynamic()
 
   domain->x2lamda(atom->nlocal);
 
+  imbinit = imbfinal = imbalance_splits(max);
+  if (imbinit <= thresh) {
+    domain->lamda2x(atom->nlocal);
+    return 0;
+  }
+
   int count = 0;
   for (int irepeat = 0; irepeat < nrepeat; irepeat++) {
     for (i = 0; i < nops; i++) {
@@ -532,6 +571,7 @@ int Balance::dynamic()
 #endif
       }
       imbfactor = imbalance_splits(max);
+      imbfinal = imbfactor;
       if (imbfactor <= thresh) break;
     }
     if (i < nops) break;
@@ -547,14 +587,14 @@ int Balance::dynamic()
 }
 
 /* ----------------------------------------------------------------------
-   count atoms in each slice
+   count atoms in each slice, or sum their weights if set
    current cuts may be very different than original cuts,
    so use binary search to find which slice each atom is in
 ------------------------------------------------------------------------- */
 
-void Balance::stats(int dim, int n, double *split, bigint *count)
+void Balance::stats(int dim, int n, double *split, double *count)
 {
-  for (int i = 0; i < n; i++) onecount[i] = 0;
+  for (int i = 0; i < n; i++) onecount[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
@@ -562,22 +602,23 @@ void Balance::stats(int dim, int n, double *split, bigint *count)
 
   for (int i = 0; i < nlocal; i++) {
     index = binary(x[i][dim],n,split);
-    onecount[index]++;
+    if (weight) onecount[index] += weight[i];
+    else onecount[index] += 1.0;
   }
 
-  MPI_Allreduce(onecount,count,n,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(onecount,count,n,MPI_DOUBLE,MPI_SUM,world);
 }
 
 /* ----------------------------------------------------------------------
    adjust cuts between N slices in a dim via diffusive method
-   count = atoms per slice
+   count = atoms or summed weight per slice
    split = current N+1 cuts, with 0.0 and 1.0 at end points
    overwrite split with new cuts
    diffusion means slices with more atoms than their neighbors "send" atoms,
      by moving cut closer to sender, further from receiver
 ------------------------------------------------------------------------- */
 
-void Balance::adjust(int n, bigint *count, double *split)
+void Balance::adjust(int n, double *count, double *split)
 {
   // damping factor
 
@@ -589,14 +630,14 @@ void Balance::adjust(int n, bigint *count, double *split)
   // for a cut between 2 slices, only slice with larger count adjusts it
   // special treatment of end slices with only 1 neighbor
 
-  bigint leftcount,mycount,rightcount;
+  double leftcount,mycount,rightcount;
   double rho,target,targetleft,targetright;
 
   for (int i = 0; i < n; i++) {
-    if (i == 0) leftcount = MAXBIGINT;
+    if (i == 0) leftcount = BIG;
     else leftcount = count[i-1];
     mycount = count[i];
-    if (i == n-1) rightcount = MAXBIGINT;
+    if (i == n-1) rightcount = BIG;
     else rightcount = count[i+1];
 
     // middle slice is <= both left and right, so do nothing
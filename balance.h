@@ -33,8 +33,11 @@ class Balance : protected Pointers {
   void command(int, char **);
   void dynamic_setup(int, int, char *, double);
   int dynamic();
+  void set_weight(double *);
   double imbalance_nlocal(int &);
 
+  double imbinit,imbfinal;       // imbalance before/after last dynamic()
+
  private:
   int me,nprocs;
   int xflag,yflag,zflag,dflag;
@@ -46,12 +49,14 @@ class Balance : protected Pointers {
   int *ops;
   int nops;
   double *splits[3];
-  bigint *counts[3];
+  double *counts[3];
   double *cuts;
-  bigint *onecount;
+  double *onecount;
+  double *weight;                // per-atom cost, NULL = count atoms
   MPI_Comm commslice[3];
 
   int *pcount,*allcount;
+  double *pweight,*allweight;
 
   FILE *fp;                      // for debug output
   bigint laststep;
@@ -59,8 +64,8 @@ class Balance : protected Pointers {
   void dynamic_setup(char *);
   int dynamic_once();
   double imbalance_splits(int &);
-  void stats(int, int, double *, bigint *);
-  void adjust(int, bigint *, double *);
+  void stats(int, int, double *, double *);
+  void adjust(int, double *, double *);
   int binary(double, int, double *);
 
   void dumpout(bigint);          // for debug output
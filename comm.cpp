@@ -84,6 +84,7 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   cutghostmulti = NULL;
   cutghostuser = 0.0;
   ghost_velocity = 0;
+  overlap = 0;
 
   // use of OpenMP threads
   // query OpenMP for number of threads/process set by user at run-time
@@ -107,7 +108,8 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   // initialize comm buffers & exchange memory
 
   maxsend = BUFMIN;
-  memory->create(buf_send,maxsend+BUFEXTRA,"comm:buf_send");
+  bufextra = BUFEXTRA;
+  memory->create(buf_send,maxsend+bufextra,"comm:buf_send");
   maxrecv = BUFMIN;
   memory->create(buf_recv,maxrecv,"comm:buf_recv");
 
@@ -120,6 +122,10 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
     maxsendlist[i] = BUFMIN;
     memory->create(sendlist[i],BUFMIN,"comm:sendlist[i]");
   }
+
+  buf_send_overlap = buf_recv_overlap = NULL;
+  maxsend_overlap = maxrecv_overlap = 0;
+  nrequest_overlap = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -147,6 +153,8 @@ Comm::~Comm()
 
   memory->destroy(buf_send);
   memory->destroy(buf_recv);
+  memory->destroy(buf_send_overlap);
+  memory->destroy(buf_recv_overlap);
 }
 
 /* ----------------------------------------------------------------------
@@ -379,12 +387,15 @@ void Comm::setup()
   //   cutghost is in lamda coords = distance between those planes
   // for multi:
   //   cutghostmulti = same as cutghost, only for each atom type
+  // fixes like insertion fixes can extend cutghost via extend_cut_ghost()
 
   int i;
   int ntypes = atom->ntypes;
   double *prd,*sublo,*subhi;
   
+  double cutfix = modify->max_extend_cut_ghost();
   double cut = MAX(neighbor->cutneighmax,cutghostuser);
+  cut = MAX(cut,cutfix);
 
   if (triclinic == 0) {
     prd = domain->prd;
@@ -396,7 +407,7 @@ void Comm::setup()
       double *cuttype = neighbor->cuttype;
       for (i = 1; i <= ntypes; i++)
 	cutghostmulti[i][0] = cutghostmulti[i][1] = cutghostmulti[i][2] = 
-	  cuttype[i];
+	  MAX(cuttype[i],cutfix);
     }
 
   } else {
@@ -415,9 +426,9 @@ void Comm::setup()
     if (style == MULTI) {
       double *cuttype = neighbor->cuttype;
       for (i = 1; i <= ntypes; i++) {
-	cutghostmulti[i][0] = cuttype[i] * length0;
-	cutghostmulti[i][1] = cuttype[i] * length1;
-	cutghostmulti[i][2] = cuttype[i] * length2;
+	cutghostmulti[i][0] = MAX(cuttype[i],cutfix) * length0;
+	cutghostmulti[i][1] = MAX(cuttype[i],cutfix) * length1;
+	cutghostmulti[i][2] = MAX(cuttype[i],cutfix) * length2;
       }
     }
   }
@@ -779,6 +790,235 @@ void Comm::reverse_comm()
   }
 }
 
+/* ----------------------------------------------------------------------
+   overlapped forward communication of atom coords
+   swaps 2*istage and 2*istage+1 of a stage send in opposite directions
+     from the same range of atoms, so both can be in flight at once
+   a stage may send ghosts received in earlier stages,
+     so stages are posted one at a time
+   between start() and finish(), caller must not access ghost coords
+------------------------------------------------------------------------- */
+
+void Comm::forward_comm_start()
+{
+  if (nswap) forward_stage_post(0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Comm::forward_comm_finish()
+{
+  int nstage = nswap/2;
+  for (int istage = 0; istage < nstage; istage++) {
+    forward_stage_wait(istage);
+    if (istage+1 < nstage) forward_stage_post(istage+1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   overlapped reverse communication of forces on ghost atoms
+   stages are done in reverse order of forward comm
+   between start() and finish(), caller must not access ghost forces
+------------------------------------------------------------------------- */
+
+void Comm::reverse_comm_start()
+{
+  if (nswap) reverse_stage_post(nswap/2-1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Comm::reverse_comm_finish()
+{
+  for (int istage = nswap/2-1; istage >= 0; istage--) {
+    reverse_stage_wait(istage);
+    if (istage > 0) reverse_stage_post(istage-1);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack both swaps of a forward stage and post non-blocking sends/recvs
+   each swap gets its own part of the overlap buffers
+   swap with self is done immediately
+   message tag = swap index, since both swaps may have the same partner
+------------------------------------------------------------------------- */
+
+void Comm::forward_stage_post(int istage)
+{
+  int k,n,iswap,nsend,nrecv;
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+  double *buf;
+
+  nsend = nrecv = 0;
+  for (k = 0; k < 2; k++) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] == me) continue;
+    nsend += sendnum[iswap]*size_forward;
+    if (!comm_x_only) nrecv += size_forward_recv[iswap];
+  }
+  grow_overlap(nsend,nrecv);
+
+  nrequest_overlap = 0;
+  nsend = nrecv = 0;
+
+  for (k = 0; k < 2; k++) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] != me) {
+      if (comm_x_only) {
+	if (size_forward_recv[iswap]) buf = x[firstrecv[iswap]];
+	else buf = NULL;
+      } else buf = &buf_recv_overlap[nrecv];
+      offset_overlap[k] = nrecv;
+      if (size_forward_recv[iswap]) {
+	MPI_Irecv(buf,size_forward_recv[iswap],MPI_DOUBLE,
+		  recvproc[iswap],iswap,world,
+		  &request_overlap[nrequest_overlap++]);
+	if (!comm_x_only) nrecv += size_forward_recv[iswap];
+      }
+      if (ghost_velocity && !comm_x_only)
+	n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+				&buf_send_overlap[nsend],
+				pbc_flag[iswap],pbc[iswap]);
+      else
+	n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+			    &buf_send_overlap[nsend],
+			    pbc_flag[iswap],pbc[iswap]);
+      if (n) MPI_Isend(&buf_send_overlap[nsend],n,MPI_DOUBLE,
+		       sendproc[iswap],iswap,world,
+		       &request_overlap[nrequest_overlap++]);
+      nsend += n;
+
+    } else {
+      if (comm_x_only) {
+	if (sendnum[iswap])
+	  n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+			      x[firstrecv[iswap]],pbc_flag[iswap],
+			      pbc[iswap]);
+      } else if (ghost_velocity) {
+	n = avec->pack_comm_vel(sendnum[iswap],sendlist[iswap],
+				buf_send,pbc_flag[iswap],pbc[iswap]);
+	avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],buf_send);
+      } else {
+	n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+			    buf_send,pbc_flag[iswap],pbc[iswap]);
+	avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf_send);
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   complete the messages of a forward stage and unpack ghost values
+   if comm_x_only set, values were received directly into x
+------------------------------------------------------------------------- */
+
+void Comm::forward_stage_wait(int istage)
+{
+  int k,iswap;
+  MPI_Status status[4];
+  AtomVec *avec = atom->avec;
+
+  if (nrequest_overlap) MPI_Waitall(nrequest_overlap,request_overlap,status);
+  nrequest_overlap = 0;
+  if (comm_x_only) return;
+
+  for (k = 0; k < 2; k++) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] == me) continue;
+    if (ghost_velocity)
+      avec->unpack_comm_vel(recvnum[iswap],firstrecv[iswap],
+			    &buf_recv_overlap[offset_overlap[k]]);
+    else
+      avec->unpack_comm(recvnum[iswap],firstrecv[iswap],
+			&buf_recv_overlap[offset_overlap[k]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack ghost forces of both swaps of a reverse stage and post
+     non-blocking sends/recvs
+   if comm_f_only set, send directly from f, ghost forces of a stage
+     are not modified until the stage completes
+   swap with self is done immediately
+------------------------------------------------------------------------- */
+
+void Comm::reverse_stage_post(int istage)
+{
+  int k,n,iswap,nsend,nrecv;
+  AtomVec *avec = atom->avec;
+  double **f = atom->f;
+
+  nsend = nrecv = 0;
+  for (k = 0; k < 2; k++) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] == me) continue;
+    if (!comm_f_only) nsend += size_reverse_send[iswap];
+    nrecv += size_reverse_recv[iswap];
+  }
+  grow_overlap(nsend,nrecv);
+
+  nrequest_overlap = 0;
+  nsend = nrecv = 0;
+
+  for (k = 1; k >= 0; k--) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] != me) {
+      offset_overlap[k] = nrecv;
+      if (size_reverse_recv[iswap]) {
+	MPI_Irecv(&buf_recv_overlap[nrecv],size_reverse_recv[iswap],
+		  MPI_DOUBLE,sendproc[iswap],iswap,world,
+		  &request_overlap[nrequest_overlap++]);
+	nrecv += size_reverse_recv[iswap];
+      }
+      if (comm_f_only) {
+	if (size_reverse_send[iswap])
+	  MPI_Isend(f[firstrecv[iswap]],size_reverse_send[iswap],MPI_DOUBLE,
+		    recvproc[iswap],iswap,world,
+		    &request_overlap[nrequest_overlap++]);
+      } else {
+	n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],
+			       &buf_send_overlap[nsend]);
+	if (n) MPI_Isend(&buf_send_overlap[nsend],n,MPI_DOUBLE,
+			 recvproc[iswap],iswap,world,
+			 &request_overlap[nrequest_overlap++]);
+	nsend += n;
+      }
+
+    } else {
+      if (comm_f_only) {
+	if (sendnum[iswap])
+	    avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+				f[firstrecv[iswap]]);
+      } else {
+	n = avec->pack_reverse(recvnum[iswap],firstrecv[iswap],buf_send);
+	avec->unpack_reverse(sendnum[iswap],sendlist[iswap],buf_send);
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   complete the messages of a reverse stage and sum received forces
+------------------------------------------------------------------------- */
+
+void Comm::reverse_stage_wait(int istage)
+{
+  int k,iswap;
+  MPI_Status status[4];
+  AtomVec *avec = atom->avec;
+
+  if (nrequest_overlap) MPI_Waitall(nrequest_overlap,request_overlap,status);
+  nrequest_overlap = 0;
+
+  for (k = 1; k >= 0; k--) {
+    iswap = 2*istage + k;
+    if (sendproc[iswap] == me) continue;
+    avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+			 &buf_recv_overlap[offset_overlap[k]]);
+  }
+}
+
 /* ----------------------------------------------------------------------
    exchange: move atoms to correct processors
    atoms exchanged with all 6 stencil neighbors
@@ -821,6 +1061,18 @@ void Comm::exchange()
 
   for (int dim = 0; dim < 3; dim++) {
 
+    // insure buf_send has room past maxsend for the largest atom,
+    //   fixes like SHEAR_HISTORY can pack more than BUFEXTRA values for one
+    // checked every dim, atoms received in one dim may be sent on in next
+
+    int extra = BUFEXTRA;
+    for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+      extra += modify->fix[atom->extra_grow[iextra]]->maxexchange;
+    if (extra > bufextra) {
+      bufextra = extra;
+      memory->grow(buf_send,maxsend+bufextra,"comm:buf_send");
+    }
+
     // fill buffer with atoms leaving my box, using < and >=
     // when atom is deleted, fill it in with last atom
 
@@ -1368,7 +1620,7 @@ void Comm::reverse_comm_dump(Dump *dump)
 }
 
 /* ----------------------------------------------------------------------
-   realloc the size of the send buffer as needed with BUFFACTOR & BUFEXTRA 
+   realloc the size of the send buffer as needed with BUFFACTOR & bufextra
    if flag = 1, realloc
    if flag = 0, don't need to realloc with copy, just free/malloc
 ------------------------------------------------------------------------- */
@@ -1377,10 +1629,10 @@ void Comm::grow_send(int n, int flag)
 {
   maxsend = static_cast<int> (BUFFACTOR * n);
   if (flag)
-    memory->grow(buf_send,(maxsend+BUFEXTRA),"comm:buf_send");
+    memory->grow(buf_send,(maxsend+bufextra),"comm:buf_send");
   else {
     memory->destroy(buf_send);
-    memory->create(buf_send,maxsend+BUFEXTRA,"comm:buf_send");
+    memory->create(buf_send,maxsend+bufextra,"comm:buf_send");
   }
 }
 
@@ -1395,6 +1647,24 @@ void Comm::grow_recv(int n)
   memory->create(buf_recv,maxrecv,"comm:buf_recv");
 }
 
+/* ----------------------------------------------------------------------
+   free/malloc the overlap send/recv buffers as needed with BUFFACTOR
+------------------------------------------------------------------------- */
+
+void Comm::grow_overlap(int nsend, int nrecv)
+{
+  if (nsend > maxsend_overlap) {
+    maxsend_overlap = static_cast<int> (BUFFACTOR * nsend);
+    memory->destroy(buf_send_overlap);
+    memory->create(buf_send_overlap,maxsend_overlap,"comm:buf_send_overlap");
+  }
+  if (nrecv > maxrecv_overlap) {
+    maxrecv_overlap = static_cast<int> (BUFFACTOR * nrecv);
+    memory->destroy(buf_recv_overlap);
+    memory->create(buf_recv_overlap,maxrecv_overlap,"comm:buf_recv_overlap");
+  }
+}
+
 /* ----------------------------------------------------------------------
    realloc the size of the iswap sendlist as needed with BUFFACTOR 
 ------------------------------------------------------------------------- */
@@ -1524,6 +1794,12 @@ void Comm::set(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) ghost_velocity = 0;
       else error->all(FLERR,"Illegal communicate command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"overlap") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal communicate command");
+      if (strcmp(arg[iarg+1],"yes") == 0) overlap = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) overlap = 0;
+      else error->all(FLERR,"Illegal communicate command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal communicate command");
   }
 }
@@ -1671,7 +1947,9 @@ bigint Comm::memory_usage()
   bigint bytes = 0;
   for (int i = 0; i < nswap; i++) 
     bytes += memory->usage(sendlist[i],maxsendlist[i]);
-  bytes += memory->usage(buf_send,maxsend+BUFEXTRA);
+  bytes += memory->usage(buf_send,maxsend+bufextra);
   bytes += memory->usage(buf_recv,maxrecv);
+  bytes += memory->usage(buf_send_overlap,maxsend_overlap);
+  bytes += memory->usage(buf_recv_overlap,maxrecv_overlap);
   return bytes;
 }
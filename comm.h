@@ -37,6 +37,7 @@ class Comm : protected Pointers {
   int other_partition_style;        // 0 = recv layout dims must be multiple of
                                     //     my layout dims
   int nthreads;                     // OpenMP threads per MPI process
+  int overlap;                      // 1 if ghost comm overlaps force compute
 
   Comm(class LAMMPS *);
   virtual ~Comm();
@@ -49,6 +50,11 @@ class Comm : protected Pointers {
   virtual void exchange();                    // move atoms to new procs
   virtual void borders();                     // setup list of atoms to comm
 
+  void forward_comm_start();                  // post 1st stage of forward comm
+  void forward_comm_finish();                 // complete started forward comm
+  void reverse_comm_start();                  // post 1st stage of reverse comm
+  void reverse_comm_finish();                 // complete started reverse comm
+
   virtual void forward_comm_pair(class Pair *);    // forward comm from a Pair
   virtual void reverse_comm_pair(class Pair *);    // reverse comm from a Pair
   virtual void forward_comm_fix(class Fix *);      // forward comm from a Fix
@@ -108,12 +114,28 @@ class Comm : protected Pointers {
   double *buf_send;                 // send buffer for all comm
   double *buf_recv;                 // recv buffer for all comm
   int maxsend,maxrecv;              // current size of send/recv buffer
+  int bufextra;                     // extra space beyond maxsend in send buffer
   int maxforward,maxreverse;        // max # of datums in forward/reverse comm
+
+  // overlapped comm proceeds in stages of 2 swaps, one per direction,
+  // both swaps of a stage are in flight at once
+
+  MPI_Request request_overlap[4];   // pending sends/recvs of current stage
+  int nrequest_overlap;
+  int offset_overlap[2];            // where each swap's recv starts in buf
+  double *buf_send_overlap;         // send buffer for both swaps of a stage
+  double *buf_recv_overlap;         // recv buffer for both swaps of a stage
+  int maxsend_overlap,maxrecv_overlap;
  
   int updown(int, int, int, double, int, double *);
                                             // compare cutoff to procs
   virtual void grow_send(int,int);          // reallocate send buffer
   virtual void grow_recv(int);              // free/allocate recv buffer
+  void grow_overlap(int, int);              // free/allocate overlap buffers
+  void forward_stage_post(int);             // pack and post one fwd stage
+  void forward_stage_wait(int);             // wait on and unpack one fwd stage
+  void reverse_stage_post(int);             // pack and post one rev stage
+  void reverse_stage_wait(int);             // wait on and unpack one rev stage
   virtual void grow_list(int, int);         // reallocate one sendlist
   virtual void grow_swap(int);              // grow swap and multi arrays
   virtual void allocate_swap(int);          // allocate swap arrays
@@ -63,8 +63,10 @@ Compute::Compute(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   tempflag = pressflag = peflag = 0;
   pressatomflag = peatomflag = 0;
   tempbias = 0;
+  reduceflag = 0;
 
   timeflag = 0;
+  time_total = 0.0;
   comm_forward = comm_reverse = 0;
   cudable = 0;
 
@@ -60,6 +60,9 @@ class Compute : protected Pointers {
 
   int tempbias;       // 0/1 if Compute temp includes self/extra bias
 
+  int reduceflag;     // bitmask of INVOKED_SCALAR/VECTOR (1/2) whose
+                      // global sum can be deferred via reduce_pack/unpack
+
   int timeflag;       // 1 if Compute stores list of timesteps it's called on
   int ntime;          // # of entries in time list
   int maxtime;        // max # of entries time list can hold
@@ -72,6 +75,8 @@ class Compute : protected Pointers {
   bigint invoked_peratom; // ditto for compute_peratom()
   bigint invoked_local;   // ditto for compute_local()
 
+  double time_total;      // time in thermo/dump invocations, if timer full
+
   double dof;         // degrees-of-freedom for temperature
 
   int comm_forward;   // size of forward communication (0 if none)
@@ -92,6 +97,14 @@ class Compute : protected Pointers {
   virtual void compute_peratom() {}
   virtual void compute_local() {}
 
+  // split of compute_scalar()/compute_vector() around their MPI_SUM
+  // pack stores local partial sums, at most 6 + size_vector values
+  // unpack finishes the calculation from the summed values
+  //   and only then sets invoked_scalar/vector
+
+  virtual int reduce_pack(int, double *) {return 0;}
+  virtual void reduce_unpack(int, double *) {}
+
   virtual int pack_comm(int, int *, double *, int, int *) {return 0;}
   virtual void unpack_comm(int, int, double *) {}
   virtual int pack_reverse_comm(int, int, double *) {return 0;}
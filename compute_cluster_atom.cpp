@@ -29,6 +29,8 @@
 
 using namespace LAMMPS_NS;
 
+#define BIG 1.0e20
+
 /* ---------------------------------------------------------------------- */
 
 ComputeClusterAtom::ComputeClusterAtom(LAMMPS *lmp, int narg, char **arg) :
@@ -36,8 +38,16 @@ ComputeClusterAtom::ComputeClusterAtom(LAMMPS *lmp, int narg, char **arg) :
 {
   if (narg != 4) error->all(FLERR,"Illegal compute cluster/atom command");
 
-  double cutoff = atof(arg[3]);
-  cutsq = cutoff*cutoff;
+  // contact = atoms are bonded if their radii overlap
+
+  if (strcmp(arg[3],"contact") == 0) {
+    contactflag = 1;
+    cutsq = 0.0;
+  } else {
+    contactflag = 0;
+    double cutoff = atof(arg[3]);
+    cutsq = cutoff*cutoff;
+  }
 
   peratom_flag = 1;
   size_peratom_cols = 0;
@@ -45,6 +55,8 @@ ComputeClusterAtom::ComputeClusterAtom(LAMMPS *lmp, int narg, char **arg) :
 
   nmax = 0;
   clusterID = NULL;
+  parent = NULL;
+  minID = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -52,6 +64,8 @@ ComputeClusterAtom::ComputeClusterAtom(LAMMPS *lmp, int narg, char **arg) :
 ComputeClusterAtom::~ComputeClusterAtom()
 {
   memory->destroy(clusterID);
+  memory->destroy(parent);
+  memory->destroy(minID);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -62,6 +76,8 @@ void ComputeClusterAtom::init()
     error->all(FLERR,"Cannot use compute cluster/atom unless atoms have IDs");
   if (force->pair == NULL) 
     error->all(FLERR,"Compute cluster/atom requires a pair style be defined");
+  if (contactflag && !atom->radius_flag)
+    error->all(FLERR,"Compute cluster/atom contact requires atom attribute radius");
   if (sqrt(cutsq) > force->pair->cutforce) 
     error->all(FLERR,"Compute cluster/atom cutoff is longer than pairwise cutoff");
 
@@ -89,12 +105,19 @@ void ComputeClusterAtom::init_list(int id, NeighList *ptr)
   list = ptr;
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   union-find over owned and ghost atoms links atoms within cutoff
+   each local tree is labeled by smallest atom ID among its members
+   labels are then merged across procs via ghost atoms,
+     one forward comm per round, until no label changes on any proc
+   # of rounds scales with # of sub-domains a cluster spans,
+     not with # of atoms along it
+------------------------------------------------------------------------- */
 
 void ComputeClusterAtom::compute_peratom()
 {
-  int i,j,ii,jj,inum,jnum,n;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  int i,j,ii,jj,inum,jnum,root;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq,radsum;
   int *ilist,*jlist,*numneigh,**firstneigh;
 
   invoked_peratom = update->ntimestep;
@@ -103,8 +126,12 @@ void ComputeClusterAtom::compute_peratom()
 
   if (atom->nlocal+atom->nghost > nmax) {
     memory->destroy(clusterID);
+    memory->destroy(parent);
+    memory->destroy(minID);
     nmax = atom->nmax;
     memory->create(clusterID,nmax,"cluster/atom:clusterID");
+    memory->create(parent,nmax,"cluster/atom:parent");
+    memory->create(minID,nmax,"cluster/atom:minID");
     vector_atom = clusterID;
   }
 
@@ -117,72 +144,124 @@ void ComputeClusterAtom::compute_peratom()
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
-  // every atom starts in its own cluster, with clusterID = atomID
+  // every atom starts in its own tree
 
+  double **x = atom->x;
+  double *radius = atom->radius;
   int *tag = atom->tag;
   int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+
+  for (i = 0; i < nall; i++) parent[i] = i;
+
+  // join trees of each of my atoms and its neighbors within cutoff
+  // full neighbor list, so both procs of an owned/ghost pair see it
 
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
-    if (mask[i] & groupbit) clusterID[i] = tag[i];
+    if (!(mask[i] & groupbit)) continue;
+
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+      if (!(mask[j] & groupbit)) continue;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      if (contactflag) {
+	radsum = radius[i] + radius[j];
+	if (rsq >= radsum*radsum) continue;
+      } else if (rsq >= cutsq) continue;
+
+      unite(i,j);
+    }
+  }
+
+  // flatten trees so parent = root
+  // minID of root = smallest atom ID in its tree
+
+  for (i = 0; i < nall; i++) {
+    parent[i] = find(i);
+    minID[i] = BIG;
+  }
+
+  for (i = 0; i < nall; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    root = parent[i];
+    minID[root] = MIN(minID[root],tag[i]);
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) clusterID[i] = minID[parent[i]];
     else clusterID[i] = 0;
   }
 
   // loop until no more changes on any proc:
-  // acquire clusterIDs of ghost atoms
-  // loop over my atoms, checking distance to neighbors
-  // if both atoms are in cluster, assign lowest clusterID to both
-  // iterate until no changes in my atoms
-  // then check if any proc made changes
-
-  double **x = atom->x;
+  // acquire clusterIDs of ghost atoms from their owners
+  // lower minID of each tree to smallest clusterID of its ghosts
+  // reset clusterID of my atoms from their tree
 
-  int change,done,anychange;
+  int change,anychange;
 
   while (1) {
     comm->forward_comm_compute(this);
 
+    for (i = nlocal; i < nall; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      root = parent[i];
+      if (clusterID[i] < minID[root]) minID[root] = clusterID[i];
+    }
+
     change = 0;
-    while (1) {
-      done = 1;
-      for (ii = 0; ii < inum; ii++) {
-	i = ilist[ii];
-	if (!(mask[i] & groupbit)) continue;
-	
-	xtmp = x[i][0];
-	ytmp = x[i][1];
-	ztmp = x[i][2];
-	jlist = firstneigh[i];
-	jnum = numneigh[i];
-	
-	n = 0;
-	for (jj = 0; jj < jnum; jj++) {
-	  j = jlist[jj];
-	  j &= NEIGHMASK;
-	  if (!(mask[j] & groupbit)) continue;
-	  if (clusterID[i] == clusterID[j]) continue;
-	  
-	  delx = xtmp - x[j][0];
-	  dely = ytmp - x[j][1];
-	  delz = ztmp - x[j][2];
-	  rsq = delx*delx + dely*dely + delz*delz;
-	  if (rsq < cutsq) {
-	    clusterID[i] = clusterID[j] = MIN(clusterID[i],clusterID[j]);
-	    done = 0;
-	  }
-	}
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      if (minID[parent[i]] < clusterID[i]) {
+	clusterID[i] = minID[parent[i]];
+	change = 1;
       }
-      if (!done) change = 1;
-      if (done) break;
     }
-    
+
     // stop if all procs are done
-    
+
     MPI_Allreduce(&change,&anychange,1,MPI_INT,MPI_MAX,world);
     if (!anychange) break;
   }
 }
 
+/* ----------------------------------------------------------------------
+   return root of tree containing atom i, with path halving
+------------------------------------------------------------------------- */
+
+int ComputeClusterAtom::find(int i)
+{
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+/* ----------------------------------------------------------------------
+   merge trees containing atoms i and j, smaller root index wins
+------------------------------------------------------------------------- */
+
+void ComputeClusterAtom::unite(int i, int j)
+{
+  int iroot = find(i);
+  int jroot = find(j);
+  if (iroot < jroot) parent[jroot] = iroot;
+  else if (jroot < iroot) parent[iroot] = jroot;
+}
+
 /* ---------------------------------------------------------------------- */
 
 int ComputeClusterAtom::pack_comm(int n, int *list, double *buf, 
@@ -215,6 +294,7 @@ void ComputeClusterAtom::unpack_comm(int n, int first, double *buf)
 
 double ComputeClusterAtom::memory_usage()
 {
-  double bytes = nmax * sizeof(double);
+  double bytes = 2*nmax * sizeof(double);
+  bytes += nmax * sizeof(int);
   return bytes;
 }
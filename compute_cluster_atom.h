@@ -37,9 +37,15 @@ class ComputeClusterAtom : public Compute {
 
  private:
   int nmax;
+  int contactflag;           // 1 if cluster bonds are overlapping radii
   double cutsq;
   class NeighList *list;
   double *clusterID;
+  int *parent;               // union-find tree over owned and ghost atoms
+  double *minID;             // smallest cluster ID of tree, stored at root
+
+  int find(int);
+  void unite(int, int);
 };
 
 }
@@ -64,6 +70,10 @@ E: Compute cluster/atom requires a pair style be defined
 This is so that the pair style defines a cutoff distance which
 is used to find clusters.
 
+E: Compute cluster/atom contact requires atom attribute radius
+
+The contact criterion tests for overlap of finite-size particles.
+
 E: Compute cluster/atom cutoff is longer than pairwise cutoff
 
 Cannot identify clusters beyond cutoff.
@@ -22,6 +22,8 @@
 
 using namespace LAMMPS_NS;
 
+#define INVOKED_SCALAR 1
+
 /* ---------------------------------------------------------------------- */
 
 ComputeKE::ComputeKE(LAMMPS *lmp, int narg, char **arg) :
@@ -31,6 +33,7 @@ ComputeKE::ComputeKE(LAMMPS *lmp, int narg, char **arg) :
 
   scalar_flag = 1;
   extscalar = 1;
+  reduceflag = INVOKED_SCALAR;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -44,8 +47,17 @@ void ComputeKE::init()
 
 double ComputeKE::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
+  double ke;
+  reduce_pack(INVOKED_SCALAR,&ke);
+  MPI_Allreduce(&ke,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  reduce_unpack(INVOKED_SCALAR,&scalar);
+  return scalar;
+}
 
+/* ---------------------------------------------------------------------- */
+
+int ComputeKE::reduce_pack(int, double *ke)
+{
   double **v = atom->v;
   double *rmass = atom->rmass;
   double *mass = atom->mass;
@@ -53,20 +65,27 @@ double ComputeKE::compute_scalar()
   int *type = atom->type;
   int nlocal = atom->nlocal;
 
-  double ke = 0.0;
+  ke[0] = 0.0;
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++) 
       if (mask[i] & groupbit)
-	ke += rmass[i] * (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]);
+	ke[0] += rmass[i] * 
+	  (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]);
   } else {
     for (int i = 0; i < nlocal; i++)
       if (mask[i] & groupbit)
-	ke += mass[type[i]] * 
+	ke[0] += mass[type[i]] * 
 	  (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]);
   }
 
-  MPI_Allreduce(&ke,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-  scalar *= pfactor;
-  return scalar;
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeKE::reduce_unpack(int, double *ke)
+{
+  invoked_scalar = update->ntimestep;
+  scalar = ke[0] * pfactor;
 }
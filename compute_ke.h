@@ -29,6 +29,8 @@ class ComputeKE : public Compute {
   ComputeKE(class LAMMPS *, int, char **);
   void init();
   double compute_scalar();
+  int reduce_pack(int, double *);
+  void reduce_unpack(int, double *);
 
  private:
   double pfactor;
@@ -29,6 +29,8 @@
 
 using namespace LAMMPS_NS;
 
+#define INVOKED_SCALAR 1
+
 /* ---------------------------------------------------------------------- */
 
 ComputePE::ComputePE(LAMMPS *lmp, int narg, char **arg) : 
@@ -41,6 +43,7 @@ ComputePE::ComputePE(LAMMPS *lmp, int narg, char **arg) :
   extscalar = 1;
   peflag = 1;
   timeflag = 1;
+  reduceflag = INVOKED_SCALAR;
 
   if (narg == 3) {
     pairflag = 1;
@@ -70,22 +73,40 @@ ComputePE::ComputePE(LAMMPS *lmp, int narg, char **arg) :
 
 double ComputePE::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
-  if (update->eflag_global != invoked_scalar)
+  double one;
+  reduce_pack(INVOKED_SCALAR,&one);
+  MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  reduce_unpack(INVOKED_SCALAR,&scalar);
+  return scalar;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ComputePE::reduce_pack(int, double *one)
+{
+  if (update->eflag_global != update->ntimestep)
     error->all(FLERR,"Energy was not tallied on needed timestep");
 
-  double one = 0.0;
+  one[0] = 0.0;
   if (pairflag && force->pair)
-    one += force->pair->eng_vdwl + force->pair->eng_coul;
+    one[0] += force->pair->eng_vdwl + force->pair->eng_coul;
 
   if (atom->molecular) {
-    if (bondflag && force->bond) one += force->bond->energy;
-    if (angleflag && force->angle) one += force->angle->energy;
-    if (dihedralflag && force->dihedral) one += force->dihedral->energy;
-    if (improperflag && force->improper) one += force->improper->energy;
+    if (bondflag && force->bond) one[0] += force->bond->energy;
+    if (angleflag && force->angle) one[0] += force->angle->energy;
+    if (dihedralflag && force->dihedral) one[0] += force->dihedral->energy;
+    if (improperflag && force->improper) one[0] += force->improper->energy;
   }
 
-  MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputePE::reduce_unpack(int, double *all)
+{
+  invoked_scalar = update->ntimestep;
+  scalar = all[0];
 
   if (kspaceflag && force->kspace) scalar += force->kspace->energy;
 
@@ -95,6 +116,4 @@ double ComputePE::compute_scalar()
   }
 
   if (thermoflag && modify->n_thermo_energy) scalar += modify->thermo_energy();
-
-  return scalar;
 }
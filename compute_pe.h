@@ -30,6 +30,8 @@ class ComputePE : public Compute {
   ~ComputePE() {}
   void init() {}
   double compute_scalar();
+  int reduce_pack(int, double *);
+  void reduce_unpack(int, double *);
 
  private:
   int pairflag,bondflag,angleflag,dihedralflag,improperflag,kspaceflag;
@@ -31,6 +31,9 @@
 
 using namespace LAMMPS_NS;
 
+#define INVOKED_SCALAR 1
+#define INVOKED_VECTOR 2
+
 /* ---------------------------------------------------------------------- */
 
 ComputePressure::ComputePressure(LAMMPS *lmp, int narg, char **arg) :
@@ -44,6 +47,7 @@ ComputePressure::ComputePressure(LAMMPS *lmp, int narg, char **arg) :
   extscalar = 0;
   extvector = 0;
   pressflag = 1;
+  reduceflag = INVOKED_SCALAR | INVOKED_VECTOR;
   timeflag = 1;
 
   // store temperature ID used by pressure computation
@@ -165,37 +169,10 @@ void ComputePressure::init()
 
 double ComputePressure::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
-  if (update->vflag_global != invoked_scalar)
-    error->all(FLERR,"Virial was not tallied on needed timestep");
-
-  // invoke temperature it it hasn't been already
-
-  double t;
-  if (keflag) {
-    if (temperature->invoked_scalar != update->ntimestep)
-      t = temperature->compute_scalar();
-    else t = temperature->scalar;
-  }
-
-  if (dimension == 3) {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(3,3);
-    if (keflag)
-      scalar = (temperature->dof * boltz * t + 
-		virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
-    else
-      scalar = (virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
-  } else {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(2,2);
-    if (keflag)
-      scalar = (temperature->dof * boltz * t + 
-		virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
-    else
-      scalar = (virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
-  }
-
+  double v[3];
+  int n = reduce_pack(INVOKED_SCALAR,v);
+  MPI_Allreduce(v,virial,n,MPI_DOUBLE,MPI_SUM,world);
+  reduce_unpack(INVOKED_SCALAR,virial);
   return scalar;
 }
 
@@ -206,10 +183,71 @@ double ComputePressure::compute_scalar()
 
 void ComputePressure::compute_vector()
 {
-  invoked_vector = update->ntimestep;
-  if (update->vflag_global != invoked_vector)
+  double v[6];
+  int n = reduce_pack(INVOKED_VECTOR,v);
+  MPI_Allreduce(v,virial,n,MPI_DOUBLE,MPI_SUM,world);
+  reduce_unpack(INVOKED_VECTOR,virial);
+}
+
+/* ----------------------------------------------------------------------
+   sum virial of my atoms, 3 or 2 diagonal components for scalar,
+     6 or 4 components for vector
+------------------------------------------------------------------------- */
+
+int ComputePressure::reduce_pack(int flag, double *v)
+{
+  int n;
+
+  if (update->vflag_global != update->ntimestep)
     error->all(FLERR,"Virial was not tallied on needed timestep");
 
+  if (flag == INVOKED_SCALAR) n = (dimension == 3) ? 3 : 2;
+  else n = (dimension == 3) ? 6 : 4;
+
+  virial_pack(n,v);
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   finish pressure scalar or tensor from virial summed across procs
+------------------------------------------------------------------------- */
+
+void ComputePressure::reduce_unpack(int flag, double *v)
+{
+  if (flag == INVOKED_SCALAR) {
+    invoked_scalar = update->ntimestep;
+
+    // invoke temperature it it hasn't been already
+
+    double t;
+    if (keflag) {
+      if (temperature->invoked_scalar != update->ntimestep)
+	t = temperature->compute_scalar();
+      else t = temperature->scalar;
+    }
+
+    if (dimension == 3) {
+      inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
+      virial_unpack(3,3,v);
+      if (keflag)
+	scalar = (temperature->dof * boltz * t + 
+		  virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
+      else
+	scalar = (virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
+    } else {
+      inv_volume = 1.0 / (domain->xprd * domain->yprd);
+      virial_unpack(2,2,v);
+      if (keflag)
+	scalar = (temperature->dof * boltz * t + 
+		  virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
+      else
+	scalar = (virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
+    }
+    return;
+  }
+
+  invoked_vector = update->ntimestep;
+
   // invoke temperature if it hasn't been already
 
   double *ke_tensor;
@@ -221,7 +259,7 @@ void ComputePressure::compute_vector()
 
   if (dimension == 3) {
     inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(6,3);
+    virial_unpack(6,3,v);
     if (keflag) {
       for (int i = 0; i < 6; i++)
 	vector[i] = (ke_tensor[i] + virial[i]) * inv_volume * nktv2p;
@@ -230,7 +268,7 @@ void ComputePressure::compute_vector()
 	vector[i] = virial[i] * inv_volume * nktv2p;
   } else {
     inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(4,2);
+    virial_unpack(4,2,v);
     if (keflag) {
       vector[0] = (ke_tensor[0] + virial[0]) * inv_volume * nktv2p;
       vector[1] = (ke_tensor[1] + virial[1]) * inv_volume * nktv2p;
@@ -245,25 +283,32 @@ void ComputePressure::compute_vector()
   }
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   sum contributions to virial from forces and fixes on this proc
+------------------------------------------------------------------------- */
 
-void ComputePressure::virial_compute(int n, int ndiag)
+void ComputePressure::virial_pack(int n, double *v)
 {
   int i,j;
-  double v[6],*vcomponent;
+  double *vcomponent;
 
   for (i = 0; i < n; i++) v[i] = 0.0;
 
-  // sum contributions to virial from forces and fixes
-
   for (j = 0; j < nvirial; j++) {
     vcomponent = vptr[j];
     for (i = 0; i < n; i++) v[i] += vcomponent[i];
   }
+}
+
+/* ----------------------------------------------------------------------
+   set virial from sum across procs, add global contributions
+------------------------------------------------------------------------- */
 
-  // sum virial across procs
+void ComputePressure::virial_unpack(int n, int ndiag, double *v)
+{
+  int i;
 
-  MPI_Allreduce(v,virial,n,MPI_DOUBLE,MPI_SUM,world);
+  for (i = 0; i < n; i++) virial[i] = v[i];
 
   // KSpace virial contribution is already summed across procs
 
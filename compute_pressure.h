@@ -31,6 +31,8 @@ class ComputePressure : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  int reduce_pack(int, double *);
+  void reduce_unpack(int, double *);
   void reset_extra_compute_fix(const char *);
 
  protected:
@@ -44,7 +46,8 @@ class ComputePressure : public Compute {
   int keflag,pairflag,bondflag,angleflag,dihedralflag,improperflag;
   int fixflag,kspaceflag;
 
-  void virial_compute(int, int);
+  void virial_pack(int, double *);
+  void virial_unpack(int, int, double *);
 };
 
 }
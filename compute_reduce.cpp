@@ -33,6 +33,7 @@ enum{SUM,MINN,MAXX,AVE};
 enum{X,V,F,COMPUTE,FIX,VARIABLE};
 enum{PERATOM,LOCAL};
 
+#define INVOKED_SCALAR 1
 #define INVOKED_VECTOR 2
 #define INVOKED_ARRAY 4
 #define INVOKED_PERATOM 8
@@ -269,6 +270,10 @@ ComputeReduce::ComputeReduce(LAMMPS *lmp, int narg, char **arg) :
     owner = new int[size_vector];
   }
 
+  // sums can be folded into a caller's batched reduction
+
+  if (mode == SUM) reduceflag = INVOKED_SCALAR | INVOKED_VECTOR;
+
   maxatom = 0;
   varatom = NULL;
 }
@@ -367,8 +372,7 @@ void ComputeReduce::compute_vector()
     }
 
   if (mode == SUM) {
-    for (int m = 0; m < nvalues; m++)
-      MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_SUM,world);
+    MPI_Allreduce(onevec,vector,nvalues,MPI_DOUBLE,MPI_SUM,world);
 
   } else if (mode == MINN) {
     if (!replace) {
@@ -415,14 +419,42 @@ void ComputeReduce::compute_vector()
     }
 
   } else if (mode == AVE) {
+    MPI_Allreduce(onevec,vector,nvalues,MPI_DOUBLE,MPI_SUM,world);
     for (int m = 0; m < nvalues; m++) {
-      MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_SUM,world);
       bigint n = count(m);
       if (n) vector[m] /= n;
     }
   }
 }
 
+/* ----------------------------------------------------------------------
+   local sums for mode = SUM, reduced across procs by caller
+------------------------------------------------------------------------- */
+
+int ComputeReduce::reduce_pack(int flag, double *one)
+{
+  if (flag == INVOKED_SCALAR) {
+    one[0] = compute_one(0,-1);
+    return 1;
+  }
+
+  for (int m = 0; m < nvalues; m++) one[m] = compute_one(m,-1);
+  return nvalues;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeReduce::reduce_unpack(int flag, double *all)
+{
+  if (flag == INVOKED_SCALAR) {
+    invoked_scalar = update->ntimestep;
+    scalar = all[0];
+  } else {
+    invoked_vector = update->ntimestep;
+    for (int m = 0; m < nvalues; m++) vector[m] = all[m];
+  }
+}
+
 /* ----------------------------------------------------------------------
    calculate reduced value for one input M and return it
    if flag = -1:
@@ -25,6 +25,9 @@
 
 using namespace LAMMPS_NS;
 
+#define INVOKED_SCALAR 1
+#define INVOKED_VECTOR 2
+
 /* ---------------------------------------------------------------------- */
 
 ComputeTemp::ComputeTemp(LAMMPS *lmp, int narg, char **arg) : 
@@ -37,6 +40,7 @@ ComputeTemp::ComputeTemp(LAMMPS *lmp, int narg, char **arg) :
   extscalar = 0;
   extvector = 1;
   tempflag = 1;
+  reduceflag = INVOKED_SCALAR | INVOKED_VECTOR;
 
   vector = new double[6];
 }
@@ -73,31 +77,10 @@ void ComputeTemp::dof_compute()
 
 double ComputeTemp::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
-
-  double **v = atom->v;
-  double *mass = atom->mass;
-  double *rmass = atom->rmass;
-  int *type = atom->type;
-  int *mask = atom->mask;
-  int nlocal = atom->nlocal;
-
-  double t = 0.0;
-
-  if (rmass) {
-    for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit)
-	t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * rmass[i];
-  } else {
-    for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit)
-	t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * 
-	  mass[type[i]];
-  }
-
+  double t;
+  reduce_pack(INVOKED_SCALAR,&t);
   MPI_Allreduce(&t,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-  if (dynamic) dof_compute();
-  scalar *= tfactor;
+  reduce_unpack(INVOKED_SCALAR,&scalar);
   return scalar;
 }
 
@@ -105,9 +88,19 @@ double ComputeTemp::compute_scalar()
 
 void ComputeTemp::compute_vector()
 {
-  int i;
+  double t[6];
+  reduce_pack(INVOKED_VECTOR,t);
+  MPI_Allreduce(t,vector,6,MPI_DOUBLE,MPI_SUM,world);
+  reduce_unpack(INVOKED_VECTOR,vector);
+}
 
-  invoked_vector = update->ntimestep;
+/* ----------------------------------------------------------------------
+   sum of m v^2 (scalar) or m v v tensor (vector) over my atoms
+------------------------------------------------------------------------- */
+
+int ComputeTemp::reduce_pack(int flag, double *t)
+{
+  int i;
 
   double **v = atom->v;
   double *mass = atom->mass;
@@ -116,7 +109,24 @@ void ComputeTemp::compute_vector()
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  double massone,t[6];
+  if (flag == INVOKED_SCALAR) {
+    t[0] = 0.0;
+
+    if (rmass) {
+      for (i = 0; i < nlocal; i++)
+	if (mask[i] & groupbit)
+	  t[0] += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * 
+	    rmass[i];
+    } else {
+      for (i = 0; i < nlocal; i++)
+	if (mask[i] & groupbit)
+	  t[0] += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * 
+	    mass[type[i]];
+    }
+    return 1;
+  }
+
+  double massone;
   for (i = 0; i < 6; i++) t[i] = 0.0;
 
   for (i = 0; i < nlocal; i++)
@@ -130,7 +140,21 @@ void ComputeTemp::compute_vector()
       t[4] += massone * v[i][0]*v[i][2];
       t[5] += massone * v[i][1]*v[i][2];
     }
+  return 6;
+}
 
-  MPI_Allreduce(t,vector,6,MPI_DOUBLE,MPI_SUM,world);
-  for (i = 0; i < 6; i++) vector[i] *= force->mvv2e;
+/* ---------------------------------------------------------------------- */
+
+void ComputeTemp::reduce_unpack(int flag, double *t)
+{
+  if (flag == INVOKED_SCALAR) {
+    invoked_scalar = update->ntimestep;
+    scalar = t[0];
+    if (dynamic) dof_compute();
+    scalar *= tfactor;
+    return;
+  }
+
+  invoked_vector = update->ntimestep;
+  for (int i = 0; i < 6; i++) vector[i] = t[i] * force->mvv2e;
 }
@@ -31,6 +31,8 @@ class ComputeTemp : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  int reduce_pack(int, double *);
+  void reduce_unpack(int, double *);
 
  protected:
   int fix_dof;
@@ -26,6 +26,10 @@
 #include "memory.h"
 #include "error.h"
 
+#ifdef LAMMPS_ASYNC_DUMP
+#include "sys/time.h"
+#endif
+
 using namespace LAMMPS_NS;
 
 // allocate space for static class variable
@@ -76,6 +80,18 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   ids = idsort = index = proclist = NULL;
   irregular = NULL;
 
+  async_flag = 0;
+  maxbuf_async = 0;
+  buf_async = NULL;
+  request_active = 0;
+  time_async = 0.0;
+#ifdef LAMMPS_ASYNC_DUMP
+  maxsnap = 0;
+  snap = NULL;
+  snapcount = new int[nprocs];
+  writer_active = 0;
+#endif
+
   // parse filename for special syntax
   // if contains '%', write one file per proc and replace % with proc-ID
   // if contains '*', write one file per timestep and replace * with timestep
@@ -116,6 +132,8 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
 
 Dump::~Dump()
 {
+  wait_async();
+
   delete [] id;
   delete [] style;
   delete [] filename;
@@ -132,6 +150,12 @@ Dump::~Dump()
   memory->destroy(proclist);
   delete irregular;
 
+  memory->destroy(buf_async);
+#ifdef LAMMPS_ASYNC_DUMP
+  memory->sfree(snap);
+  delete [] snapcount;
+#endif
+
   // XTC style sets fp to NULL since it closes file in its destructor
 
   if (multifile == 0 && fp != NULL) {
@@ -149,6 +173,7 @@ Dump::~Dump()
 
 void Dump::init()
 {
+  wait_async();
   init_style();
 
   if (!sort_flag) {
@@ -225,6 +250,10 @@ void Dump::init()
 
 void Dump::write()
 {
+  // previous async snapshot must be out of the way before file or buf change
+
+  if (async_flag) wait_async();
+
   // if file per timestep, open new file
 
   if (multifile) openfile();
@@ -299,6 +328,7 @@ void Dump::write()
   //   all other procs wait for ping, send their data to proc 0
 
   if (multiproc) write_data(nme,buf);
+  else if (async_flag) write_async();
   else {
     int tmp,nlines;
     MPI_Status status;
@@ -325,8 +355,13 @@ void Dump::write()
   }
 
   // if file per timestep, close file
+  // writer thread closes it after writing
 
+#ifdef LAMMPS_ASYNC_DUMP
+  if (multifile && !writer_active) {
+#else
   if (multifile) {
+#endif
     if (compressed) {
       if (multiproc) pclose(fp);
       else if (me == 0) pclose(fp);
@@ -337,6 +372,139 @@ void Dump::write()
   }
 }
 
+/* ----------------------------------------------------------------------
+   all procs write to one file thru proc 0 without waiting for a ping
+   other procs send a copy of their data and return immediately
+   proc 0 receives data in proc order, either writing it right away
+     or handing the gathered snapshot to a writer thread
+------------------------------------------------------------------------- */
+
+void Dump::write_async()
+{
+  if (me) {
+    int n = nme*size_one;
+    if (n > maxbuf_async) {
+      maxbuf_async = n;
+      memory->destroy(buf_async);
+      memory->create(buf_async,maxbuf_async,"dump:buf_async");
+    }
+    memcpy(buf_async,buf,n*sizeof(double));
+    nsend_async = n;
+    MPI_Isend(&nsend_async,1,MPI_INT,0,0,world,&request_async[0]);
+    MPI_Isend(buf_async,n,MPI_DOUBLE,0,0,world,&request_async[1]);
+    request_active = 1;
+    return;
+  }
+
+  MPI_Status status;
+  int n;
+
+#ifdef LAMMPS_ASYNC_DUMP
+
+  // gather entire snapshot, writer thread only touches snap and fp
+
+  bigint nsnap = ntotal*size_one;
+  if (nsnap > maxsnap) {
+    if (nsnap*sizeof(double) > MAXBIGINT)
+      error->one(FLERR,"Too much per-snapshot info for async dump");
+    maxsnap = nsnap;
+    memory->sfree(snap);
+    snap = (double *) memory->smalloc(maxsnap*sizeof(double),"dump:snap");
+  }
+
+  memcpy(snap,buf,nme*size_one*sizeof(double));
+  snapcount[0] = nme;
+  bigint offset = nme*size_one;
+
+  // each proc sends its count ahead of its data
+
+  for (int iproc = 1; iproc < nprocs; iproc++) {
+    MPI_Recv(&n,1,MPI_INT,iproc,0,world,&status);
+    MPI_Recv(&snap[offset],n,MPI_DOUBLE,iproc,0,world,&status);
+    snapcount[iproc] = n/size_one;
+    offset += n;
+  }
+
+  if (pthread_create(&writer,NULL,writer_thread,this))
+    error->one(FLERR,"Cannot create async dump writer thread");
+  writer_active = 1;
+
+#else
+
+  write_data(nme,buf);
+  for (int iproc = 1; iproc < nprocs; iproc++) {
+    MPI_Recv(&n,1,MPI_INT,iproc,0,world,&status);
+    MPI_Recv(buf,n,MPI_DOUBLE,iproc,0,world,&status);
+    write_data(n/size_one,buf);
+  }
+  if (flush_flag) fflush(fp);
+
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   wait until previous async snapshot is sent and written
+   bounds the queue of pending snapshots to one
+------------------------------------------------------------------------- */
+
+void Dump::wait_async()
+{
+  if (request_active) {
+    MPI_Status status[2];
+    MPI_Waitall(2,request_async,status);
+    request_active = 0;
+  }
+
+#ifdef LAMMPS_ASYNC_DUMP
+  if (writer_active) {
+    pthread_join(writer,NULL);
+    writer_active = 0;
+  }
+#endif
+}
+
+#ifdef LAMMPS_ASYNC_DUMP
+
+/* ----------------------------------------------------------------------
+   entry point of writer thread on proc 0
+   makes no MPI calls, so MPI only ever sees the main thread
+------------------------------------------------------------------------- */
+
+void *Dump::writer_thread(void *ptr)
+{
+  ((Dump *) ptr)->write_snapshot();
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   write gathered snapshot, close file if one file per timestep
+   tally time spent so it can be reported as overlapped output
+------------------------------------------------------------------------- */
+
+void Dump::write_snapshot()
+{
+  struct timeval tstart,tstop;
+  gettimeofday(&tstart,NULL);
+
+  bigint offset = 0;
+  for (int iproc = 0; iproc < nprocs; iproc++) {
+    write_data(snapcount[iproc],&snap[offset]);
+    offset += (bigint) snapcount[iproc]*size_one;
+  }
+  if (flush_flag) fflush(fp);
+
+  if (multifile) {
+    if (compressed) pclose(fp);
+    else fclose(fp);
+  }
+
+  gettimeofday(&tstop,NULL);
+  time_async += (tstop.tv_sec - tstart.tv_sec) +
+    1.0e-6*(tstop.tv_usec - tstart.tv_usec);
+}
+
+#endif
+
 /* ----------------------------------------------------------------------
    generic opening of a dump file
    ASCII or binary or gzipped
@@ -621,6 +789,8 @@ void Dump::modify_params(int narg, char **arg)
 {
   if (narg == 0) error->all(FLERR,"Illegal dump_modify command");
 
+  wait_async();
+
   int iarg = 0;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"append") == 0) {
@@ -629,6 +799,12 @@ void Dump::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) append_flag = 0;
       else error->all(FLERR,"Illegal dump_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) async_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) async_flag = 0;
+      else error->all(FLERR,"Illegal dump_modify command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"every") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
       int idump;
@@ -716,5 +892,9 @@ bigint Dump::memory_usage()
     bytes += memory->usage(proclist,maxproc);
     if (irregular) bytes += irregular->memory_usage();
   }
+  bytes += memory->usage(buf_async,maxbuf_async);
+#ifdef LAMMPS_ASYNC_DUMP
+  bytes += maxsnap * sizeof(double);
+#endif
   return bytes;
 }
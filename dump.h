@@ -17,6 +17,10 @@
 #include "stdio.h"
 #include "pointers.h"
 
+#ifdef LAMMPS_ASYNC_DUMP
+#include "pthread.h"
+#endif
+
 namespace LAMMPS_NS {
 
 class Dump : protected Pointers {
@@ -35,6 +39,10 @@ class Dump : protected Pointers {
 
   static Dump *dumpptr;         // holds a ptr to Dump currently being used
 
+  double time_async;            // time proc 0 spent writing in background
+                                // only set by this dump's writer thread,
+                                //   read it after wait_async()
+
   Dump(class LAMMPS *, int, char **);
   virtual ~Dump();
   void init();
@@ -47,6 +55,7 @@ class Dump : protected Pointers {
 
   void modify_params(int, char **);
   virtual bigint memory_usage();
+  void wait_async();
 
  protected:
   int me,nprocs;             // proc info
@@ -66,6 +75,7 @@ class Dump : protected Pointers {
   int sortcol;               // 0 to sort on ID, 1-N on columns
   int sortcolm1;             // sortcol - 1
   int sortorder;             // ASCEND or DESCEND
+  int async_flag;            // 1 if procs send w/out waiting for proc 0
 
   char boundstr[9];          // encoding of boundary flags
   char *format_default;      // default format string
@@ -98,6 +108,29 @@ class Dump : protected Pointers {
 
   class Irregular *irregular;
 
+  // async output
+  // other procs send their count and a copy of buf and continue,
+  //   sends complete by next dump
+  // with LAMMPS_ASYNC_DUMP, proc 0 gathers the snapshot and
+  //   a writer thread formats it while the run continues
+
+  int maxbuf_async;          // size of buf_async
+  double *buf_async;         // copy of buf being sent to proc 0
+  int nsend_async;           // # of values in buf_async, sent ahead of it
+  MPI_Request request_async[2];
+  int request_active;        // 1 if send of buf_async is pending
+
+#ifdef LAMMPS_ASYNC_DUMP
+  bigint maxsnap;            // size of snap
+  double *snap;              // all procs' data for writer thread
+  int *snapcount;            // # of lines from each proc in snap
+  pthread_t writer;
+  int writer_active;         // 1 if writer thread has not been joined
+
+  static void *writer_thread(void *);
+  void write_snapshot();
+#endif
+
   virtual void init_style() = 0;
   virtual void openfile();
   virtual int modify_param(int, char **) {return 0;}
@@ -107,6 +140,7 @@ class Dump : protected Pointers {
   virtual void write_data(int, double *) = 0;
 
   void sort();
+  void write_async();
   static int idcompare(const void *, const void *);
   static int bufcompare(const void *, const void *);
   static int bufcompare_reverse(const void *, const void *);
@@ -135,6 +169,16 @@ E: Too much per-proc info for dump
 Number of local atoms times number of columns must fit in a 32-bit
 integer for dump.
 
+E: Too much per-snapshot info for async dump
+
+Number of atoms in the snapshot times number of columns is too large
+for proc 0 to hold the whole snapshot in memory.
+
+E: Cannot create async dump writer thread
+
+The operating system refused to create a thread for writing the
+dump file in the background.
+
 E: Cannot open gzipped file
 
 LAMMPS is attempting to open a gzipped version of the specified file
@@ -26,6 +26,7 @@
 #include "modify.h"
 #include "compute.h"
 #include "fix.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -395,10 +396,13 @@ int DumpCustom::count()
   // invoke Computes for per-atom quantities
 
   if (ncompute) {
+    double tstart = 0.0;
     for (i = 0; i < ncompute; i++)
       if (!(compute[i]->invoked_flag & INVOKED_PERATOM)) {
+	if (timer->fullflag) tstart = MPI_Wtime();
 	compute[i]->compute_peratom();
 	compute[i]->invoked_flag |= INVOKED_PERATOM;
+	if (timer->fullflag) compute[i]->time_total += MPI_Wtime() - tstart;
       }
   }
 
@@ -0,0 +1,410 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   frame layout, all values in native byte order:
+     int magic, int nstream, int keyframe, int unused
+     bigint timestep, bigint natoms
+     double xlo,ylo,zlo,xtol,vtol
+     for each stream: bigint nraw, bigint nstored, nstored bytes
+       stream is zlib compressed if nstored < nraw, else stored as is
+   streams in order: id, type, x, y, z, and vx, vy, vz if vtol > 0
+   atoms are sorted by ID, id and type streams are empty except in
+     keyframes, which are written every keyevery frames and whenever
+     the set of atoms in the snapshot changes
+   each stream is a sequence of zigzag LEB128 varints:
+     id = difference to previous ID in the frame
+     type = type
+     x = round((x - xlo)/xtol), v = round(v/vtol),
+       difference to value of same atom in previous frame
+       unless keyframe
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "dump_quant.h"
+#include "atom.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+#ifdef LAMMPS_ZLIB
+#include "zlib.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+#define QUANT_MAGIC 20120
+#define MAXVARINT 10
+#define QMAX 4.0e18
+
+/* ---------------------------------------------------------------------- */
+
+DumpQuant::DumpQuant(LAMMPS *lmp, int narg, char **arg) : Dump(lmp, narg, arg)
+{
+  if (narg != 6 && narg != 7) error->all(FLERR,"Illegal dump quant command");
+  if (compressed || multifile || multiproc)
+    error->all(FLERR,"Invalid dump quant filename");
+
+  xtol = atof(arg[5]);
+  vtol = 0.0;
+  if (narg == 7) vtol = atof(arg[6]);
+  if (xtol <= 0.0 || (narg == 7 && vtol <= 0.0))
+    error->all(FLERR,"Dump quant tolerance must be > 0.0");
+
+  if (vtol > 0.0) size_one = 8;
+  else size_one = 5;
+  nstream = size_one;
+
+  sort_flag = 1;
+  sortcol = 0;
+  format_default = NULL;
+  keyevery = 100;
+  nframes = 0;
+
+  natoms = nfill = maxatoms = nprev = 0;
+  idsnap = idprev = typesnap = NULL;
+  valsnap = NULL;
+  qprev = NULL;
+  raw = packed = NULL;
+  nraw = new bigint[nstream];
+  npacked = new bigint[nstream];
+  maxraw = maxpacked = 0;
+
+  openfile();
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpQuant::~DumpQuant()
+{
+  memory->destroy(idsnap);
+  memory->destroy(idprev);
+  memory->destroy(typesnap);
+  memory->destroy(valsnap);
+  memory->destroy(qprev);
+  memory->destroy(raw);
+  memory->destroy(packed);
+  delete [] nraw;
+  delete [] npacked;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpQuant::init_style()
+{
+  if (sort_flag == 0 || sortcol != 0)
+    error->all(FLERR,"Dump quant requires sorting by atom ID");
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpQuant::openfile()
+{
+  if (singlefile_opened) return;
+  singlefile_opened = 1;
+
+  if (me == 0) {
+    if (append_flag) fp = fopen(filename,"ab");
+    else fp = fopen(filename,"wb");
+    if (fp == NULL) error->one(FLERR,"Cannot open dump file");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpQuant::write_header(bigint n)
+{
+  if (n > MAXSMALLINT/MAXVARINT) error->all(FLERR,"Too many atoms for dump quant");
+  if (me) return;
+
+  natoms = n;
+  nfill = 0;
+  if (natoms > maxatoms) grow_streams();
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpQuant::count()
+{
+  if (igroup == 0) return atom->nlocal;
+
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  int m = 0;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) m++;
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpQuant::pack(int *ids)
+{
+  int *tag = atom->tag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  double **x = atom->x;
+  double **v = atom->v;
+  int nlocal = atom->nlocal;
+
+  int m = 0;
+  int n = 0;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      buf[m++] = tag[i];
+      buf[m++] = type[i];
+      buf[m++] = x[i][0];
+      buf[m++] = x[i][1];
+      buf[m++] = x[i][2];
+      if (size_one == 8) {
+        buf[m++] = v[i][0];
+        buf[m++] = v[i][1];
+        buf[m++] = v[i][2];
+      }
+      if (ids) ids[n++] = tag[i];
+    }
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 collects chunks in ID order, writes frame when complete
+------------------------------------------------------------------------- */
+
+void DumpQuant::write_data(int n, double *mybuf)
+{
+  int ncomp = size_one - 2;
+
+  int m = 0;
+  for (int i = 0; i < n; i++) {
+    idsnap[nfill] = static_cast<int> (mybuf[m++]);
+    typesnap[nfill] = static_cast<int> (mybuf[m++]);
+    for (int k = 0; k < ncomp; k++)
+      valsnap[nfill*ncomp+k] = mybuf[m++];
+    nfill++;
+  }
+
+  if (nfill == natoms) write_frame();
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpQuant::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"keyframe") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    keyevery = atoi(arg[1]);
+    if (keyevery <= 0) error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory in buf and snapshot arrays
+------------------------------------------------------------------------- */
+
+bigint DumpQuant::memory_usage()
+{
+  bigint bytes = Dump::memory_usage();
+  bytes += 3 * memory->usage(idsnap,maxatoms);
+  bytes += memory->usage(valsnap,maxatoms*(size_one-2));
+  bytes += memory->usage(qprev,maxatoms*(size_one-2));
+  bytes += (bigint) nstream * (maxraw + maxpacked);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   encode and compress all streams, one thread per stream
+------------------------------------------------------------------------- */
+
+void DumpQuant::write_frame()
+{
+  // keyframe if set of atoms differs from previous frame
+
+  int keyframe = 0;
+  if (nframes % keyevery == 0 || natoms != nprev ||
+      memcmp(idsnap,idprev,natoms*sizeof(int)) != 0) keyframe = 1;
+
+  if (keyframe) {
+    memcpy(idprev,idsnap,natoms*sizeof(int));
+    nprev = natoms;
+  }
+
+  // check all values fit in a bigint once quantized
+
+  double boxlo[3];
+  boxlo[0] = boxxlo;
+  boxlo[1] = boxylo;
+  boxlo[2] = boxzlo;
+
+  int ncomp = size_one - 2;
+  double qmax = 0.0;
+  for (int i = 0; i < natoms; i++)
+    for (int k = 0; k < ncomp; k++) {
+      double q;
+      if (k < 3) q = fabs((valsnap[i*ncomp+k] - boxlo[k]) / xtol);
+      else q = fabs(valsnap[i*ncomp+k] / vtol);
+      if (q > qmax) qmax = q;
+    }
+  if (qmax > QMAX) error->one(FLERR,"Dump quant value too large for tolerance");
+
+  // streams are independent, so encode and compress them concurrently
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) schedule(dynamic)
+#endif
+  for (int istream = 0; istream < nstream; istream++) {
+    if (istream == 0)
+      nraw[istream] = keyframe ? encode_ints(idsnap,1,raw[istream]) : 0;
+    else if (istream == 1)
+      nraw[istream] = keyframe ? encode_ints(typesnap,0,raw[istream]) : 0;
+    else nraw[istream] = encode_values(istream-2,keyframe,raw[istream]);
+    compress_stream(istream);
+  }
+
+  int header[4];
+  header[0] = QUANT_MAGIC;
+  header[1] = nstream;
+  header[2] = keyframe;
+  header[3] = 0;
+  bigint bheader[2];
+  bheader[0] = update->ntimestep;
+  bheader[1] = natoms;
+  double dheader[5];
+  dheader[0] = boxlo[0];
+  dheader[1] = boxlo[1];
+  dheader[2] = boxlo[2];
+  dheader[3] = xtol;
+  dheader[4] = vtol;
+
+  fwrite(header,sizeof(int),4,fp);
+  fwrite(bheader,sizeof(bigint),2,fp);
+  fwrite(dheader,sizeof(double),5,fp);
+
+  for (int istream = 0; istream < nstream; istream++) {
+    fwrite(&nraw[istream],sizeof(bigint),1,fp);
+    if (npacked[istream] < nraw[istream]) {
+      fwrite(&npacked[istream],sizeof(bigint),1,fp);
+      fwrite(packed[istream],1,npacked[istream],fp);
+    } else {
+      fwrite(&nraw[istream],sizeof(bigint),1,fp);
+      fwrite(raw[istream],1,nraw[istream],fp);
+    }
+  }
+
+  nframes++;
+}
+
+/* ----------------------------------------------------------------------
+   grow per-atom arrays to hold natoms, preserve previous frame
+------------------------------------------------------------------------- */
+
+void DumpQuant::grow_streams()
+{
+  maxatoms = natoms;
+  int ncomp = size_one - 2;
+
+  memory->destroy(idsnap);
+  memory->destroy(typesnap);
+  memory->destroy(valsnap);
+  memory->create(idsnap,maxatoms,"dump:idsnap");
+  memory->create(typesnap,maxatoms,"dump:typesnap");
+  memory->create(valsnap,maxatoms*ncomp,"dump:valsnap");
+  memory->grow(idprev,maxatoms,"dump:idprev");
+  memory->grow(qprev,maxatoms*ncomp,"dump:qprev");
+
+  maxraw = (bigint) MAXVARINT*maxatoms;
+#ifdef LAMMPS_ZLIB
+  maxpacked = compressBound(maxraw);
+#endif
+  memory->destroy(raw);
+  memory->destroy(packed);
+  memory->create(raw,nstream,maxraw,"dump:raw");
+  if (maxpacked) memory->create(packed,nstream,maxpacked,"dump:packed");
+}
+
+/* ----------------------------------------------------------------------
+   zigzag varint encode ints, as differences to previous if diffflag set
+   return # of bytes
+------------------------------------------------------------------------- */
+
+bigint DumpQuant::encode_ints(int *vec, int diffflag, unsigned char *out)
+{
+  bigint n = 0;
+  int last = 0;
+  for (int i = 0; i < natoms; i++) {
+    int64_t d = vec[i];
+    if (diffflag) {
+      d -= last;
+      last = vec[i];
+    }
+    uint64_t z = ((uint64_t) d << 1) ^ (uint64_t) (d >> 63);
+    while (z >= 0x80) {
+      out[n++] = (unsigned char) (z | 0x80);
+      z >>= 7;
+    }
+    out[n++] = (unsigned char) z;
+  }
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   quantize component k of all atoms, delta encode against previous frame
+   return # of bytes
+------------------------------------------------------------------------- */
+
+bigint DumpQuant::encode_values(int k, int keyframe, unsigned char *out)
+{
+  int ncomp = size_one - 2;
+  double ref = 0.0;
+  double inv = 1.0/vtol;
+  if (k == 0) ref = boxxlo;
+  else if (k == 1) ref = boxylo;
+  else if (k == 2) ref = boxzlo;
+  if (k < 3) inv = 1.0/xtol;
+
+  bigint n = 0;
+  for (int i = 0; i < natoms; i++) {
+    int m = i*ncomp + k;
+    int64_t q = static_cast<int64_t> (floor((valsnap[m] - ref)*inv + 0.5));
+    int64_t d = q;
+    if (!keyframe) d -= qprev[m];
+    qprev[m] = q;
+    uint64_t z = ((uint64_t) d << 1) ^ (uint64_t) (d >> 63);
+    while (z >= 0x80) {
+      out[n++] = (unsigned char) (z | 0x80);
+      z >>= 7;
+    }
+    out[n++] = (unsigned char) z;
+  }
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   compress one stream with zlib if available
+   npacked >= nraw means stream is stored uncompressed
+------------------------------------------------------------------------- */
+
+void DumpQuant::compress_stream(int istream)
+{
+  npacked[istream] = nraw[istream];
+#ifdef LAMMPS_ZLIB
+  if (nraw[istream] == 0) return;
+  uLongf len = maxpacked;
+  if (compress2(packed[istream],&len,raw[istream],nraw[istream],
+                Z_DEFAULT_COMPRESSION) == Z_OK)
+    npacked[istream] = len;
+#endif
+}
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(quant,DumpQuant)
+
+#else
+
+#ifndef LMP_DUMP_QUANT_H
+#define LMP_DUMP_QUANT_H
+
+#include "stdio.h"
+#include "dump.h"
+
+namespace LAMMPS_NS {
+
+class DumpQuant : public Dump {
+ public:
+  DumpQuant(LAMMPS *, int, char**);
+  ~DumpQuant();
+
+ private:
+  double xtol,vtol;           // quantization step for coords and velocities
+  int keyevery;               // every this many frames, do not delta encode
+  int nframes;
+
+  int natoms;                 // # of atoms in current snapshot
+  int nfill;                  // # of atoms received so far for it
+  int maxatoms;               // size of per-atom arrays
+  int nprev;                  // # of atoms in previous snapshot
+  int *idsnap,*idprev;        // atom IDs of current and previous snapshot
+  int *typesnap;
+  double *valsnap;            // x,y,z (and vx,vy,vz) of snapshot
+  bigint *qprev;              // quantized values of previous snapshot
+  int nstream;                // # of encoded streams per frame
+  unsigned char **raw;        // varint encoded streams
+  unsigned char **packed;     // compressed streams
+  bigint *nraw,*npacked;
+  int maxraw,maxpacked;       // size of each raw and packed stream
+
+  void init_style();
+  int modify_param(int, char **);
+  void openfile();
+  void write_header(bigint);
+  int count();
+  void pack(int *);
+  void write_data(int, double *);
+  bigint memory_usage();
+
+  void write_frame();
+  void grow_streams();
+  bigint encode_ints(int *, int, unsigned char *);
+  bigint encode_values(int, int, unsigned char *);
+  void compress_stream(int);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Invalid dump quant filename
+
+Filenames used with the dump quant style cannot be compressed, since
+the style compresses internally, or cause multiple files to be
+written.
+
+E: Dump quant tolerance must be > 0.0
+
+Self-explanatory.
+
+E: Dump quant requires sorting by atom ID
+
+Use the dump_modify sort command to enable this.
+
+E: Too many atoms for dump quant
+
+The snapshot size must fit in a 32-bit integer to use this dump
+style.
+
+E: Dump quant value too large for tolerance
+
+A coordinate or velocity divided by its tolerance does not fit in a
+64-bit integer.  Use a larger tolerance.
+
+E: Cannot open dump file
+
+The output file for the dump command cannot be opened.  Check that the
+path and name are correct.
+
+*/
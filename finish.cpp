@@ -24,10 +24,14 @@
 #include "kspace.h"
 #include "update.h"
 #include "min.h"
+#include "modify.h"
+#include "fix.h"
+#include "compute.h"
 #include "neighbor.h"
 #include "neigh_list.h"
 #include "neigh_request.h"
 #include "output.h"
+#include "dump.h"
 #include "memory.h"
 
 using namespace LAMMPS_NS;
@@ -403,6 +407,24 @@ void Finish::end(int flag)
 	fprintf(logfile,"Outpt time (%%) = %g (%g)\n",
 		time,time/time_loop*100.0);
     }
+
+    // background dump writing overlapped with the run on proc 0
+    // finish pending snapshots so their time is included
+
+    double time_async = 0.0;
+    for (int idump = 0; idump < output->ndump; idump++) {
+      output->dump[idump]->wait_async();
+      time_async += output->dump[idump]->time_async;
+      output->dump[idump]->time_async = 0.0;
+    }
+    if (me == 0 && time_async > 0.0) {
+      if (screen) 
+	fprintf(screen,"Async time (%%) = %g (%g)\n",
+		time_async,time_async/time_loop*100.0);
+      if (logfile) 
+	fprintf(logfile,"Async time (%%) = %g (%g)\n",
+		time_async,time_async/time_loop*100.0);
+    }
     
     time = time_other;
     MPI_Allreduce(&time,&tmp,1,MPI_DOUBLE,MPI_SUM,world);
@@ -415,6 +437,35 @@ void Finish::end(int flag)
 	fprintf(logfile,"Other time (%%) = %g (%g)\n",
 		time,time/time_loop*100.0);
     }
+
+    // with timer full, spread of each section across procs
+    // and the time spent in each fix and compute, part of Other time
+
+    if (timer->fullflag) {
+      if (me == 0) {
+	const char *hdr = "\nSection              min time   avg time   "
+	  "max time   max/avg  %total\n";
+	if (screen) fprintf(screen,"%s",hdr);
+	if (logfile) fprintf(logfile,"%s",hdr);
+      }
+
+      timing_line("Pair",NULL,timer->array[TIME_PAIR],time_loop);
+      if (atom->molecular)
+	timing_line("Bond",NULL,timer->array[TIME_BOND],time_loop);
+      if (force->kspace)
+	timing_line("Kspce",NULL,timer->array[TIME_KSPACE],time_loop);
+      timing_line("Neigh",NULL,timer->array[TIME_NEIGHBOR],time_loop);
+      timing_line("Comm",NULL,timer->array[TIME_COMM],time_loop);
+      timing_line("Outpt",NULL,timer->array[TIME_OUTPUT],time_loop);
+      timing_line("Other",NULL,time_other,time_loop);
+
+      for (int i = 0; i < modify->nfix; i++)
+	timing_line(modify->fix[i]->id,modify->fix[i]->style,
+		    modify->fix[i]->time_total,time_loop);
+      for (int i = 0; i < modify->ncompute; i++)
+	timing_line(modify->compute[i]->id,modify->compute[i]->style,
+		    modify->compute[i]->time_total,time_loop);
+    }
   }
   
   // FFT timing statistics
@@ -682,3 +733,33 @@ void Finish::stats(int n, double *data,
   *pmax = max;
   *pmin = min;
 }
+
+/* ----------------------------------------------------------------------
+   print min/avg/max of one timer across procs and its imbalance
+   style = NULL for a section, else label is a fix or compute ID
+------------------------------------------------------------------------- */
+
+void Finish::timing_line(const char *label, const char *style,
+			 double time, double time_loop)
+{
+  double tmin,tavg,tmax;
+  timer->reduce(time,tmin,tavg,tmax);
+
+  int me;
+  MPI_Comm_rank(world,&me);
+  if (me) return;
+
+  char name[64];
+  if (style) sprintf(name,"%.30s (%.30s)",label,style);
+  else sprintf(name,"%.60s",label);
+
+  double imbalance = 1.0;
+  if (tavg > 0.0) imbalance = tmax/tavg;
+
+  if (screen)
+    fprintf(screen,"%-20.20s %10.4g %10.4g %10.4g %9.3f %8.2f\n",
+	    name,tmin,tavg,tmax,imbalance,tavg/time_loop*100.0);
+  if (logfile)
+    fprintf(logfile,"%-20.20s %10.4g %10.4g %10.4g %9.3f %8.2f\n",
+	    name,tmin,tavg,tmax,imbalance,tavg/time_loop*100.0);
+}
@@ -54,12 +54,15 @@ Fix::Fix(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   thermo_energy = 0;
   rigid_flag = 0;
   virial_flag = 0;
+  time_total = 0.0;
   no_change_box = 0;
   time_integrate = 0;
   time_depend = 0;
   create_attribute = 0;
   restart_pbc = 0;
   cudable_comm = 0;
+  fuse_flag = 0;
+  maxexchange = 0;
 
   scalar_flag = vector_flag = array_flag = 0;
   peratom_flag = local_flag = 0;
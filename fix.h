@@ -42,6 +42,10 @@ class Fix : protected Pointers {
   int restart_pbc;               // 1 if fix moves atoms (except integrate)
                                  //      so write_restart must remap to PBC
   int cudable_comm;              // 1 if fix has CUDA-enabled communication
+  int fuse_flag;                 // 1 if its post_force() and final_integrate()
+                                 //      are also available per range of atoms
+  int maxexchange;               // max # of values pack_exchange() can add
+                                 //      for one atom, 0 if small
 
   int scalar_flag;               // 0/1 if compute_scalar() function exists
   int vector_flag;               // 0/1 if compute_vector() function exists
@@ -76,6 +80,8 @@ class Fix : protected Pointers {
   double virial[6];              // accumlated virial
   double **vatom;                // accumulated per-atom virial
 
+  double time_total;             // time in callbacks this run, if timer full
+
   Fix(class LAMMPS *, int, char **);
   virtual ~Fix();
   void modify_params(int, char **);
@@ -95,6 +101,13 @@ class Fix : protected Pointers {
   virtual void pre_force(int) {}
   virtual void post_force(int) {}
   virtual void final_integrate() {}
+
+  // post_force() = post_force_setup() + post_force_range() on all atoms
+  // same for final_integrate(), so Modify can fuse them in one atom loop
+
+  virtual void post_force_setup(int) {}
+  virtual void post_force_range(int, int) {}
+  virtual void final_integrate_range(int, int) {}
   virtual void end_of_step() {}
   virtual void post_run() {}
   virtual void write_restart(FILE *) {}
@@ -142,6 +155,7 @@ class Fix : protected Pointers {
   virtual double compute_array(int,int) {return 0.0;}
 
   virtual int dof(int) {return 0;}
+  virtual double extend_cut_ghost() {return 0.0;}
   virtual void deform(int) {}
   virtual void reset_target(double) {}
   virtual void reset_dt() {}
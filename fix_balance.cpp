@@ -0,0 +1,277 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "fix_balance.h"
+#include "balance.h"
+#include "fix_shear_history.h"
+#include "irregular.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "update.h"
+#include "modify.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{NONE,CONTACT,TIME};
+
+/* ---------------------------------------------------------------------- */
+
+FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg < 8) error->all(FLERR,"Illegal fix balance command");
+
+  box_change = 1;
+  scalar_flag = 1;
+  extscalar = 0;
+  vector_flag = 1;
+  size_vector = 2;
+  extvector = 0;
+  global_freq = 1;
+
+  nevery = atoi(arg[3]);
+  nrepeat = atoi(arg[4]);
+  niter = atoi(arg[5]);
+  if (nevery <= 0 || nrepeat <= 0 || niter <= 0)
+    error->all(FLERR,"Illegal fix balance command");
+  int n = strlen(arg[6]) + 1;
+  bstr = new char[n];
+  strcpy(bstr,arg[6]);
+  thresh = atof(arg[7]);
+  if (thresh < 1.0) error->all(FLERR,"Illegal fix balance command");
+
+  n = strlen(bstr);
+  for (int i = 0; i < n; i++) {
+    if (bstr[i] != 'x' && bstr[i] != 'y' && bstr[i] != 'z') 
+      error->all(FLERR,"Fix balance string is invalid");
+    if (bstr[i] == 'z' && domain->dimension == 2) 
+      error->all(FLERR,"Fix balance string is invalid for 2d simulation");
+  }
+
+  // optional args
+
+  wstyle = NONE;
+  wfactor = 0.0;
+
+  int iarg = 8;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"weight") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix balance command");
+      if (strcmp(arg[iarg+1],"none") == 0) {
+	wstyle = NONE;
+	iarg += 2;
+      } else if (strcmp(arg[iarg+1],"contact") == 0) {
+	if (iarg+3 > narg) error->all(FLERR,"Illegal fix balance command");
+	wstyle = CONTACT;
+	wfactor = atof(arg[iarg+2]);
+	if (wfactor < 0.0) error->all(FLERR,"Illegal fix balance command");
+	iarg += 3;
+      } else if (strcmp(arg[iarg+1],"time") == 0) {
+	wstyle = TIME;
+	iarg += 2;
+      } else error->all(FLERR,"Illegal fix balance command");
+    } else error->all(FLERR,"Illegal fix balance command");
+  }
+
+  balance = new Balance(lmp);
+  balance->dynamic_setup(nrepeat,niter,bstr,thresh);
+
+  fix_history = NULL;
+  history_after = 0;
+  maxweight = 0;
+  weight = NULL;
+  tlast = 0.0;
+
+  imbinit = imbfinal = 1.0;
+  itercount = 0;
+
+  // balance on next multiple of nevery, atoms are migrated in pre_exchange
+
+  force_reneighbor = 1;
+  next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixBalance::~FixBalance()
+{
+  delete balance;
+  delete [] bstr;
+  memory->destroy(weight);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixBalance::setmask()
+{
+  int mask = 0;
+  mask |= PRE_EXCHANGE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixBalance::init()
+{
+  // pair styles create SHEAR_HISTORY at their 1st init, after this fix,
+  // so its contacts are copied to the atoms here before they migrate
+
+  int ifix = modify->find_fix("SHEAR_HISTORY");
+  if (ifix >= 0) fix_history = (FixShearHistory *) modify->fix[ifix];
+  else fix_history = NULL;
+  history_after = (ifix > modify->find_fix(id));
+
+  if (wstyle == CONTACT && fix_history == NULL)
+    error->all(FLERR,
+	       "Fix balance weight contact requires pair style with shear history");
+}
+
+/* ----------------------------------------------------------------------
+   timer is reset after setup, so measured time restarts from 0
+------------------------------------------------------------------------- */
+
+void FixBalance::setup(int vflag)
+{
+  tlast = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   shift sub-domain boundaries so each proc has similar cost
+   then migrate atoms to their new procs
+   reneighboring follows, box_change insures comm and bins are reset
+------------------------------------------------------------------------- */
+
+void FixBalance::pre_exchange()
+{
+  if (next_reneighbor != update->ntimestep) return;
+  next_reneighbor += nevery;
+
+  // insure atoms are in current box & update box via shrink-wrap
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  domain->pbc();
+  domain->reset_box();
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  balance->set_weight(compute_weights());
+  itercount = balance->dynamic();
+  balance->set_weight(NULL);
+  imbinit = balance->imbinit;
+  imbfinal = balance->imbfinal;
+  if (itercount == 0) return;
+
+  // reset proc sub-domains
+
+  comm->uniform = 0;
+  if (domain->triclinic) domain->set_lamda_box();
+  domain->set_local_box();
+
+  // copy shear history to atoms while neighbor list indices are valid
+
+  if (fix_history && history_after) fix_history->pre_exchange();
+
+  // move atoms to new processors via irregular()
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  Irregular *irregular = new Irregular(lmp);
+  irregular->migrate_atoms();
+  delete irregular;
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  // check if any atoms were lost
+
+  bigint natoms;
+  bigint nblocal = atom->nlocal;
+  MPI_Allreduce(&nblocal,&natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (natoms != atom->natoms) {
+    char str[128];
+    sprintf(str,"Lost atoms via fix balance: original " BIGINT_FORMAT 
+	    " current " BIGINT_FORMAT,atom->natoms,natoms);
+    error->all(FLERR,str);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   per-atom cost estimate, NULL if atoms should simply be counted
+   contact: 1 + factor * # of touching partners from shear history
+   time: pair + neighbor time on this proc since last balance,
+     spread evenly over my atoms
+------------------------------------------------------------------------- */
+
+double *FixBalance::compute_weights()
+{
+  if (wstyle == NONE) return NULL;
+
+  int nlocal = atom->nlocal;
+  if (atom->nmax > maxweight) {
+    maxweight = atom->nmax;
+    memory->destroy(weight);
+    memory->create(weight,maxweight,"balance:weight");
+  }
+
+  if (wstyle == CONTACT) {
+    int *npartner = fix_history->npartner;
+    for (int i = 0; i < nlocal; i++)
+      weight[i] = 1.0 + wfactor*npartner[i];
+
+  } else if (wstyle == TIME) {
+    double tnow = timer->array[TIME_PAIR] + timer->array[TIME_NEIGHBOR];
+    double tcost = tnow - tlast;
+    tlast = tnow;
+
+    // fall back to counting atoms if no time was measured yet
+
+    double tmax;
+    MPI_Allreduce(&tcost,&tmax,1,MPI_DOUBLE,MPI_MAX,world);
+    if (tmax <= 0.0) return NULL;
+
+    double one = nlocal ? tcost/nlocal : 0.0;
+    for (int i = 0; i < nlocal; i++) weight[i] = one;
+  }
+
+  return weight;
+}
+
+/* ----------------------------------------------------------------------
+   return imbalance factor after last balance
+------------------------------------------------------------------------- */
+
+double FixBalance::compute_scalar()
+{
+  return imbfinal;
+}
+
+/* ----------------------------------------------------------------------
+   return imbalance factor before last balance and its iteration count
+------------------------------------------------------------------------- */
+
+double FixBalance::compute_vector(int i)
+{
+  if (i == 0) return imbinit;
+  return (double) itercount;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixBalance::memory_usage()
+{
+  double bytes = maxweight * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(balance,FixBalance)
+
+#else
+
+#ifndef LMP_FIX_BALANCE_H
+#define LMP_FIX_BALANCE_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixBalance : public Fix {
+ public:
+  FixBalance(class LAMMPS *, int, char **);
+  ~FixBalance();
+  int setmask();
+  void init();
+  void setup(int);
+  void pre_exchange();
+  double compute_scalar();
+  double compute_vector(int);
+  double memory_usage();
+
+ private:
+  int nrepeat,niter;
+  double thresh;
+  char *bstr;
+  int wstyle;                   // how per-atom cost is estimated
+  double wfactor;               // cost of one contact relative to one atom
+
+  class Balance *balance;
+  class FixShearHistory *fix_history;
+  int history_after;            // 1 if fix_history follows this fix
+
+  int maxweight;
+  double *weight;
+  double tlast;                 // pair + neighbor time at last balance
+
+  double imbinit,imbfinal;      // imbalance before/after last balance
+  int itercount;                // iterations of last balance
+
+  double *compute_weights();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix balance string is invalid
+
+The string can only contain the characters "x", "y", or "z".
+
+E: Fix balance string is invalid for 2d simulation
+
+The string cannot contain the letter "z".
+
+E: Fix balance weight contact requires pair style with shear history
+
+Contact counts are taken from the shear history of a granular pair
+style such as gran/hooke/history.
+
+E: Lost atoms via fix balance: original %ld current %ld
+
+This should not occur.  Report the problem to the developers.
+
+*/
@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "string.h"
+#include "fix_couple_cfd.h"
+#include "atom.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+/* ---------------------------------------------------------------------- */
+
+FixCoupleCfd::FixCoupleCfd(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg != 3) error->all(FLERR,"Illegal fix couple/cfd command");
+
+  peratom_flag = 1;
+  size_peratom_cols = 4;
+  peratom_freq = 1;
+  create_attribute = 1;
+
+  // perform initial allocation of atom-based array
+  // register with Atom class
+
+  cfd = NULL;
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) set_arrays(i);
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixCoupleCfd::~FixCoupleCfd()
+{
+  // unregister callbacks to this fix from Atom class
+
+  atom->delete_callback(id,0);
+
+  // delete locally stored array
+
+  memory->destroy(cfd);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixCoupleCfd::setmask()
+{
+  int mask = 0;
+  mask |= POST_FORCE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixCoupleCfd::setup(int vflag)
+{
+  post_force(vflag);
+}
+
+/* ----------------------------------------------------------------------
+   add drag force last set by the CFD solver to atoms in group
+   heat source is only stored, for use by other fixes, computes, dumps
+------------------------------------------------------------------------- */
+
+void FixCoupleCfd::post_force(int vflag)
+{
+  double **f = atom->f;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      f[i][0] += cfd[i][0];
+      f[i][1] += cfd[i][1];
+      f[i][2] += cfd[i][2];
+    }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based array
+------------------------------------------------------------------------- */
+
+double FixCoupleCfd::memory_usage()
+{
+  double bytes = atom->nmax*4 * sizeof(double);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate atom-based array
+   contiguous, so library.h can hand it out as 4 values per atom
+------------------------------------------------------------------------- */
+
+void FixCoupleCfd::grow_arrays(int nmax)
+{
+  memory->grow(cfd,nmax,4,"couple/cfd:cfd");
+  array_atom = cfd;
+}
+
+/* ----------------------------------------------------------------------
+   copy values within local atom-based array
+------------------------------------------------------------------------- */
+
+void FixCoupleCfd::copy_arrays(int i, int j)
+{
+  cfd[j][0] = cfd[i][0];
+  cfd[j][1] = cfd[i][1];
+  cfd[j][2] = cfd[i][2];
+  cfd[j][3] = cfd[i][3];
+}
+
+/* ----------------------------------------------------------------------
+   initialize one atom's array values, called when atom is created
+------------------------------------------------------------------------- */
+
+void FixCoupleCfd::set_arrays(int i)
+{
+  cfd[i][0] = cfd[i][1] = cfd[i][2] = cfd[i][3] = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based array for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixCoupleCfd::pack_exchange(int i, double *buf)
+{
+  buf[0] = cfd[i][0];
+  buf[1] = cfd[i][1];
+  buf[2] = cfd[i][2];
+  buf[3] = cfd[i][3];
+  return 4;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based array from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixCoupleCfd::unpack_exchange(int nlocal, double *buf)
+{
+  cfd[nlocal][0] = buf[0];
+  cfd[nlocal][1] = buf[1];
+  cfd[nlocal][2] = buf[2];
+  cfd[nlocal][3] = buf[3];
+  return 4;
+}
@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(couple/cfd,FixCoupleCfd)
+
+#else
+
+#ifndef LMP_FIX_COUPLE_CFD_H
+#define LMP_FIX_COUPLE_CFD_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixCoupleCfd : public Fix {
+ public:
+  FixCoupleCfd(class LAMMPS *, int, char **);
+  ~FixCoupleCfd();
+  int setmask();
+  void setup(int);
+  void post_force(int);
+
+  double memory_usage();
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  void set_arrays(int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+
+  double **cfd;               // per-atom drag force (3) and heat source (1)
+                              //   written by the CFD solver via library.h
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+*/
@@ -40,6 +40,7 @@ FixGravity::FixGravity(LAMMPS *lmp, int narg, char **arg) :
   scalar_flag = 1;
   global_freq = 1;
   extscalar = 1;
+  fuse_flag = 1;
 
   magnitude = atof(arg[3]);
 
@@ -141,6 +142,14 @@ void FixGravity::setup(int vflag)
 /* ---------------------------------------------------------------------- */
 
 void FixGravity::post_force(int vflag)
+{
+  post_force_setup(vflag);
+  post_force_range(0,atom->nlocal);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixGravity::post_force_setup(int vflag)
 {
   // update direction of gravity vector if gradient style
 
@@ -164,20 +173,26 @@ void FixGravity::post_force(int vflag)
     zacc = magnitude*zgrav;
   }
 
+  eflag = 0;
+  egrav = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   add gravity to atoms ifirst to ilast-1, accumulate energy in egrav
+------------------------------------------------------------------------- */
+
+void FixGravity::post_force_range(int ifirst, int ilast)
+{
   double **x = atom->x;
   double **f = atom->f;
   double *rmass = atom->rmass;
   double *mass = atom->mass;
   int *mask = atom->mask;
   int *type = atom->type;
-  int nlocal = atom->nlocal;
   double massone;
 
-  eflag = 0;
-  egrav = 0.0;
-
   if (rmass) {
-    for (int i = 0; i < nlocal; i++)
+    for (int i = ifirst; i < ilast; i++)
       if (mask[i] & groupbit) {
 	massone = rmass[i];
 	f[i][0] += massone*xacc;
@@ -186,7 +201,7 @@ void FixGravity::post_force(int vflag)
 	egrav -= massone * (xacc*x[i][0] + yacc*x[i][1] + zacc*x[i][2]);
       }
   } else {
-    for (int i = 0; i < nlocal; i++)
+    for (int i = ifirst; i < ilast; i++)
       if (mask[i] & groupbit) {
 	massone = mass[type[i]];
 	f[i][0] += massone*xacc;
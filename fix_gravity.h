@@ -34,6 +34,8 @@ class FixGravity : public Fix {
   void setup(int);
   virtual void post_force(int);
   virtual void post_force_respa(int, int, int);
+  void post_force_setup(int);
+  void post_force_range(int, int);
   double compute_scalar();
 
  protected:
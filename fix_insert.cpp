@@ -35,12 +35,17 @@ See the README file in the top-level LAMMPS directory.
 #include "fix_template_sphere.h"
 #include "fix_insert.h"
 #include "math_extra_liggghts.h"
-#include "mympi.h"
+#include "irregular.h"
 #include "myvector.h"
+#include "particleToInsert.h"
 
 using namespace LAMMPS_NS;
 
 #define EPSILON 0.001
+#define NEAR_BINS_PER_SPHERE 2
+#define NSAMPLE_SUBDOMAIN 1000
+#define MAXDRAW_SUBDOMAIN 100000
+#define SEED_LOCAL 7
 
 #define LMP_DEBUGMODE_FIXINSERT false
 #define LMP_DEBUG_OUT_FIXINSERT screen
@@ -66,6 +71,13 @@ FixInsert::FixInsert(LAMMPS *lmp, int narg, char **arg) :
   init_defaults();
 
   xnear = NULL;
+  binhead_near = binnext_near = NULL;
+  xcand = NULL;
+  maxbin_near = maxnear = ncap_near = 0;
+
+  nmine = maxmine = 0;
+  imine = NULL;
+  xmine = NULL;
 
   // parse args
   
@@ -195,6 +207,9 @@ FixInsert::FixInsert(LAMMPS *lmp, int narg, char **arg) :
   recvcounts = new int[nprocs];
   displs = new int[nprocs];
 
+  // random number generator for positions, different on each proc
+  random_local = new RanPark(lmp,seed + SEED_LOCAL + me);
+
   // set next reneighbor
   force_reneighbor = 1;
   next_reneighbor = first_ins_step;
@@ -238,8 +253,16 @@ void FixInsert::post_create()
 FixInsert::~FixInsert()
 {
   delete random;
+  delete random_local;
   delete [] recvcounts;
   delete [] displs;
+
+  memory->destroy(imine);
+  memory->destroy(xmine);
+
+  memory->destroy(binhead_near);
+  memory->destroy(binnext_near);
+  memory->sfree(xcand);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -363,11 +386,14 @@ double FixInsert::max_r_bound()
     return fix_distribution->max_r_bound();
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   Comm acquires ghosts this far out, so an insertion in my subdomain
+   sees every particle it can overlap without gathering from other procs
+------------------------------------------------------------------------- */
 
 double FixInsert::extend_cut_ghost()
 {
-    
+    if(!check_ol_flag) return 0.;
     return 2.*fix_distribution->max_r_bound();
 }
 
@@ -431,13 +457,20 @@ void FixInsert::pre_exchange()
       error->one("Particle insertion: Internal error");
   }
 
+  // pick the insertions this proc generates in its subdomain
+
+  assign_insertions(ninsert_this);
+
   // fill xnear array with particles to check overlap against
   
-  // add particles in insertion volume to xnear list
+  // add local and ghost particles in insertion volume to xnear list
   nspheres_near = 0;
   xnear = NULL;
   if(check_ol_flag)
-      nspheres_near = load_xnear(ninsert_this);
+  {
+      nspheres_near = load_xnear(nmine);
+      setup_near_bins(nspheres_near + nmine * fix_distribution->max_nspheres());
+  }
 
   // initialize insertion counter in this step
   int ninserted_this = 0, ninserted_spheres_this = 0, ninserted_spheres_this_local = 0;
@@ -446,6 +479,7 @@ void FixInsert::pre_exchange()
   // randomize insertion positions and set v, omega
   // also performs overlap check via xnear if requested
   // returns # bodies and # spheres that could actually be inserted
+  // on all procs, pti_list starts with the bodies to insert
   x_v_omega(ninsert_this,ninserted_this,ninserted_spheres_this,mass_inserted_this);
 
   // actual particle insertion
@@ -493,76 +527,540 @@ void FixInsert::pre_exchange()
 }
 
 /* ----------------------------------------------------------------------
-   count # of local particles that could overlap
+   count # of local and ghost particles that could overlap
 ------------------------------------------------------------------------- */
 
 int FixInsert::count_nnear()
 {
-    int nlocal = atom->nlocal;
+    int nall = atom->nlocal + atom->nghost;
     int ncount = 0;
 
-    for(int i = 0; i < nlocal; i++)
+    for(int i = 0; i < nall; i++)
         ncount += overlap(i);
 
     return ncount;
 }
 
 /* ----------------------------------------------------------------------
-   fill xnear with nearby particles
+   fill xnear with nearby local and ghost particles
+   ghost cutoff covers 2 max bounding radii, see extend_cut_ghost(),
+     so no particles from other procs have to be gathered
 ------------------------------------------------------------------------- */
 
 int FixInsert::load_xnear(int ninsert_this)
 {
-  // count nearby spheres
-  // setup for allgatherv
-  int nspheres_near_all;
   int nspheres_near = count_nnear();
 
-  MyMPI::My_MPI_Sum_Scalar(nspheres_near,nspheres_near_all,world);
+  // xnear is for my local and ghost atoms + atoms to be inserted
 
-  // data size per particle: x and radius
-  int n = 4*nspheres_near;
+  xnear = memory->create_2d_double_array(nspheres_near + ninsert_this * fix_distribution->max_nspheres(),4,"FixInsert::xnear");
 
-  // preparations for allgatherv
-  MPI_Allgather(&n,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int nall = atom->nlocal + atom->nghost;
 
-  displs[0] = 0;
-  for (int iproc = 1; iproc < nprocs; iproc++)
-    displs[iproc] = displs[iproc-1] + recvcounts[iproc-1];
+  int ncount = 0;
+  for (int i = 0; i < nall; i++)
+    if (overlap(i)) {
+      xnear[ncount][0] = x[i][0];
+      xnear[ncount][1] = x[i][1];
+      xnear[ncount][2] = x[i][2];
+      xnear[ncount][3] = radius[i];
+      ncount++;
+    }
 
-  // xmine is for my atoms
-  // xnear is for atoms from all procs + atoms to be inserted
+  return nspheres_near;
+}
 
-  double **xmine =
-    memory->create_2d_double_array(nspheres_near,4,"FixInsertPack::xmine");
+/* ----------------------------------------------------------------------
+   bin xnear so the overlap check only looks at nearby spheres
+   nmax = # of rows in xnear, including room for spheres to be inserted
+   bins span my subdomain plus the overlap cutoff
+   positions outside map to the boundary bins
+------------------------------------------------------------------------- */
 
-  xnear = memory->create_2d_double_array(nspheres_near_all + ninsert_this * fix_distribution->max_nspheres(),4,"FixInsert::xnear");
+void FixInsert::setup_near_bins(int nmax)
+{
+  ncap_near = nmax;
+  if(nmax > maxnear)
+  {
+      maxnear = nmax;
+      memory->destroy(binnext_near);
+      memory->create(binnext_near,maxnear,"FixInsert::binnext_near");
+      memory->sfree(xcand);
+      xcand = (double **) memory->smalloc(maxnear*sizeof(double *),"FixInsert::xcand");
+  }
 
-  // load up xmine array
+  // bin size is the largest diameter of near or inserted spheres
+  // coarsen bins if there would be many more bins than spheres
 
-  double **x = atom->x;
-  double *radius = atom->radius;
-  int nlocal = atom->nlocal;
+  radmax_near = maxrad;
+  for(int i = 0; i < nspheres_near; i++)
+      radmax_near = MathExtraLiggghts::max(radmax_near,xnear[i][3]);
 
-  int ncount = 0;
-  for (int i = 0; i < nlocal; i++)
-    if (overlap(i)) {
-      xmine[ncount][0] = x[i][0];
-      xmine[ncount][1] = x[i][1];
-      xmine[ncount][2] = x[i][2];
-      xmine[ncount][3] = radius[i];
-      ncount++;
+  double cut = fix_distribution->max_r_bound() + radmax_near;
+  double prd[3];
+  for(int dim = 0; dim < 3; dim++)
+  {
+      binlo_near[dim] = domain->sublo[dim] - cut;
+      prd[dim] = domain->subhi[dim] - domain->sublo[dim] + 2.*cut;
+  }
+
+  double binsize = 2.*radmax_near;
+  double nbins_target = static_cast<double>(NEAR_BINS_PER_SPHERE * (nmax > 0 ? nmax : 1));
+  double nbins_est = (prd[0]/binsize) * (prd[1]/binsize) * (prd[2]/binsize);
+  if(nbins_est > nbins_target) binsize *= cbrt(nbins_est/nbins_target);
+
+  int nbin[3];
+  for(int dim = 0; dim < 3; dim++)
+  {
+      nbin[dim] = static_cast<int>(prd[dim]/binsize);
+      if(nbin[dim] < 1) nbin[dim] = 1;
+      binsize_near[dim] = prd[dim]/static_cast<double>(nbin[dim]);
+      bininv_near[dim] = 1./binsize_near[dim];
+  }
+  nbinx_near = nbin[0];
+  nbiny_near = nbin[1];
+  nbinz_near = nbin[2];
+
+  int nbins = nbinx_near*nbiny_near*nbinz_near;
+  if(nbins > maxbin_near)
+  {
+      maxbin_near = nbins;
+      memory->destroy(binhead_near);
+      memory->create(binhead_near,maxbin_near,"FixInsert::binhead_near");
+  }
+
+  for(int i = 0; i < nbins; i++) binhead_near[i] = -1;
+  for(int i = 0; i < nspheres_near; i++) bin_near(i);
+}
+
+/* ----------------------------------------------------------------------
+   bin index of coord in one dimension, clamped to the bin grid
+------------------------------------------------------------------------- */
+
+int FixInsert::coord2bin_near(double coord, int dim)
+{
+  int nbin = (dim == 0) ? nbinx_near : ((dim == 1) ? nbiny_near : nbinz_near);
+  double r = (coord - binlo_near[dim]) * bininv_near[dim];
+
+  if(r < 0.) return 0;
+  if(r >= static_cast<double>(nbin)) return nbin-1;
+  return static_cast<int>(r);
+}
+
+/* ----------------------------------------------------------------------
+   add xnear entry i to its bin
+------------------------------------------------------------------------- */
+
+void FixInsert::bin_near(int i)
+{
+  int ix = coord2bin_near(xnear[i][0],0);
+  int iy = coord2bin_near(xnear[i][1],1);
+  int iz = coord2bin_near(xnear[i][2],2);
+  int ibin = (iz*nbiny_near + iy)*nbinx_near + ix;
+
+  binnext_near[i] = binhead_near[ibin];
+  binhead_near[ibin] = i;
+}
+
+/* ----------------------------------------------------------------------
+   overlap check of pti at pos against xnear entries in surrounding bins
+   candidates are handed to pti as ptrs into xnear, followed by ptrs to
+   free xnear rows that pti fills with its spheres if insertion succeeds
+   returns # spheres inserted, as check_near_set_x_v_omega()
+------------------------------------------------------------------------- */
+
+int FixInsert::check_near(ParticleToInsert *pti, double *pos, double *v, double *omega, double *quat)
+{
+  double cut = pti->r_bound_ins + radmax_near;
+  int lo[3],hi[3];
+
+  for(int dim = 0; dim < 3; dim++)
+  {
+      lo[dim] = coord2bin_near(pos[dim]-cut,dim);
+      hi[dim] = coord2bin_near(pos[dim]+cut,dim);
+  }
+
+  int ncand = 0;
+  for(int iz = lo[2]; iz <= hi[2]; iz++)
+    for(int iy = lo[1]; iy <= hi[1]; iy++)
+      for(int ix = lo[0]; ix <= hi[0]; ix++)
+        for(int j = binhead_near[(iz*nbiny_near + iy)*nbinx_near + ix]; j >= 0; j = binnext_near[j])
+          xcand[ncand++] = xnear[j];
+
+  int nfree = fix_distribution->max_nspheres();
+  if(nfree > ncap_near-nspheres_near) nfree = ncap_near-nspheres_near;
+  for(int k = 0; k < nfree; k++)
+      xcand[ncand+k] = xnear[nspheres_near+k];
+
+  int nnear = ncand;
+  int nins = pti->check_near_set_x_v_omega(pos,v,omega,quat,xcand,nnear);
+
+  for(int k = ncand; k < nnear; k++)
+      bin_near(nspheres_near++);
+
+  return nins;
+}
+
+/* ----------------------------------------------------------------------
+   pick the insertions of this step that this proc generates
+   each insertion goes to a proc with probability of its share of the
+     insertion volume, estimated by sampling positions
+   draws from the shared generator, so all procs agree on the assignment
+------------------------------------------------------------------------- */
+
+void FixInsert::assign_insertions(int ninsert_this)
+{
+  int i,k,lo,hi,mid,iproc;
+  double pos[3];
+
+  if(ninsert_this > maxmine)
+  {
+      maxmine = ninsert_this;
+      memory->destroy(imine);
+      memory->destroy(xmine);
+      memory->create(imine,maxmine,"FixInsert::imine");
+      memory->create(xmine,maxmine,4,"FixInsert::xmine");
+  }
+
+  nmine = 0;
+  if(nprocs == 1)
+  {
+      for(k = 0; k < ninsert_this; k++) imine[nmine++] = k;
+      return;
+  }
+
+  // displs = cumulative # of samples that fell into procs 0 to iproc
+
+  ParticleToInsert *pti = fix_distribution->pti_list[0];
+  int nsub = 0;
+  for(i = 0; i < NSAMPLE_SUBDOMAIN; i++)
+  {
+      generate_pos(pti,pos);
+      if(in_subdomain(pos)) nsub++;
+  }
+
+  MPI_Allgather(&nsub,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  displs[0] = recvcounts[0];
+  for(iproc = 1; iproc < nprocs; iproc++)
+      displs[iproc] = displs[iproc-1] + recvcounts[iproc];
+  int nsuball = displs[nprocs-1];
+
+  for(k = 0; k < ninsert_this; k++)
+  {
+      if(nsuball == 0) iproc = k % nprocs;
+      else
+      {
+          int isample = static_cast<int>(random->uniform() * nsuball);
+          lo = 0;
+          hi = nprocs-1;
+          while(lo < hi)
+          {
+              mid = (lo+hi)/2;
+              if(isample < displs[mid]) hi = mid;
+              else lo = mid+1;
+          }
+          iproc = lo;
+      }
+      if(iproc == me) imine[nmine++] = k;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   1 if pos is in my subdomain, 0 if not
+------------------------------------------------------------------------- */
+
+int FixInsert::in_subdomain(double *pos)
+{
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+
+  if(pos[0] >= sublo[0] && pos[0] < subhi[0] &&
+     pos[1] >= sublo[1] && pos[1] < subhi[1] &&
+     pos[2] >= sublo[2] && pos[2] < subhi[2]) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   generate a random position for pti inside my subdomain
+   returns 0 if no position was found within MAXDRAW_SUBDOMAIN draws
+------------------------------------------------------------------------- */
+
+int FixInsert::generate_pos_subdomain(ParticleToInsert *pti, double *pos)
+{
+  for(int idraw = 0; idraw < MAXDRAW_SUBDOMAIN; idraw++)
+  {
+      generate_pos(pti,pos);
+      if(in_subdomain(pos)) return 1;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   generate positions for my insertions within my subdomain
+   perform overlap check via xnear if requested, then resolve overlaps
+     with insertions of nearby procs
+   all procs then set x, v, omega of all accepted insertions
+     and move them to the front of pti_list
+   returns # bodies and # spheres that could actually be inserted
+------------------------------------------------------------------------- */
+
+void FixInsert::x_v_omega(int ninsert_this,int &ninserted_this, int &ninserted_spheres_this, double &mass_inserted_this)
+{
+    int k,nins;
+    double pos[3],v[3],omega[3];
+    ParticleToInsert *pti;
+    ParticleToInsert **pti_list = fix_distribution->pti_list;
+
+    ninserted_this = ninserted_spheres_this = 0;
+    mass_inserted_this = 0.;
+
+    v_omega_ins(v,omega);
+
+    // account for maxattempt
+    // pti checks against nearby xnear entries and adds self contributions
+
+    int naccept = 0;
+    int ntry = 0;
+    int maxtry = nmine * maxattempt;
+
+    for(k = 0; k < nmine && ntry < maxtry; k++)
+    {
+        pti = pti_list[imine[k]];
+
+        nins = 0;
+        while(nins == 0 && ntry < maxtry)
+        {
+            if(!generate_pos_subdomain(pti,pos))
+            {
+                ntry = maxtry;
+                break;
+            }
+            ntry++;
+
+            // could ramdonize vel, omega, quat here
+
+            if(check_ol_flag) nins = check_near(pti,pos,v,omega,quat_insert);
+            else nins = 1;
+        }
+
+        if(nins > 0)
+        {
+            xmine[naccept][0] = static_cast<double>(imine[k]);
+            vectorCopy3D(pos,&xmine[naccept][1]);
+            naccept++;
+        }
     }
 
-  // perform allgatherv to acquire list of nearby particles on all procs
+    if(check_ol_flag) naccept = resolve_conflicts(naccept);
+
+    // gather accepted insertions of all procs
+
+    int n = 4*naccept;
+    MPI_Allgather(&n,1,MPI_INT,recvcounts,1,MPI_INT,world);
 
-  double *ptr = NULL;
-  if (ncount) ptr = xmine[0];
-  MPI_Allgatherv(ptr,4*nspheres_near,MPI_DOUBLE,xnear[0],recvcounts,displs,MPI_DOUBLE,world);
+    displs[0] = 0;
+    for (int iproc = 1; iproc < nprocs; iproc++)
+      displs[iproc] = displs[iproc-1] + recvcounts[iproc-1];
+    int nall = (displs[nprocs-1] + recvcounts[nprocs-1]) / 4;
 
-  memory->destroy_2d_double_array(xmine);
+    double *xall;
+    int *used;
+    memory->create(xall,4*nall,"FixInsert::xall");
+    memory->create(used,ninsert_this,"FixInsert::used");
+    ParticleToInsert **ptmp = (ParticleToInsert **)
+      memory->smalloc(ninsert_this*sizeof(ParticleToInsert *),"FixInsert::ptmp");
+
+    double *ptr = NULL;
+    if (naccept) ptr = xmine[0];
+    MPI_Allgatherv(ptr,n,MPI_DOUBLE,xall,recvcounts,displs,MPI_DOUBLE,world);
+
+    // reorder pti_list so accepted insertions come first, in gathered order
+    // set their x, v, omega
+
+    for(k = 0; k < ninsert_this; k++) used[k] = 0;
+
+    for(k = 0; k < nall; k++)
+    {
+        int ipti = static_cast<int>(xall[4*k]);
+        used[ipti] = 1;
+        pti = ptmp[k] = pti_list[ipti];
+
+        ninserted_spheres_this += pti->set_x_v_omega(&xall[4*k+1],v,omega,quat_insert);
+        mass_inserted_this += pti->mass_ins;
+        ninserted_this++;
+    }
+
+    n = nall;
+    for(k = 0; k < ninsert_this; k++)
+        if(!used[k]) ptmp[n++] = pti_list[k];
+    for(k = 0; k < ninsert_this; k++) pti_list[k] = ptmp[k];
+
+    memory->destroy(xall);
+    memory->destroy(used);
+    memory->sfree(ptmp);
+}
 
-  return nspheres_near_all;
+/* ----------------------------------------------------------------------
+   drop accepted insertions that overlap an insertion of a lower proc
+   only insertions near a subdomain boundary are sent, to each proc whose
+     subdomain extended by the overlap cutoff contains them
+   overlap uses the bounding spheres of the inserted bodies
+   returns # of insertions left in xmine
+------------------------------------------------------------------------- */
+
+int FixInsert::resolve_conflicts(int naccept)
+{
+  int i,j,k,m,ix,iy,iz,ipti;
+  int nloc[3],*loc[3];
+  double dx[3],rsum;
+
+  if(nprocs == 1) return naccept;
+
+  ParticleToInsert **pti_list = fix_distribution->pti_list;
+  double cut = 2.*fix_distribution->max_r_bound();
+
+  // count and list destination procs of my accepted insertions
+
+  int nsend = 0;
+  int maxsend = naccept;
+  int *proclist;
+  double **sendbuf;
+  memory->create(proclist,maxsend,"FixInsert::proclist");
+  memory->create(sendbuf,maxsend,5,"FixInsert::sendbuf");
+  for(int dim = 0; dim < 3; dim++)
+    memory->create(loc[dim],comm->procgrid[dim],"FixInsert::loc");
+
+  for(k = 0; k < naccept; k++)
+  {
+    for(int dim = 0; dim < 3; dim++)
+        nloc[dim] = proc_locs_near(xmine[k][dim+1],cut,dim,loc[dim]);
+
+    for(int kz = 0; kz < nloc[2]; kz++)
+      for(int ky = 0; ky < nloc[1]; ky++)
+        for(int kx = 0; kx < nloc[0]; kx++)
+        {
+          ix = loc[0][kx];
+          iy = loc[1][ky];
+          iz = loc[2][kz];
+          int iproc = comm->grid2proc[ix][iy][iz];
+          if(iproc == me) continue;
+          if(nsend == maxsend)
+          {
+              maxsend += naccept;
+              memory->grow(proclist,maxsend,"FixInsert::proclist");
+              memory->grow(sendbuf,maxsend,5,"FixInsert::sendbuf");
+          }
+          ipti = static_cast<int>(xmine[k][0]);
+          proclist[nsend] = iproc;
+          vectorCopy3D(&xmine[k][1],sendbuf[nsend]);
+          sendbuf[nsend][3] = pti_list[ipti]->r_bound_ins;
+          sendbuf[nsend][4] = static_cast<double>(me);
+          nsend++;
+        }
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrecv = irregular->create_data(nsend,proclist);
+  double **recvbuf;
+  memory->create(recvbuf,nrecv > 0 ? nrecv : 1,5,"FixInsert::recvbuf");
+  irregular->exchange_data((char *) (nsend ? sendbuf[0] : NULL),5*sizeof(double),(char *) recvbuf[0]);
+  irregular->destroy_data();
+  delete irregular;
+
+  memory->destroy(proclist);
+  memory->destroy(sendbuf);
+  for(int dim = 0; dim < 3; dim++) memory->destroy(loc[dim]);
+
+  // keep insertions that do not overlap one of a lower proc
+  // lower proc keeps its insertion, so exactly one of an overlapping pair
+  //   is inserted unless the lower one is itself dropped by an even lower one
+  // distance is the minimum image, insertions may face each other
+  //   across a periodic boundary
+
+  m = 0;
+  for(k = 0; k < naccept; k++)
+  {
+    ipti = static_cast<int>(xmine[k][0]);
+    for(j = 0; j < nrecv; j++)
+    {
+      if(static_cast<int>(recvbuf[j][4]) > me) continue;
+      vectorSubtract3D(&xmine[k][1],recvbuf[j],dx);
+      domain->minimum_image(dx);
+      rsum = pti_list[ipti]->r_bound_ins + recvbuf[j][3];
+      if(vectorMag3DSquared(dx) < rsum*rsum) break;
+    }
+    if(j < nrecv) continue;
+    if(m != k)
+      for(i = 0; i < 4; i++) xmine[m][i] = xmine[k][i];
+    m++;
+  }
+
+  memory->destroy(recvbuf);
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   locations in proc grid along dim of procs within cut of coord
+   periodic dims wrap around, others are clamped to the grid
+   each location is listed once, returns # of locations
+------------------------------------------------------------------------- */
+
+int FixInsert::proc_locs_near(double coord, double cut, int dim, int *loc)
+{
+  int i;
+  int n = comm->procgrid[dim];
+  int lo = coord2proc_loc(coord-cut,dim);
+  int hi = coord2proc_loc(coord+cut,dim);
+  int nloc = 0;
+
+  // range wrapped around a periodic boundary unless lo <= hi without wrap
+
+  int wrap = domain->periodicity[dim] &&
+    (coord-cut < domain->boxlo[dim] || coord+cut >= domain->boxhi[dim]);
+
+  if(wrap && (lo <= hi || 2.*cut >= domain->prd[dim]))
+    for(i = 0; i < n; i++) loc[nloc++] = i;
+  else if(wrap)
+  {
+    for(i = lo; i < n; i++) loc[nloc++] = i;
+    for(i = 0; i <= hi; i++) loc[nloc++] = i;
+  }
+  else
+    for(i = lo; i <= hi; i++) loc[nloc++] = i;
+
+  return nloc;
+}
+
+/* ----------------------------------------------------------------------
+   location in proc grid along dim of coord
+   coord is remapped into the box in periodic dims, else clamped to the grid
+------------------------------------------------------------------------- */
+
+int FixInsert::coord2proc_loc(double coord, int dim)
+{
+  double *split;
+  if(dim == 0) split = comm->xsplit;
+  else if(dim == 1) split = comm->ysplit;
+  else split = comm->zsplit;
+
+  double frac = (coord - domain->boxlo[dim]) / domain->prd[dim];
+  if(domain->periodicity[dim]) frac -= floor(frac);
+  int n = comm->procgrid[dim];
+  int loc = 0;
+  while(loc < n-1 && frac >= split[loc+1]) loc++;
+  return loc;
+}
+
+/* ----------------------------------------------------------------------
+   velocity and angular velocity of inserted particles
+------------------------------------------------------------------------- */
+
+void FixInsert::v_omega_ins(double *v, double *omega)
+{
+  vectorCopy3D(v_insert,v);
+  vectorCopy3D(omega_insert,omega);
 }
 
 /* ----------------------------------------------------------------------
@@ -38,7 +38,7 @@ class FixInsert : public Fix {
 
   virtual int setmask();
   virtual void init();
-  double extend_cut_ghost();
+  virtual double extend_cut_ghost();
   void pre_exchange();
   virtual void end_of_step() {}
 
@@ -103,7 +103,8 @@ class FixInsert : public Fix {
   // maximum radius to be inserted
   double maxrad;
 
-  // flag if overlap is checked upon insertion (via all-to-all comm)
+  // flag if overlap is checked upon insertion
+  // against local and ghost particles, plus candidates of nearby procs
   int check_ol_flag;
 
   // if flag is 1, particles are generated to be in the region as a whole
@@ -112,10 +113,21 @@ class FixInsert : public Fix {
 
   int maxattempt;
 
-  // positions generated, and for overlap check
+  // local and ghost particles for overlap check, and positions generated
   int nspheres_near;
   double **xnear;
 
+  // bins for overlap check, so each trial position is only
+  // checked against xnear entries in surrounding bins
+  // bins span my subdomain, extended by the overlap cutoff
+  // binnext is a linked list of xnear entries, xcand holds ptrs to candidates
+  int nbinx_near,nbiny_near,nbinz_near,maxbin_near;
+  double binlo_near[3],binsize_near[3],bininv_near[3];
+  double radmax_near;
+  int *binhead_near,*binnext_near;
+  double **xcand;
+  int maxnear,ncap_near;
+
   // velocity and ang vel distribution
   // currently constant - could also be a distribution
   double v_insert[3];
@@ -124,11 +136,19 @@ class FixInsert : public Fix {
 
   /*---FURTHER THINGS THAT WE NEED---*/
 
-  // random generator
+  // random generator, same for all procs
+  // random_local generates positions in my subdomain, different on each proc
   class RanPark *random;
+  class RanPark *random_local;
   int seed;
 
-  // all2all comm
+  // insertions generated by this proc, as indices into pti_list
+  // xmine = pti_list index and position of each accepted insertion
+  int nmine,maxmine;
+  int *imine;
+  double **xmine;
+
+  // allgather of accepted insertions
   int me,nprocs;
   int *recvcounts,*displs;
 
@@ -152,7 +172,21 @@ class FixInsert : public Fix {
   virtual int count_nnear();
   virtual int overlap(int) = 0;
 
-  virtual void x_v_omega(int,int&,int&,double&) = 0;
+  void setup_near_bins(int);
+  void bin_near(int);
+  int coord2bin_near(double,int);
+  int check_near(class ParticleToInsert *,double *,double *,double *,double *);
+
+  void assign_insertions(int);
+  int in_subdomain(double *);
+  int generate_pos_subdomain(class ParticleToInsert *,double *);
+  int resolve_conflicts(int);
+  int proc_locs_near(double,double,int,int *);
+  int coord2proc_loc(double,int);
+
+  virtual void x_v_omega(int,int&,int&,double&);
+  virtual void generate_pos(class ParticleToInsert *,double *) = 0;
+  virtual void v_omega_ins(double *,double *);
 
   virtual void finalize_insertion(int){};
 };
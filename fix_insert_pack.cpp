@@ -124,6 +124,10 @@ void FixInsertPack::calc_insertion_properties()
     ins_region->reset_random(seed + SEED_OFFSET);
     region_volume = ins_region->volume_mc(ntry_mc);
 
+    // region volume must be the same on all procs, positions are then
+    // generated per subdomain with a different sequence on each proc
+    ins_region->reset_random(seed + SEED_OFFSET + comm->me);
+
     // error checks to disallow args from FixInsert
     if(ninsert > 0 || massinsert > 0.) error->all("Illegal fix insert/pack command, specifying 'nparticles' or 'mass' not allowed");
     if(nflowrate > 0. || massflowrate > 0.) error->all("Illegal fix insert/pack command, specifying 'nflowrate' or 'massflowrate' not allowed");
@@ -218,74 +222,13 @@ inline int FixInsertPack::overlap(int i)
 }
 
 /* ----------------------------------------------------------------------
-   generate random positions within insertion volume
-   perform overlap check via xnear if requested
-   returns # bodies and # spheres that could actually be inserted
+   generate random position within insertion volume
 ------------------------------------------------------------------------- */
 
-void FixInsertPack::x_v_omega(int ninsert_this,int &ninserted_this, int &ninserted_spheres_this, double &mass_inserted_this)
+void FixInsertPack::generate_pos(ParticleToInsert *pti, double *pos)
 {
-    ninserted_this = ninserted_spheres_this = 0;
-    mass_inserted_this = 0.;
-
-    double pos[3];
-    ParticleToInsert *pti;
-
-    // no overlap check
-    if(!check_ol_flag)
-    {
-        for(int itotal = 0; itotal < ninsert_this; itotal++)
-        {
-            pti = fix_distribution->pti_list[ninserted_this];
-            double rbound = pti->r_bound_ins;
-
-            if(all_in_flag) ins_region->generate_random_cut_away(pos,rbound);
-            else ins_region->generate_random(pos);
-
-            // could ramdonize vel, omega, quat here
-
-            if(pos[0] == 0. && pos[1] == 0. && pos[2] == 0.) error->all("FixInsertPack::x_v_omega() illegal position");
-            ninserted_spheres_this += pti->set_x_v_omega(pos,v_insert,omega_insert,quat_insert);
-            mass_inserted_this += pti->mass_ins;
-            ninserted_this++;
-
-        }
-    }
-    // overlap check
-    // account for maxattempt
-    // pti checks against xnear and adds self contributions
-    else
-    {
-        int ntry = 0;
-        int maxtry = ninsert_this * maxattempt;
-
-        while(ntry < maxtry && ninserted_this < ninsert_this)
-        {
-            
-            pti = fix_distribution->pti_list[ninserted_this];
-            double rbound = pti->r_bound_ins;
-
-            int nins = 0;
-            while(nins == 0 && ntry < maxtry)
-            {
-                if(all_in_flag) ins_region->generate_random_cut_away(pos,rbound);
-                else ins_region->generate_random(pos);
-                ntry++;
-
-                // could ramdonize vel, omega, quat here
-
-                nins = pti->check_near_set_x_v_omega(pos,v_insert,omega_insert,quat_insert,xnear,nspheres_near);
-
-            }
-
-            if(nins > 0)
-            {
-                ninserted_spheres_this += nins;
-                mass_inserted_this += pti->mass_ins;
-                ninserted_this++;
-            }
-        }
-    }
+    if(all_in_flag) ins_region->generate_random_cut_away(pos,pti->r_bound_ins);
+    else ins_region->generate_random(pos);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -294,5 +237,5 @@ void FixInsertPack::restart(char *buf)
 {
     FixInsert::restart(buf);
 
-    ins_region->reset_random(seed + SEED_OFFSET);
+    ins_region->reset_random(seed + SEED_OFFSET + comm->me);
 }
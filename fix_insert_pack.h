@@ -45,7 +45,7 @@ class FixInsertPack : public FixInsert {
   void init_defaults();
 
   virtual int calc_ninsert_this();
-  virtual void x_v_omega(int,int&,int&,double&);
+  virtual void generate_pos(class ParticleToInsert *,double *);
   int overlap(int);
 
   // region to be used for insertion
@@ -322,6 +322,7 @@ inline int FixInsertStream::overlap(int i)
 /* ----------------------------------------------------------------------
    generate random positions on insertion face
    extrude by random length in negative face normal direction
+   uses the generator of this proc, since positions are generated per subdomain
      currently only implemented for all_in_flag = 0
      since would be tedious to check/implement otherwise
 ------------------------------------------------------------------------- */
@@ -331,89 +332,36 @@ inline void FixInsertStream::generate_random(double *pos, double rad)
     double r, ext[3];
 
     // generate random position on the mesh
-    ins_face->STLdata->generate_random(pos,random);
+    ins_face->STLdata->generate_random(pos,random_local);
 
     // extrude the position
     
     if(check_ol_flag)
-        r = -1.*(random->uniform()*(extrude_length -    rad) + rad);
+        r = -1.*(random_local->uniform()*(extrude_length -    rad) + rad);
     else
-        r = -1.*(random->uniform()*(extrude_length - 2.*rad) + rad);
+        r = -1.*(random_local->uniform()*(extrude_length - 2.*rad) + rad);
 
     vectorScalarMult3D(normalvec,r,ext);
     vectorAdd3D(pos,ext,pos);
 }
 
 /* ----------------------------------------------------------------------
-   generate random positions within extruded face
-   perform overlap check via xnear if requested
-   returns # bodies and # spheres that could actually be inserted
+   generate random position within extruded face
 ------------------------------------------------------------------------- */
 
-void FixInsertStream::x_v_omega(int ninsert_this,int &ninserted_this, int &ninserted_spheres_this, double &mass_inserted_this)
+void FixInsertStream::generate_pos(ParticleToInsert *pti, double *pos)
 {
-    
-    ninserted_this = ninserted_spheres_this = 0;
-    mass_inserted_this = 0.;
-
-    int nins;
-    double pos[3];
-    ParticleToInsert *pti;
-
-    double omega_tmp[] = {0.,0.,0.};
-
-    // no overlap check
-    // insert with v_normal, no omega
-    if(!check_ol_flag)
-    {
-        for(int itotal = 0; itotal < ninsert_this; itotal++)
-        {
-            pti = fix_distribution->pti_list[ninserted_this];
-            double rad_to_insert = pti->r_bound_ins;
-            generate_random(pos,rad_to_insert);
-
-            // could ramdonize vel, omega, quat here
-
-            nins = pti->set_x_v_omega(pos,v_normal,omega_tmp,quat_insert);
-
-            ninserted_spheres_this += nins;
-            mass_inserted_this += pti->mass_ins;
-            ninserted_this++;
-        }
-    }
-    // overlap check
-    // account for maxattempt
-    // pti checks against xnear and adds self contributions
-    else
-    {
-        int ntry = 0;
-        int maxtry = ninsert_this * maxattempt;
-
-        while(ntry < maxtry && ninserted_this < ninsert_this)
-        {
-            pti = fix_distribution->pti_list[ninserted_this];
-            double rad_to_insert = pti->r_bound_ins;
-
-            nins = 0;
-            while(nins == 0 && ntry < maxtry)
-            {
-                generate_random(pos,rad_to_insert);
-
-                // could ramdonize vel, omega, quat here
-
-                ntry++;
-                nins = pti->check_near_set_x_v_omega(pos,v_normal,omega_tmp,quat_insert,xnear,nspheres_near);
-            }
+    generate_random(pos,pti->r_bound_ins);
+}
 
-            if(nins > 0)
-            {
-                ninserted_spheres_this += nins;
-                mass_inserted_this += pti->mass_ins;
-                ninserted_this++;
-            }
-        }
-    }
+/* ----------------------------------------------------------------------
+   insert with v_normal, no omega
+------------------------------------------------------------------------- */
 
+void FixInsertStream::v_omega_ins(double *v, double *omega)
+{
+    vectorCopy3D(v_normal,v);
+    vectorZeroize3D(omega);
 }
 
 /* ---------------------------------------------------------------------- */
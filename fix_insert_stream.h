@@ -51,7 +51,8 @@ class FixInsertStream : public FixInsert {
   int overlap(int);
   inline void generate_random(double *pos, double rad);
 
-  void x_v_omega(int ninsert_this,int &ninserted_this, int &ninserted_spheres_this, double &mass_inserted_this);
+  virtual void generate_pos(class ParticleToInsert *,double *);
+  virtual void v_omega_ins(double *,double *);
   virtual void finalize_insertion(int);
 
   // additional insertion settings
@@ -34,6 +34,8 @@ See the README file in the top-level LAMMPS directory.
 #include "error.h"
 #include "group.h"
 #include "neighbor.h"
+#include "output.h"
+#include "irregular.h"
 #include "triSpherePenetration.h"
 #include "stl_tri.h"
 #include "mympi.h"
@@ -59,6 +61,20 @@ FixMeshGranAnalyze::FixMeshGranAnalyze(LAMMPS *lmp, int narg, char **arg) :
    finnie_flag = 0;
    k_finnie = NULL;
 
+   MPI_Comm_rank(world,&me);
+   MPI_Comm_size(world,&nprocs);
+
+   maxtri = ntouched = 0;
+   touchflag = touched = NULL;
+   tri_lo = tri_hi = 0;
+   proclist = NULL;
+   reduced_step = -1;
+
+   recvcounts = new int[nprocs];
+   rdispls = new int[nprocs];
+   maxsend = maxrecv = 0;
+   buf_send = buf_recv = NULL;
+
    bool hasargs = true;
    while(iarg < narg && hasargs)
    {
@@ -81,7 +97,13 @@ FixMeshGranAnalyze::FixMeshGranAnalyze(LAMMPS *lmp, int narg, char **arg) :
 
 FixMeshGranAnalyze::~FixMeshGranAnalyze()
 {
-
+    memory->destroy(touchflag);
+    memory->destroy(touched);
+    memory->destroy(proclist);
+    delete [] recvcounts;
+    delete [] rdispls;
+    memory->destroy(buf_send);
+    memory->destroy(buf_recv);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -100,6 +122,33 @@ void FixMeshGranAnalyze::init()
 {
     if(finnie_flag)
         k_finnie = static_cast<FixPropertyGlobal*>(modify->find_fix_property("k_finnie","property/global","peratomtypepair",atom->ntypes,atom->ntypes))->get_array();
+
+    // start with no local contributions
+    // each proc owns a contiguous block of triangles for the reduction
+
+    int nTri = STLdata->nTri;
+    if(nTri > maxtri)
+    {
+        maxtri = nTri;
+        memory->destroy(touchflag);
+        memory->destroy(touched);
+        memory->destroy(proclist);
+        memory->create(touchflag,maxtri,"FixMeshGranAnalyze:touchflag");
+        memory->create(touched,maxtri,"FixMeshGranAnalyze:touched");
+        memory->create(proclist,maxtri,"FixMeshGranAnalyze:proclist");
+    }
+
+    for(int i = 0; i < nTri; i++)
+    {
+        touchflag[i] = 0;
+        vectorZeroize3D(STLdata->f_tri[i]);
+        STLdata->wear_step[i] = 0.;
+    }
+    ntouched = 0;
+    reduced_step = -1;
+
+    tri_lo = tri_first(me);
+    tri_hi = tri_first(me+1);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -109,9 +158,21 @@ void FixMeshGranAnalyze::pre_force(int vflag)
     vectorZeroize3D(force_total);
     vectorZeroize3D(torque_total);
 
-    for(int i=0;i<nTri;i++)
-        for(int j=0;j<3;j++)
+    // after a reduction, my block (all triangles on proc 0) holds reduced forces
+
+    if(reduced_step >= 0)
+    {
+        int lo = (me == 0) ? 0 : tri_lo;
+        int hi = (me == 0) ? STLdata->nTri : tri_hi;
+        for(int i = lo; i < hi; i++)
             vectorZeroize3D(STLdata->f_tri[i]);
+        reduced_step = -1;
+    }
+
+    // only triangles touched since last reduction carry local forces
+
+    for(int k = 0; k < ntouched; k++)
+        vectorZeroize3D(STLdata->f_tri[touched[k]]);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -126,6 +187,11 @@ void FixMeshGranAnalyze::add_particle_contribution(double *frc,double* contactPo
     if(!(atom->mask[ip] & groupbit)) return;
 
     // add contribution to triangle force
+    if(!touchflag[iTri])
+    {
+        touchflag[iTri] = 1;
+        touched[ntouched++] = iTri;
+    }
     vectorAdd3D(STLdata->f_tri[iTri],frc,STLdata->f_tri[iTri]);
 
     // add contribution to total body force and torque
@@ -182,45 +248,173 @@ void FixMeshGranAnalyze::final_integrate()
 
 void FixMeshGranAnalyze::calc_total_force()
 {
-    int nTri = STLdata->nTri;
-
     //total force and torque on mesh
     MyMPI::My_MPI_Sum_Vector(force_total,3,world);
     MyMPI::My_MPI_Sum_Vector(torque_total,3,world);
 
+    // per-triangle forces and wear are reduced when output is written
+    //   or when another consumer asks for them via reduce_tri_data()
+    // wear increments keep accumulating locally until then
+
+    if(update->ntimestep == output->next) reduce_tri();
+}
+
+/* ----------------------------------------------------------------------
+   make per-triangle force, pressure/shear and wear current
+     for the owned block on each proc and for all triangles on proc 0
+   collective, call on all procs after final_integrate() of this step
+   done automatically on steps output is written, other consumers
+     of STLdata->f_tri, fn_fshear or wear must call this first
+------------------------------------------------------------------------- */
+
+void FixMeshGranAnalyze::reduce_tri_data()
+{
+    if(reduced_step == update->ntimestep) return;
+    reduce_tri();
+}
+
+/* ----------------------------------------------------------------------
+   send force and wear increment of touched triangles to owning proc
+   owner sums its block and computes pressure and shear force,
+     then blocks are gathered on proc 0 for output
+------------------------------------------------------------------------- */
+
+void FixMeshGranAnalyze::reduce_tri()
+{
+    double **f_tri = STLdata->f_tri;
+    double **fn_fshear = STLdata->fn_fshear;
     double *wear = STLdata->wear;
     double *wear_step = STLdata->wear_step;
-    double *wear_step_all = new double[nTri];
-    MPI_Allreduce(wear_step,wear_step_all,nTri, MPI_DOUBLE, MPI_SUM,world);
+    int nTri = STLdata->nTri;
+    int i,k,m,iproc;
+    double temp[3];
+
+    // send buffer holds 5 values per touched triangle or 6 per owned one
 
-    for(int i=0;i<nTri;i++)
+    int nsend = MAX(5*ntouched,6*(tri_hi-tri_lo));
+    if(nsend > maxsend)
     {
-        wear[i] += wear_step_all[i];
+        maxsend = nsend;
+        memory->destroy(buf_send);
+        memory->create(buf_send,maxsend,"FixMeshGranAnalyze:buf_send");
+    }
+
+    // pack and clear local contributions
+
+    m = 0;
+    for(k = 0; k < ntouched; k++)
+    {
+        i = touched[k];
+        proclist[k] = tri_owner(i);
+        buf_send[m++] = static_cast<double>(i);
+        buf_send[m++] = f_tri[i][0];
+        buf_send[m++] = f_tri[i][1];
+        buf_send[m++] = f_tri[i][2];
+        buf_send[m++] = wear_step[i];
+
+        touchflag[i] = 0;
         wear_step[i] = 0.;
+        vectorZeroize3D(f_tri[i]);
     }
-    delete []wear_step_all;
 
-    //forces on tri
+    // my block accumulates the contributions of all procs
 
-    MPI_Allreduce(&(STLdata->f_tri[0][0]),&(STLdata->fn_fshear[0][0]),3*nTri, MPI_DOUBLE, MPI_SUM,world);
+    for(i = tri_lo; i < tri_hi; i++)
+        vectorZeroize3D(f_tri[i]);
 
-    //switch fn_fshear and f_tri
-    double **helper;
-    helper=STLdata->f_tri;
-    STLdata->f_tri=STLdata->fn_fshear;
-    STLdata->fn_fshear=helper;
+    // only proc 0 receives the gathered blocks
 
-    double temp[3];
-    double p,s;
-    for(int i=0;i<nTri;i++)
+    Irregular *irregular = new Irregular(lmp);
+    int nrecv = 5*irregular->create_data(ntouched,proclist);
+    int nrecvmax = (me == 0) ? MAX(nrecv,6*nTri) : nrecv;
+    if(nrecvmax > maxrecv)
+    {
+        maxrecv = nrecvmax;
+        memory->destroy(buf_recv);
+        memory->create(buf_recv,maxrecv,"FixMeshGranAnalyze:buf_recv");
+    }
+    irregular->exchange_data((char *) buf_send,5*sizeof(double),(char *) buf_recv);
+    irregular->destroy_data();
+    delete irregular;
+    ntouched = 0;
+
+    // accumulate into my block
+
+    for(m = 0; m < nrecv; m += 5)
+    {
+        i = static_cast<int>(buf_recv[m]);
+        f_tri[i][0] += buf_recv[m+1];
+        f_tri[i][1] += buf_recv[m+2];
+        f_tri[i][2] += buf_recv[m+3];
+        wear[i] += buf_recv[m+4];
+    }
+
+    // pressure and shear force of my block
+
+    m = 0;
+    for(i = tri_lo; i < tri_hi; i++)
     {
         //pressure
-        STLdata->fn_fshear[i][0]=vectorDot3D(STLdata->f_tri[i],STLdata->facenormal[i]);
-        vectorScalarMult3D(STLdata->facenormal[i],STLdata->fn_fshear[i][0],temp);
-        vectorSubtract3D(STLdata->f_tri[i],temp,temp);
+        fn_fshear[i][0]=vectorDot3D(f_tri[i],STLdata->facenormal[i]);
+        vectorScalarMult3D(STLdata->facenormal[i],fn_fshear[i][0],temp);
+        vectorSubtract3D(f_tri[i],temp,temp);
         //shear force
-        STLdata->fn_fshear[i][1]=vectorMag3D(temp);
+        fn_fshear[i][1]=vectorMag3D(temp);
+
+        buf_send[m++] = f_tri[i][0];
+        buf_send[m++] = f_tri[i][1];
+        buf_send[m++] = f_tri[i][2];
+        buf_send[m++] = wear[i];
+        buf_send[m++] = fn_fshear[i][0];
+        buf_send[m++] = fn_fshear[i][1];
+    }
+
+    // gather owned blocks on proc 0 for output
+
+    for(iproc = 0; iproc < nprocs; iproc++)
+    {
+        recvcounts[iproc] = 6*(tri_first(iproc+1) - tri_first(iproc));
+        rdispls[iproc] = 6*tri_first(iproc);
     }
+
+    MPI_Gatherv(buf_send,m,MPI_DOUBLE,buf_recv,recvcounts,rdispls,MPI_DOUBLE,0,world);
+
+    if(me == 0)
+    {
+        m = 0;
+        for(i = 0; i < nTri; i++)
+        {
+            f_tri[i][0] = buf_recv[m++];
+            f_tri[i][1] = buf_recv[m++];
+            f_tri[i][2] = buf_recv[m++];
+            wear[i] = buf_recv[m++];
+            fn_fshear[i][0] = buf_recv[m++];
+            fn_fshear[i][1] = buf_recv[m++];
+        }
+    }
+
+    reduced_step = update->ntimestep;
+}
+
+/* ----------------------------------------------------------------------
+   first triangle owned by proc iproc, nTri for iproc = nprocs
+------------------------------------------------------------------------- */
+
+int FixMeshGranAnalyze::tri_first(int iproc)
+{
+    return static_cast<int>(static_cast<bigint>(iproc) * STLdata->nTri / nprocs);
+}
+
+/* ----------------------------------------------------------------------
+   proc owning triangle iTri
+------------------------------------------------------------------------- */
+
+int FixMeshGranAnalyze::tri_owner(int iTri)
+{
+    int iproc = static_cast<int>(static_cast<bigint>(iTri) * nprocs / STLdata->nTri);
+    while(iproc < nprocs-1 && tri_first(iproc+1) <= iTri) iproc++;
+    while(iproc > 0 && tri_first(iproc) > iTri) iproc--;
+    return iproc;
 }
 
 /* ----------------------------------------------------------------------
@@ -233,3 +427,12 @@ double FixMeshGranAnalyze::compute_vector(int n)
   if(n<3) return force_total[n];
   else    return torque_total[n-3];
 }
+
+/* ---------------------------------------------------------------------- */
+
+double FixMeshGranAnalyze::memory_usage()
+{
+  double bytes = 3.0*maxtri * sizeof(int);
+  bytes += (maxsend + maxrecv) * sizeof(double);
+  return bytes;
+}
@@ -46,13 +46,37 @@ class FixMeshGranAnalyze : public FixMeshGran {
   virtual int write_restart_sub(FILE * fp,int n){return n;}
   virtual void restart_sub(char *){}
   double compute_vector(int);
+  double memory_usage();
+  void reduce_tri_data();
 
  protected:
 
   int finnie_flag;
   double const* const* k_finnie;
 
+  // triangles touched since last reduction, flagged in touchflag
+  // each proc sums a contiguous block tri_lo to tri_hi-1,
+  //   which is then gathered on proc 0 for output
+  // per-triangle data is only current on step reduced_step,
+  //   for the owned block on each proc and for all triangles on proc 0
+
+  int me,nprocs;
+  int maxtri;
+  int *touchflag;
+  int *touched;
+  int *proclist;
+  int ntouched;
+  int tri_lo,tri_hi;
+  bigint reduced_step;
+
+  int *recvcounts,*rdispls;
+  int maxsend,maxrecv;
+  double *buf_send,*buf_recv;
+
   void calc_total_force();
+  void reduce_tri();
+  int tri_owner(int);
+  int tri_first(int);
   virtual int n_children(){return 0;}
   virtual void children_write(FILE* fp) {}
   virtual void children_restart(double *){}
@@ -37,6 +37,7 @@ FixNVESphere::FixNVESphere(LAMMPS *lmp, int narg, char **arg) :
   if (narg < 3) error->all(FLERR,"Illegal fix nve/sphere command");
 
   time_integrate = 1;
+  fuse_flag = 1;
 
   // process extra keywords
 
@@ -145,6 +146,13 @@ void FixNVESphere::initial_integrate(int vflag)
 /* ---------------------------------------------------------------------- */
 
 void FixNVESphere::final_integrate()
+{
+  final_integrate_range(0,atom->nlocal);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixNVESphere::final_integrate_range(int ifirst, int ilast)
 {
   double dtfm,dtirotate;
 
@@ -155,8 +163,7 @@ void FixNVESphere::final_integrate()
   double *rmass = atom->rmass;
   double *radius = atom->radius;
   int *mask = atom->mask;
-  int nlocal = atom->nlocal;
-  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+  if (igroup == atom->firstgroup) ilast = MIN(ilast,atom->nfirst);
 
   // set timestep here since dt may have changed or come via rRESPA
 
@@ -165,7 +172,7 @@ void FixNVESphere::final_integrate()
   // update v,omega for all particles
   // d_omega/dt = torque / inertia
 
-  for (int i = 0; i < nlocal; i++)
+  for (int i = ifirst; i < ilast; i++)
     if (mask[i] & groupbit) {
       dtfm = dtf / rmass[i];
       v[i][0] += dtfm * f[i][0];
@@ -31,6 +31,7 @@ class FixNVESphere : public FixNVE {
   void init();
   virtual void initial_integrate(int);
   virtual void final_integrate();
+  void final_integrate_range(int, int);
 
  protected:
   int extra;
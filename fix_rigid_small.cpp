@@ -0,0 +1,1782 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_rigid_small.h"
+#include "math_extra.h"
+#include "atom.h"
+#include "domain.h"
+#include "update.h"
+#include "modify.h"
+#include "group.h"
+#include "comm.h"
+#include "irregular.h"
+#include "random_mars.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+#define TOLERANCE 1.0e-6
+#define EPSILON 1.0e-7
+#define DELTA_BODY 1024
+
+#define SINERTIA 0.4            // moment of inertia prefactor for sphere
+
+enum{FULL_BODY,INITIAL,FINAL,FORCE_TORQUE,MOMENTUM_FORCE,ANGMOM_TORQUE,
+     BODYMASS};
+
+// datums sent to and from the rendezvous proc of each molecule
+//   when bodies are created
+
+struct InRvous {
+  int proc,ilocal,molecule,tag,image;
+  double mass,radius,x[3];
+};
+
+struct OutRvous {
+  int ilocal,bodytag,owner,natoms;
+  double displace[3];
+  double mass,xcm[3],inertia[3],ex[3],ey[3],ez[3],quat[4];
+};
+
+// datums sent to the rendezvous proc of each body by dof()
+
+struct DofRvous {
+  int bodytag,npoint,nfinite,natoms,linear;
+};
+
+/* ----------------------------------------------------------------------
+   comparison functions for qsort() of rendezvous datums
+------------------------------------------------------------------------- */
+
+static int compare_molecule(const void *iptr, const void *jptr)
+{
+  const InRvous *i = (const InRvous *) iptr;
+  const InRvous *j = (const InRvous *) jptr;
+  if (i->molecule < j->molecule) return -1;
+  if (i->molecule > j->molecule) return 1;
+  if (i->tag < j->tag) return -1;
+  if (i->tag > j->tag) return 1;
+  return 0;
+}
+
+static int compare_bodytag(const void *iptr, const void *jptr)
+{
+  const DofRvous *i = (const DofRvous *) iptr;
+  const DofRvous *j = (const DofRvous *) jptr;
+  if (i->bodytag < j->bodytag) return -1;
+  if (i->bodytag > j->bodytag) return 1;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixRigidSmall::FixRigidSmall(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  int i;
+
+  scalar_flag = 1;
+  extscalar = 0;
+  global_freq = 1;
+  time_integrate = 1;
+  rigid_flag = 1;
+  virial_flag = 1;
+  create_attribute = 1;
+  comm_forward = 23;
+  comm_reverse = 6;
+
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  // each molecule in fix group is a rigid body
+
+  if (narg < 4) error->all(FLERR,"Illegal fix rigid/small command");
+  if (strcmp(arg[3],"molecule") != 0)
+    error->all(FLERR,"Illegal fix rigid/small command");
+  if (atom->molecule_flag == 0)
+    error->all(FLERR,"Fix rigid/small requires atom attribute molecule");
+  if (atom->map_style == 0)
+    error->all(FLERR,"Fix rigid/small requires an atom map, see atom_modify");
+  if (atom->ellipsoid_flag || atom->line_flag || atom->tri_flag ||
+      atom->mu_flag)
+    error->all(FLERR,"Fix rigid/small does not support ellipsoid, "
+	       "line, tri or dipole particles");
+
+  // parse optional args
+
+  int seed;
+  langflag = 0;
+
+  int iarg = 4;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"langevin") == 0) {
+      if (iarg+5 > narg) error->all(FLERR,"Illegal fix rigid/small command");
+      langflag = 1;
+      t_start = atof(arg[iarg+1]);
+      t_stop = atof(arg[iarg+2]);
+      t_period = atof(arg[iarg+3]);
+      seed = atoi(arg[iarg+4]);
+      if (t_period <= 0.0)
+	error->all(FLERR,"Fix rigid/small langevin period must be > 0.0");
+      if (seed <= 0) error->all(FLERR,"Illegal fix rigid/small command");
+      iarg += 5;
+    } else error->all(FLERR,"Illegal fix rigid/small command");
+  }
+
+  // initialize Marsaglia RNG with processor-unique seed
+
+  if (langflag) random = new RanMars(lmp,seed + me);
+  else random = NULL;
+
+  // force/torque flags, for 2d: fz, tx, ty = 0.0
+
+  fflag[0] = fflag[1] = fflag[2] = 1.0;
+  tflag[0] = tflag[1] = tflag[2] = 1.0;
+  if (domain->dimension == 2) fflag[2] = tflag[0] = tflag[1] = 0.0;
+
+  // perform initial allocation of atom-based arrays
+  // register with Atom class
+
+  bodies = NULL;
+  nlocal_body = nghost_body = nmax_body = 0;
+
+  bodytag = NULL;
+  bodyown = NULL;
+  atom2body = NULL;
+  bodymass = NULL;
+  displace = NULL;
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+
+  // extended = 1 if any particle in a rigid body is a finite-size sphere
+
+  double *radius = atom->radius;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  int flag = 0;
+  if (atom->radius_flag)
+    for (i = 0; i < nlocal; i++)
+      if ((mask[i] & groupbit) && radius[i] > 0.0) flag = 1;
+  MPI_Allreduce(&flag,&extended,1,MPI_INT,MPI_MAX,world);
+
+  // create the bodies and assign each to the proc of its owning atom
+
+  create_bodies();
+
+  // print statistics
+
+  int nbody,nsum;
+  int one = 0;
+  for (i = 0; i < nlocal; i++)
+    if (bodytag[i]) one++;
+  MPI_Allreduce(&nlocal_body,&nbody,1,MPI_INT,MPI_SUM,world);
+  MPI_Allreduce(&one,&nsum,1,MPI_INT,MPI_SUM,world);
+
+  if (nbody == 0) error->all(FLERR,"No rigid bodies defined");
+
+  if (me == 0) {
+    if (screen) fprintf(screen,"%d rigid bodies with %d atoms\n",nbody,nsum);
+    if (logfile) fprintf(logfile,"%d rigid bodies with %d atoms\n",nbody,nsum);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixRigidSmall::~FixRigidSmall()
+{
+  // unregister callbacks to this fix from Atom class
+
+  atom->delete_callback(id,0);
+
+  delete random;
+
+  // delete locally stored arrays
+
+  memory->destroy(bodytag);
+  memory->destroy(bodyown);
+  memory->destroy(atom2body);
+  memory->destroy(bodymass);
+  memory->destroy(displace);
+  memory->sfree(bodies);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixRigidSmall::setmask()
+{
+  int mask = 0;
+  mask |= INITIAL_INTEGRATE;
+  mask |= FINAL_INTEGRATE;
+  if (langflag) mask |= POST_FORCE;
+  mask |= PRE_NEIGHBOR;
+  mask |= PRE_FORCE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::init()
+{
+  int i;
+
+  triclinic = domain->triclinic;
+
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Fix rigid/small does not support run_style respa");
+
+  // error if npt,nph fix comes before rigid fix
+
+  for (i = 0; i < modify->nfix; i++) {
+    if (strcmp(modify->fix[i]->style,"npt") == 0) break;
+    if (strcmp(modify->fix[i]->style,"nph") == 0) break;
+  }
+  if (i < modify->nfix) {
+    for (int j = i; j < modify->nfix; j++)
+      if (strcmp(modify->fix[j]->style,"rigid/small") == 0)
+	error->all(FLERR,"Rigid fix must come before NPT/NPH fix");
+  }
+
+  // timestep info
+
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+  dtq = 0.5 * update->dt;
+
+  // temperature scale factor
+
+  int nbody;
+  MPI_Allreduce(&nlocal_body,&nbody,1,MPI_INT,MPI_SUM,world);
+
+  double ndof = fflag[0] + fflag[1] + fflag[2] + tflag[0] + tflag[1] + tflag[2];
+  ndof *= nbody;
+  if (ndof > 0.0) tfactor = force->mvv2e / (ndof * force->boltz);
+  else tfactor = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   compute the static properties of each body via a rendezvous
+   all atoms of a molecule are sent to proc = molecule ID % nprocs,
+     which computes mass, center-of-mass and principal axes
+   each atom is sent back its displacement in body coords
+   the atom with the lowest ID owns the body and is sent its properties
+   no proc stores values for all bodies
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::create_bodies()
+{
+  int i,m,n,first,last;
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  int *image = atom->image;
+  int *molecule = atom->molecule;
+  int *mask = atom->mask;
+  int *tag = atom->tag;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  // error if image flag is not 0 in a non-periodic dim
+
+  int *periodicity = domain->periodicity;
+  int xbox,ybox,zbox;
+  int ncount = 0;
+
+  for (i = 0; i < nlocal; i++) {
+    bodytag[i] = 0;
+    bodyown[i] = atom2body[i] = -1;
+    bodymass[i] = 0.0;
+    displace[i][0] = displace[i][1] = displace[i][2] = 0.0;
+    if (!(mask[i] & groupbit)) continue;
+
+    xbox = (image[i] & 1023) - 512;
+    ybox = (image[i] >> 10 & 1023) - 512;
+    zbox = (image[i] >> 20) - 512;
+    if ((xbox && !periodicity[0]) || (ybox && !periodicity[1]) ||
+	(zbox && !periodicity[2]))
+      error->one(FLERR,"Fix rigid/small atom has non-zero image flag "
+		 "in a non-periodic dimension");
+    ncount++;
+  }
+
+  // send each atom in a body to the rendezvous proc of its molecule
+
+  InRvous *inbuf = (InRvous *)
+    memory->smalloc(ncount*sizeof(InRvous),"rigid/small:inbuf");
+  int *proclist;
+  memory->create(proclist,ncount,"rigid/small:proclist");
+
+  m = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    proclist[m] = molecule[i] % nprocs;
+    inbuf[m].proc = me;
+    inbuf[m].ilocal = i;
+    inbuf[m].molecule = molecule[i];
+    inbuf[m].tag = tag[i];
+    inbuf[m].image = image[i];
+    if (rmass) inbuf[m].mass = rmass[i];
+    else inbuf[m].mass = mass[type[i]];
+    if (extended) inbuf[m].radius = radius[i];
+    else inbuf[m].radius = 0.0;
+    inbuf[m].x[0] = x[i][0];
+    inbuf[m].x[1] = x[i][1];
+    inbuf[m].x[2] = x[i][2];
+    m++;
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+
+  int nrvous = irregular->create_data(ncount,proclist);
+  InRvous *rvous = (InRvous *)
+    memory->smalloc(nrvous*sizeof(InRvous),"rigid/small:rvous");
+  irregular->exchange_data((char *) inbuf,sizeof(InRvous),(char *) rvous);
+  irregular->destroy_data();
+
+  memory->sfree(inbuf);
+  memory->destroy(proclist);
+
+  // sort my rendezvous atoms by molecule, lowest atom ID first
+  // each contiguous run of one molecule is a body
+
+  qsort(rvous,nrvous,sizeof(InRvous),compare_molecule);
+
+  OutRvous *outbuf = (OutRvous *)
+    memory->smalloc(nrvous*sizeof(OutRvous),"rigid/small:outbuf");
+  memory->create(proclist,nrvous,"rigid/small:proclist");
+
+  int ierror;
+  double massone,masstotal,max,norm;
+  double xcm[3],inertia[3],ex[3],ey[3],ez[3],quat[4];
+  double xu[3],dx[3],cross[3],sum[6];
+  double tensor[3][3],evectors[3][3];
+
+  for (first = 0; first < nrvous; first = last) {
+    for (last = first+1; last < nrvous; last++)
+      if (rvous[last].molecule != rvous[first].molecule) break;
+    if (last-first <= 1) error->one(FLERR,"One or zero atoms in rigid body");
+
+    // masstotal & center-of-mass of body
+
+    masstotal = 0.0;
+    xcm[0] = xcm[1] = xcm[2] = 0.0;
+    for (m = first; m < last; m++) {
+      domain->unmap(rvous[m].x,rvous[m].image,xu);
+      massone = rvous[m].mass;
+      xcm[0] += xu[0] * massone;
+      xcm[1] += xu[1] * massone;
+      xcm[2] += xu[2] * massone;
+      masstotal += massone;
+    }
+    xcm[0] /= masstotal;
+    xcm[1] /= masstotal;
+    xcm[2] /= masstotal;
+
+    // 6 moments of inertia, spheres add their own inertia
+
+    for (i = 0; i < 6; i++) sum[i] = 0.0;
+    for (m = first; m < last; m++) {
+      domain->unmap(rvous[m].x,rvous[m].image,xu);
+      dx[0] = xu[0] - xcm[0];
+      dx[1] = xu[1] - xcm[1];
+      dx[2] = xu[2] - xcm[2];
+      massone = rvous[m].mass;
+      sum[0] += massone * (dx[1]*dx[1] + dx[2]*dx[2]);
+      sum[1] += massone * (dx[0]*dx[0] + dx[2]*dx[2]);
+      sum[2] += massone * (dx[0]*dx[0] + dx[1]*dx[1]);
+      sum[3] -= massone * dx[1]*dx[2];
+      sum[4] -= massone * dx[0]*dx[2];
+      sum[5] -= massone * dx[0]*dx[1];
+      if (rvous[m].radius > 0.0) {
+	sum[0] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+	sum[1] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+	sum[2] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+      }
+    }
+
+    // diagonalize inertia tensor via Jacobi rotations
+    // inertia = 3 principal moments, exyz = principal axes
+
+    tensor[0][0] = sum[0];
+    tensor[1][1] = sum[1];
+    tensor[2][2] = sum[2];
+    tensor[1][2] = tensor[2][1] = sum[3];
+    tensor[0][2] = tensor[2][0] = sum[4];
+    tensor[0][1] = tensor[1][0] = sum[5];
+
+    ierror = MathExtra::jacobi(tensor,inertia,evectors);
+    if (ierror) error->one(FLERR,"Insufficient Jacobi rotations for rigid body");
+
+    ex[0] = evectors[0][0];
+    ex[1] = evectors[1][0];
+    ex[2] = evectors[2][0];
+    ey[0] = evectors[0][1];
+    ey[1] = evectors[1][1];
+    ey[2] = evectors[2][1];
+    ez[0] = evectors[0][2];
+    ez[1] = evectors[1][2];
+    ez[2] = evectors[2][2];
+
+    // if any principal moment < scaled EPSILON, set to 0.0
+
+    max = MAX(inertia[0],inertia[1]);
+    max = MAX(max,inertia[2]);
+    if (inertia[0] < EPSILON*max) inertia[0] = 0.0;
+    if (inertia[1] < EPSILON*max) inertia[1] = 0.0;
+    if (inertia[2] < EPSILON*max) inertia[2] = 0.0;
+
+    // enforce 3 evectors as a right-handed coordinate system
+
+    MathExtra::cross3(ex,ey,cross);
+    if (MathExtra::dot3(cross,ez) < 0.0) MathExtra::negate3(ez);
+    MathExtra::exyz_to_q(ex,ey,ez,quat);
+
+    // displace = atom coords in basis of principal axes
+    // lowest-ID atom, which is first in the run, owns the body
+
+    for (i = 0; i < 6; i++) sum[i] = 0.0;
+
+    for (m = first; m < last; m++) {
+      domain->unmap(rvous[m].x,rvous[m].image,xu);
+      dx[0] = xu[0] - xcm[0];
+      dx[1] = xu[1] - xcm[1];
+      dx[2] = xu[2] - xcm[2];
+
+      proclist[m] = rvous[m].proc;
+      outbuf[m].ilocal = rvous[m].ilocal;
+      outbuf[m].bodytag = rvous[first].tag;
+      outbuf[m].owner = (m == first);
+      outbuf[m].natoms = last - first;
+      MathExtra::transpose_matvec(ex,ey,ez,dx,outbuf[m].displace);
+
+      if (m == first) {
+	outbuf[m].mass = masstotal;
+	memcpy(outbuf[m].xcm,xcm,3*sizeof(double));
+	memcpy(outbuf[m].inertia,inertia,3*sizeof(double));
+	memcpy(outbuf[m].ex,ex,3*sizeof(double));
+	memcpy(outbuf[m].ey,ey,3*sizeof(double));
+	memcpy(outbuf[m].ez,ez,3*sizeof(double));
+	memcpy(outbuf[m].quat,quat,4*sizeof(double));
+      }
+
+      // recompute moments of inertia around new axes as a check
+
+      double *d = outbuf[m].displace;
+      massone = rvous[m].mass;
+      sum[0] += massone * (d[1]*d[1] + d[2]*d[2]);
+      sum[1] += massone * (d[0]*d[0] + d[2]*d[2]);
+      sum[2] += massone * (d[0]*d[0] + d[1]*d[1]);
+      sum[3] -= massone * d[1]*d[2];
+      sum[4] -= massone * d[0]*d[2];
+      sum[5] -= massone * d[0]*d[1];
+      if (rvous[m].radius > 0.0) {
+	sum[0] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+	sum[1] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+	sum[2] += SINERTIA*massone * rvous[m].radius*rvous[m].radius;
+      }
+    }
+
+    // 3 diagonal moments should equal principal moments
+    // 3 off-diagonal moments should be 0.0
+
+    for (i = 0; i < 3; i++) {
+      if (inertia[i] == 0.0) {
+	if (fabs(sum[i]) > TOLERANCE)
+	  error->one(FLERR,"Fix rigid/small: Bad principal moments");
+      } else if (fabs((sum[i]-inertia[i])/inertia[i]) > TOLERANCE)
+	error->one(FLERR,"Fix rigid/small: Bad principal moments");
+    }
+    norm = (inertia[0] + inertia[1] + inertia[2]) / 3.0;
+    if (fabs(sum[3]/norm) > TOLERANCE || fabs(sum[4]/norm) > TOLERANCE ||
+	fabs(sum[5]/norm) > TOLERANCE)
+      error->one(FLERR,"Fix rigid/small: Bad principal moments");
+  }
+
+  memory->sfree(rvous);
+
+  // send results back to the proc of each atom
+
+  n = irregular->create_data(nrvous,proclist);
+  OutRvous *out = (OutRvous *)
+    memory->smalloc(n*sizeof(OutRvous),"rigid/small:out");
+  irregular->exchange_data((char *) outbuf,sizeof(OutRvous),(char *) out);
+  irregular->destroy_data();
+  delete irregular;
+
+  memory->sfree(outbuf);
+  memory->destroy(proclist);
+
+  // set per-atom body info, owning atoms create their body
+
+  Body *b;
+
+  for (m = 0; m < n; m++) {
+    i = out[m].ilocal;
+    bodytag[i] = out[m].bodytag;
+    displace[i][0] = out[m].displace[0];
+    displace[i][1] = out[m].displace[1];
+    displace[i][2] = out[m].displace[2];
+    if (!out[m].owner) continue;
+
+    bodyown[i] = nlocal_body;
+    add_body();
+    b = &bodies[bodyown[i]];
+    memset(b,0,sizeof(Body));
+    b->mass = out[m].mass;
+    memcpy(b->xcm,out[m].xcm,3*sizeof(double));
+    memcpy(b->inertia,out[m].inertia,3*sizeof(double));
+    memcpy(b->ex_space,out[m].ex,3*sizeof(double));
+    memcpy(b->ey_space,out[m].ey,3*sizeof(double));
+    memcpy(b->ez_space,out[m].ez,3*sizeof(double));
+    memcpy(b->quat,out[m].quat,4*sizeof(double));
+    b->image = (512 << 20) | (512 << 10) | 512;
+    b->natoms = out[m].natoms;
+    b->ilocal = i;
+  }
+
+  memory->sfree(out);
+}
+
+/* ----------------------------------------------------------------------
+   Verlet::setup() does not invoke pre_neighbor()
+   but it must run to remap bodies, create ghost bodies and set bodymass
+     before the setup force computation uses them
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::setup_pre_force(int vflag)
+{
+  pre_neighbor();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::setup(int vflag)
+{
+  int i,n,ibody;
+  double massone,radone;
+  double xu[3],dx,dy,dz;
+  Body *b;
+
+  // vcm = velocity of center-of-mass of each rigid body
+  // fcm = force on center-of-mass of each rigid body
+  // sum over my atoms, then reverse comm to owners of bodies
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  double *radius = atom->radius;
+  double **omega_one = atom->omega;
+  double **torque_one = atom->torque;
+  int *image = atom->image;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  int nall_body = nlocal_body + nghost_body;
+  for (ibody = 0; ibody < nall_body; ibody++) {
+    b = &bodies[ibody];
+    b->vcm[0] = b->vcm[1] = b->vcm[2] = 0.0;
+    b->fcm[0] = b->fcm[1] = b->fcm[2] = 0.0;
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+    if (rmass) massone = rmass[i];
+    else massone = mass[type[i]];
+
+    b->vcm[0] += v[i][0] * massone;
+    b->vcm[1] += v[i][1] * massone;
+    b->vcm[2] += v[i][2] * massone;
+    b->fcm[0] += f[i][0];
+    b->fcm[1] += f[i][1];
+    b->fcm[2] += f[i][2];
+  }
+
+  commflag = MOMENTUM_FORCE;
+  comm->reverse_comm_fix(this);
+
+  for (ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+    b->vcm[0] /= b->mass;
+    b->vcm[1] /= b->mass;
+    b->vcm[2] /= b->mass;
+  }
+
+  // angmom = angular momentum of each rigid body
+  // torque = torque on each rigid body
+  // extended particles add their rotation/torque to angmom/torque of body
+
+  for (ibody = 0; ibody < nall_body; ibody++) {
+    b = &bodies[ibody];
+    b->angmom[0] = b->angmom[1] = b->angmom[2] = 0.0;
+    b->torque[0] = b->torque[1] = b->torque[2] = 0.0;
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+
+    domain->unmap(x[i],image[i],xu);
+    dx = xu[0] - b->xcm[0];
+    dy = xu[1] - b->xcm[1];
+    dz = xu[2] - b->xcm[2];
+
+    if (rmass) massone = rmass[i];
+    else massone = mass[type[i]];
+
+    b->angmom[0] += dy * massone*v[i][2] - dz * massone*v[i][1];
+    b->angmom[1] += dz * massone*v[i][0] - dx * massone*v[i][2];
+    b->angmom[2] += dx * massone*v[i][1] - dy * massone*v[i][0];
+    b->torque[0] += dy * f[i][2] - dz * f[i][1];
+    b->torque[1] += dz * f[i][0] - dx * f[i][2];
+    b->torque[2] += dx * f[i][1] - dy * f[i][0];
+
+    if (extended && radius[i] > 0.0) {
+      radone = radius[i];
+      b->angmom[0] += SINERTIA*rmass[i] * radone*radone * omega_one[i][0];
+      b->angmom[1] += SINERTIA*rmass[i] * radone*radone * omega_one[i][1];
+      b->angmom[2] += SINERTIA*rmass[i] * radone*radone * omega_one[i][2];
+      b->torque[0] += torque_one[i][0];
+      b->torque[1] += torque_one[i][1];
+      b->torque[2] += torque_one[i][2];
+    }
+  }
+
+  commflag = ANGMOM_TORQUE;
+  comm->reverse_comm_fix(this);
+
+  // zero langextra in case Langevin thermostat not used
+  // no point to calling post_force() here since langextra
+  //   is only added to fcm/torque in final_integrate()
+
+  for (ibody = 0; ibody < nlocal_body; ibody++)
+    for (i = 0; i < 6; i++) bodies[ibody].langextra[i] = 0.0;
+
+  // virial setup before call to set_v
+
+  if (vflag) v_setup(vflag);
+  else evflag = 0;
+
+  // set velocities from angmom & omega
+  // ghost bodies get vcm and omega from their owners
+
+  for (ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+    MathExtra::angmom_to_omega(b->angmom,b->ex_space,b->ey_space,
+			       b->ez_space,b->inertia,b->omega);
+  }
+
+  commflag = FINAL;
+  comm->forward_comm_fix(this);
+
+  set_v();
+
+  // guesstimate virial as 2x the set_v contribution
+
+  if (vflag_global)
+    for (n = 0; n < 6; n++) virial[n] *= 2.0;
+  if (vflag_atom) {
+    for (i = 0; i < nlocal; i++)
+      for (n = 0; n < 6; n++)
+	vatom[i][n] *= 2.0;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::initial_integrate(int vflag)
+{
+  double dtfm;
+  Body *b;
+
+  for (int ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+
+    // update vcm by 1/2 step
+
+    dtfm = dtf / b->mass;
+    b->vcm[0] += dtfm * b->fcm[0] * fflag[0];
+    b->vcm[1] += dtfm * b->fcm[1] * fflag[1];
+    b->vcm[2] += dtfm * b->fcm[2] * fflag[2];
+
+    // update xcm by full step
+
+    b->xcm[0] += dtv * b->vcm[0];
+    b->xcm[1] += dtv * b->vcm[1];
+    b->xcm[2] += dtv * b->vcm[2];
+
+    // update angular momentum by 1/2 step
+
+    b->angmom[0] += dtf * b->torque[0] * tflag[0];
+    b->angmom[1] += dtf * b->torque[1] * tflag[1];
+    b->angmom[2] += dtf * b->torque[2] * tflag[2];
+
+    // compute omega at 1/2 step from angmom at 1/2 step and current q
+    // update quaternion a full step via Richardson iteration
+    // returns new normalized quaternion, also updated omega at 1/2 step
+    // update ex,ey,ez to reflect new quaternion
+
+    MathExtra::angmom_to_omega(b->angmom,b->ex_space,b->ey_space,
+			       b->ez_space,b->inertia,b->omega);
+    MathExtra::richardson(b->quat,b->angmom,b->omega,b->inertia,dtq);
+    MathExtra::q_to_exyz(b->quat,b->ex_space,b->ey_space,b->ez_space);
+  }
+
+  // ghost bodies get new positions and orientations from their owners
+
+  commflag = INITIAL;
+  comm->forward_comm_fix(this);
+
+  // virial setup before call to set_xv
+
+  if (vflag) v_setup(vflag);
+  else evflag = 0;
+
+  // set coords/orient and velocity/rotation of atoms in rigid bodies
+  // from quarternion and omega
+
+  set_xv();
+}
+
+/* ----------------------------------------------------------------------
+   apply Langevin thermostat to all 6 DOF of rigid bodies I own
+   unlike fix langevin, this stores extra force in extra arrays,
+     which are added in when final_integrate() calculates a new fcm/torque
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::post_force(int vflag)
+{
+  double gamma1,gamma2;
+  Body *b;
+
+  double delta = update->ntimestep - update->beginstep;
+  delta /= update->endstep - update->beginstep;
+  double t_target = t_start + delta * (t_stop-t_start);
+  double tsqrt = sqrt(t_target);
+
+  double boltz = force->boltz;
+  double dt = update->dt;
+  double mvv2e = force->mvv2e;
+  double ftm2v = force->ftm2v;
+
+  for (int ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+
+    gamma1 = -b->mass / t_period / ftm2v;
+    gamma2 = sqrt(b->mass) * tsqrt *
+      sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
+    b->langextra[0] = gamma1*b->vcm[0] + gamma2*(random->uniform()-0.5);
+    b->langextra[1] = gamma1*b->vcm[1] + gamma2*(random->uniform()-0.5);
+    b->langextra[2] = gamma1*b->vcm[2] + gamma2*(random->uniform()-0.5);
+
+    gamma1 = -1.0 / t_period / ftm2v;
+    gamma2 = tsqrt * sqrt(24.0*boltz/t_period/dt/mvv2e) / ftm2v;
+    b->langextra[3] = b->inertia[0]*gamma1*b->omega[0] +
+      sqrt(b->inertia[0])*gamma2*(random->uniform()-0.5);
+    b->langextra[4] = b->inertia[1]*gamma1*b->omega[1] +
+      sqrt(b->inertia[1])*gamma2*(random->uniform()-0.5);
+    b->langextra[5] = b->inertia[2]*gamma1*b->omega[2] +
+      sqrt(b->inertia[2])*gamma2*(random->uniform()-0.5);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::final_integrate()
+{
+  int i,ibody;
+  double dtfm;
+  double xu[3],dx,dy,dz;
+  Body *b;
+
+  // sum over my atoms to get force and torque on rigid body
+  // contributions to ghost bodies are summed to owners by reverse comm
+
+  double **x = atom->x;
+  double **f = atom->f;
+  double *radius = atom->radius;
+  double **torque_one = atom->torque;
+  int *image = atom->image;
+  int nlocal = atom->nlocal;
+
+  int nall_body = nlocal_body + nghost_body;
+  for (ibody = 0; ibody < nall_body; ibody++) {
+    b = &bodies[ibody];
+    b->fcm[0] = b->fcm[1] = b->fcm[2] = 0.0;
+    b->torque[0] = b->torque[1] = b->torque[2] = 0.0;
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+
+    b->fcm[0] += f[i][0];
+    b->fcm[1] += f[i][1];
+    b->fcm[2] += f[i][2];
+
+    domain->unmap(x[i],image[i],xu);
+    dx = xu[0] - b->xcm[0];
+    dy = xu[1] - b->xcm[1];
+    dz = xu[2] - b->xcm[2];
+
+    b->torque[0] += dy*f[i][2] - dz*f[i][1];
+    b->torque[1] += dz*f[i][0] - dx*f[i][2];
+    b->torque[2] += dx*f[i][1] - dy*f[i][0];
+
+    // extended particles add their torque to torque of body
+
+    if (extended && radius[i] > 0.0) {
+      b->torque[0] += torque_one[i][0];
+      b->torque[1] += torque_one[i][1];
+      b->torque[2] += torque_one[i][2];
+    }
+  }
+
+  commflag = FORCE_TORQUE;
+  comm->reverse_comm_fix(this);
+
+  // update vcm and angmom of bodies I own
+  // include Langevin thermostat forces
+  // fflag,tflag = 0 for some dimensions in 2d
+
+  for (ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+
+    b->fcm[0] += b->langextra[0];
+    b->fcm[1] += b->langextra[1];
+    b->fcm[2] += b->langextra[2];
+    b->torque[0] += b->langextra[3];
+    b->torque[1] += b->langextra[4];
+    b->torque[2] += b->langextra[5];
+
+    // update vcm by 1/2 step
+
+    dtfm = dtf / b->mass;
+    b->vcm[0] += dtfm * b->fcm[0] * fflag[0];
+    b->vcm[1] += dtfm * b->fcm[1] * fflag[1];
+    b->vcm[2] += dtfm * b->fcm[2] * fflag[2];
+
+    // update angular momentum by 1/2 step
+
+    b->angmom[0] += dtf * b->torque[0] * tflag[0];
+    b->angmom[1] += dtf * b->torque[1] * tflag[1];
+    b->angmom[2] += dtf * b->torque[2] * tflag[2];
+
+    MathExtra::angmom_to_omega(b->angmom,b->ex_space,b->ey_space,
+			       b->ez_space,b->inertia,b->omega);
+  }
+
+  // ghost bodies get vcm and omega from their owners
+
+  commflag = FINAL;
+  comm->forward_comm_fix(this);
+
+  // set velocity/rotation of atoms in rigid bodies
+  // virial is already setup from initial_integrate
+
+  set_v();
+}
+
+/* ----------------------------------------------------------------------
+   remap xcm of each body I own back into periodic simulation box
+   done during pre_neighbor so will be after call to pbc()
+     and after fix_deform::pre_exchange() may have flipped box
+   then create ghost bodies and find the body of each of my atoms
+   adjust image flags of all atoms in a remapped body
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::pre_neighbor()
+{
+  int original,oldimage,newimage;
+  Body *b;
+
+  for (int ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+    original = b->image;
+    domain->remap(b->xcm,b->image);
+
+    oldimage = original & 1023;
+    newimage = b->image & 1023;
+    b->remap[0] = newimage - oldimage;
+    oldimage = (original >> 10) & 1023;
+    newimage = (b->image >> 10) & 1023;
+    b->remap[1] = newimage - oldimage;
+    oldimage = original >> 20;
+    newimage = b->image >> 20;
+    b->remap[2] = newimage - oldimage;
+  }
+
+  // ghost copies of owning atoms create ghost copies of their bodies
+
+  nghost_body = 0;
+  commflag = FULL_BODY;
+  comm->forward_comm_fix(this);
+
+  reset_atom2body();
+
+  // mass of body each owned and ghost atom is in, for granular pair styles
+
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) bodymass[i] = 0.0;
+    else bodymass[i] = bodies[atom2body[i]].mass;
+  }
+
+  commflag = BODYMASS;
+  comm->forward_comm_fix(this);
+
+  // adjust image flags of any atom in a rigid body whose xcm was remapped
+
+  int *image = atom->image;
+
+  int idim,otherdims;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+
+    if (b->remap[0]) {
+      idim = image[i] & 1023;
+      otherdims = image[i] ^ idim;
+      idim -= b->remap[0];
+      idim &= 1023;
+      image[i] = otherdims | idim;
+    }
+    if (b->remap[1]) {
+      idim = (image[i] >> 10) & 1023;
+      otherdims = image[i] ^ (idim << 10);
+      idim -= b->remap[1];
+      idim &= 1023;
+      image[i] = otherdims | (idim << 10);
+    }
+    if (b->remap[2]) {
+      idim = image[i] >> 20;
+      otherdims = image[i] ^ (idim << 20);
+      idim -= b->remap[2];
+      idim &= 1023;
+      image[i] = otherdims | (idim << 20);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set atom2body for each of my atoms in a body
+   the owning atom must be known as an owned or ghost atom
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::reset_atom2body()
+{
+  int m;
+  int nlocal = atom->nlocal;
+
+  int flag = 0;
+  for (int i = 0; i < nlocal; i++) {
+    atom2body[i] = -1;
+    if (bodytag[i] == 0) continue;
+    m = atom->map(bodytag[i]);
+    if (m < 0 || bodyown[m] < 0) flag = 1;
+    else atom2body[i] = bodyown[m];
+  }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) error->all(FLERR,"Rigid body atoms missing at pre_neighbor");
+}
+
+/* ----------------------------------------------------------------------
+   count # of degrees-of-freedom removed by fix_rigid for atoms in igroup
+   per-body counts are summed on the rendezvous proc bodytag % nprocs
+------------------------------------------------------------------------- */
+
+int FixRigidSmall::dof(int igroup)
+{
+  int i,m,first,last;
+
+  int groupbit = group->bitmask[igroup];
+
+  double *radius = atom->radius;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  // one datum per atom in a body
+  // owning atom adds size and linearity of its body
+
+  int ncount = 0;
+  for (i = 0; i < nlocal; i++)
+    if (bodytag[i]) ncount++;
+
+  DofRvous *inbuf = (DofRvous *)
+    memory->smalloc(ncount*sizeof(DofRvous),"rigid/small:inbuf");
+  int *proclist;
+  memory->create(proclist,ncount,"rigid/small:proclist");
+
+  Body *b;
+  m = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (bodytag[i] == 0) continue;
+    proclist[m] = bodytag[i] % nprocs;
+    inbuf[m].bodytag = bodytag[i];
+    inbuf[m].npoint = inbuf[m].nfinite = 0;
+    if (mask[i] & groupbit) {
+      if (extended && radius[i] > 0.0) inbuf[m].nfinite = 1;
+      else inbuf[m].npoint = 1;
+    }
+    inbuf[m].natoms = inbuf[m].linear = 0;
+    if (bodyown[i] >= 0) {
+      b = &bodies[bodyown[i]];
+      inbuf[m].natoms = b->natoms;
+      if (b->inertia[0] == 0.0 || b->inertia[1] == 0.0 ||
+	  b->inertia[2] == 0.0) inbuf[m].linear = 1;
+    }
+    m++;
+  }
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrvous = irregular->create_data(ncount,proclist);
+  DofRvous *rvous = (DofRvous *)
+    memory->smalloc(nrvous*sizeof(DofRvous),"rigid/small:rvous");
+  irregular->exchange_data((char *) inbuf,sizeof(DofRvous),(char *) rvous);
+  irregular->destroy_data();
+  delete irregular;
+
+  memory->sfree(inbuf);
+  memory->destroy(proclist);
+
+  qsort(rvous,nrvous,sizeof(DofRvous),compare_bodytag);
+
+  // remove appropriate DOFs for each rigid body wholly in temperature group
+  // N = # of point particles in body
+  // M = # of finite-size particles in body
+  // 3d body has 3N + 6M dof to start with
+  // 2d body has 2N + 3M dof to start with
+  // 3d point-particle body with all non-zero I should have 6 dof, remove 3N-6
+  // 3d point-particle body (linear) with a 0 I should have 5 dof, remove 3N-5
+  // 2d point-particle body should have 3 dof, remove 2N-3
+  // 3d body with any finite-size M should have 6 dof, remove (3N+6M) - 6
+  // 2d body with any finite-size M should have 3 dof, remove (2N+3M) - 3
+
+  int nall,mall,natoms,linear;
+  int n = 0;
+  int flag = 0;
+
+  for (first = 0; first < nrvous; first = last) {
+    nall = mall = natoms = linear = 0;
+    for (last = first; last < nrvous; last++) {
+      if (rvous[last].bodytag != rvous[first].bodytag) break;
+      nall += rvous[last].npoint;
+      mall += rvous[last].nfinite;
+      natoms += rvous[last].natoms;
+      linear += rvous[last].linear;
+    }
+
+    if (nall+mall == 0) continue;
+    if (nall+mall != natoms) {
+      flag = 1;
+      continue;
+    }
+    if (domain->dimension == 3) {
+      n += 3*nall + 6*mall - 6;
+      if (linear) n++;
+    } else n += 2*nall + 3*mall - 3;
+  }
+
+  memory->sfree(rvous);
+
+  // warn if nall+mall != natoms for any body included in temperature group
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall && me == 0)
+    error->warning(FLERR,"Computing temperature of portions of rigid bodies");
+
+  int nsum;
+  MPI_Allreduce(&n,&nsum,1,MPI_INT,MPI_SUM,world);
+  return nsum;
+}
+
+/* ----------------------------------------------------------------------
+   adjust xcm of each rigid body due to box deformation
+   called by various fixes that change box size/shape
+   flag = 0/1 means map from box to lamda coords or vice versa
+   ghost bodies are mapped too, so they stay consistent with owners
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::deform(int flag)
+{
+  int nall_body = nlocal_body + nghost_body;
+
+  if (flag == 0)
+    for (int ibody = 0; ibody < nall_body; ibody++)
+      domain->x2lamda(bodies[ibody].xcm,bodies[ibody].xcm);
+  else
+    for (int ibody = 0; ibody < nall_body; ibody++)
+      domain->lamda2x(bodies[ibody].xcm,bodies[ibody].xcm);
+}
+
+/* ----------------------------------------------------------------------
+   set space-frame coords and velocity of each atom in each rigid body
+   set rotation of finite-size spheres
+   x = Q displace + Xcm, mapped back to periodic box
+   v = Vcm + (W cross (x - Xcm))
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::set_xv()
+{
+  int xbox,ybox,zbox;
+  double x0,x1,x2,v0,v1,v2,fc0,fc1,fc2,massone;
+  double xy,xz,yz;
+  double vr[6];
+  Body *b;
+
+  int *image = atom->image;
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  double *radius = atom->radius;
+  double **omega_one = atom->omega;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  double xprd = domain->xprd;
+  double yprd = domain->yprd;
+  double zprd = domain->zprd;
+
+  if (triclinic) {
+    xy = domain->xy;
+    xz = domain->xz;
+    yz = domain->yz;
+  }
+
+  // set x and v of each atom
+
+  for (int i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+
+    xbox = (image[i] & 1023) - 512;
+    ybox = (image[i] >> 10 & 1023) - 512;
+    zbox = (image[i] >> 20) - 512;
+
+    // save old positions and velocities for virial
+
+    if (evflag) {
+      if (triclinic == 0) {
+	x0 = x[i][0] + xbox*xprd;
+	x1 = x[i][1] + ybox*yprd;
+	x2 = x[i][2] + zbox*zprd;
+      } else {
+	x0 = x[i][0] + xbox*xprd + ybox*xy + zbox*xz;
+	x1 = x[i][1] + ybox*yprd + zbox*yz;
+	x2 = x[i][2] + zbox*zprd;
+      }
+      v0 = v[i][0];
+      v1 = v[i][1];
+      v2 = v[i][2];
+    }
+
+    // x = displacement from center-of-mass, based on body orientation
+    // v = vcm + omega around center-of-mass
+
+    MathExtra::matvec(b->ex_space,b->ey_space,b->ez_space,displace[i],x[i]);
+
+    v[i][0] = b->omega[1]*x[i][2] - b->omega[2]*x[i][1] + b->vcm[0];
+    v[i][1] = b->omega[2]*x[i][0] - b->omega[0]*x[i][2] + b->vcm[1];
+    v[i][2] = b->omega[0]*x[i][1] - b->omega[1]*x[i][0] + b->vcm[2];
+
+    // add center of mass to displacement
+    // map back into periodic box via xbox,ybox,zbox
+    // for triclinic, add in box tilt factors as well
+
+    if (triclinic == 0) {
+      x[i][0] += b->xcm[0] - xbox*xprd;
+      x[i][1] += b->xcm[1] - ybox*yprd;
+      x[i][2] += b->xcm[2] - zbox*zprd;
+    } else {
+      x[i][0] += b->xcm[0] - xbox*xprd - ybox*xy - zbox*xz;
+      x[i][1] += b->xcm[1] - ybox*yprd - zbox*yz;
+      x[i][2] += b->xcm[2] - zbox*zprd;
+    }
+
+    // virial = unwrapped coords dotted into body constraint force
+    // body constraint force = implied force due to v change minus f external
+    // assume f does not include forces internal to body
+    // 1/2 factor b/c final_integrate contributes other half
+    // assume per-atom contribution is due to constraint force on that atom
+
+    if (evflag) {
+      if (rmass) massone = rmass[i];
+      else massone = mass[type[i]];
+      fc0 = massone*(v[i][0] - v0)/dtf - f[i][0];
+      fc1 = massone*(v[i][1] - v1)/dtf - f[i][1];
+      fc2 = massone*(v[i][2] - v2)/dtf - f[i][2];
+
+      vr[0] = 0.5*x0*fc0;
+      vr[1] = 0.5*x1*fc1;
+      vr[2] = 0.5*x2*fc2;
+      vr[3] = 0.5*x0*fc1;
+      vr[4] = 0.5*x0*fc2;
+      vr[5] = 0.5*x1*fc2;
+
+      v_tally(1,&i,1.0,vr);
+    }
+
+    // finite-size spheres rotate with the body
+
+    if (extended && radius[i] > 0.0) {
+      omega_one[i][0] = b->omega[0];
+      omega_one[i][1] = b->omega[1];
+      omega_one[i][2] = b->omega[2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set space-frame velocity of each atom in a rigid body
+   set rotation of finite-size spheres
+   v = Vcm + (W cross (x - Xcm))
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::set_v()
+{
+  int xbox,ybox,zbox;
+  double x0,x1,x2,v0,v1,v2,fc0,fc1,fc2,massone;
+  double xy,xz,yz;
+  double delta[3],vr[6];
+  Body *b;
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  double *radius = atom->radius;
+  double **omega_one = atom->omega;
+  int *type = atom->type;
+  int *image = atom->image;
+  int nlocal = atom->nlocal;
+
+  double xprd = domain->xprd;
+  double yprd = domain->yprd;
+  double zprd = domain->zprd;
+  if (triclinic) {
+    xy = domain->xy;
+    xz = domain->xz;
+    yz = domain->yz;
+  }
+
+  // set v of each atom
+
+  for (int i = 0; i < nlocal; i++) {
+    if (atom2body[i] < 0) continue;
+    b = &bodies[atom2body[i]];
+
+    MathExtra::matvec(b->ex_space,b->ey_space,b->ez_space,displace[i],delta);
+
+    // save old velocities for virial
+
+    if (evflag) {
+      v0 = v[i][0];
+      v1 = v[i][1];
+      v2 = v[i][2];
+    }
+
+    v[i][0] = b->omega[1]*delta[2] - b->omega[2]*delta[1] + b->vcm[0];
+    v[i][1] = b->omega[2]*delta[0] - b->omega[0]*delta[2] + b->vcm[1];
+    v[i][2] = b->omega[0]*delta[1] - b->omega[1]*delta[0] + b->vcm[2];
+
+    // virial = unwrapped coords dotted into body constraint force
+    // body constraint force = implied force due to v change minus f external
+    // assume f does not include forces internal to body
+    // 1/2 factor b/c initial_integrate contributes other half
+    // assume per-atom contribution is due to constraint force on that atom
+
+    if (evflag) {
+      if (rmass) massone = rmass[i];
+      else massone = mass[type[i]];
+      fc0 = massone*(v[i][0] - v0)/dtf - f[i][0];
+      fc1 = massone*(v[i][1] - v1)/dtf - f[i][1];
+      fc2 = massone*(v[i][2] - v2)/dtf - f[i][2];
+
+      xbox = (image[i] & 1023) - 512;
+      ybox = (image[i] >> 10 & 1023) - 512;
+      zbox = (image[i] >> 20) - 512;
+
+      if (triclinic == 0) {
+	x0 = x[i][0] + xbox*xprd;
+	x1 = x[i][1] + ybox*yprd;
+	x2 = x[i][2] + zbox*zprd;
+      } else {
+	x0 = x[i][0] + xbox*xprd + ybox*xy + zbox*xz;
+	x1 = x[i][1] + ybox*yprd + zbox*yz;
+	x2 = x[i][2] + zbox*zprd;
+      }
+
+      vr[0] = 0.5*x0*fc0;
+      vr[1] = 0.5*x1*fc1;
+      vr[2] = 0.5*x2*fc2;
+      vr[3] = 0.5*x0*fc1;
+      vr[4] = 0.5*x0*fc2;
+      vr[5] = 0.5*x1*fc2;
+
+      v_tally(1,&i,1.0,vr);
+    }
+
+    if (extended && radius[i] > 0.0) {
+      omega_one[i][0] = b->omega[0];
+      omega_one[i][1] = b->omega[1];
+      omega_one[i][2] = b->omega[2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   append an empty owned body, ghost bodies are discarded
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::add_body()
+{
+  nghost_body = 0;
+  if (nlocal_body == nmax_body) grow_body();
+  nlocal_body++;
+}
+
+/* ----------------------------------------------------------------------
+   delete owned body I, last owned body is moved into its slot
+   ghost bodies are discarded
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::remove_body(int ibody)
+{
+  nghost_body = 0;
+  if (ibody != nlocal_body-1) {
+    bodies[ibody] = bodies[nlocal_body-1];
+    bodyown[bodies[ibody].ilocal] = ibody;
+  }
+  nlocal_body--;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::grow_body()
+{
+  nmax_body += DELTA_BODY;
+  bodies = (Body *) memory->srealloc(bodies,nmax_body*sizeof(Body),
+				     "rigid/small:bodies");
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based arrays and local bodies
+------------------------------------------------------------------------- */
+
+double FixRigidSmall::memory_usage()
+{
+  int nmax = atom->nmax;
+  double bytes = 3*nmax * sizeof(int);
+  bytes += nmax*4 * sizeof(double);
+  bytes += maxvatom*6 * sizeof(double);
+  bytes += nmax_body * sizeof(Body);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate local atom-based arrays
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::grow_arrays(int nmax)
+{
+  memory->grow(bodytag,nmax,"rigid/small:bodytag");
+  memory->grow(bodyown,nmax,"rigid/small:bodyown");
+  memory->grow(atom2body,nmax,"rigid/small:atom2body");
+  memory->grow(bodymass,nmax,"rigid/small:bodymass");
+  memory->grow(displace,nmax,3,"rigid/small:displace");
+}
+
+/* ----------------------------------------------------------------------
+   copy values within local atom-based arrays
+   if atom J still owns a body, J is being deleted, so delete its body
+     unless the body already moved with atom J to another slot, e.g. in sort
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::copy_arrays(int i, int j)
+{
+  if (i == j) return;
+
+  if (j < atom->nlocal && bodyown[j] >= 0 && bodyown[j] < nlocal_body &&
+      bodies[bodyown[j]].ilocal == j) remove_body(bodyown[j]);
+
+  bodytag[j] = bodytag[i];
+  bodyown[j] = bodyown[i];
+  atom2body[j] = atom2body[i];
+  bodymass[j] = bodymass[i];
+  displace[j][0] = displace[i][0];
+  displace[j][1] = displace[i][1];
+  displace[j][2] = displace[i][2];
+  if (bodyown[j] >= 0) bodies[bodyown[j]].ilocal = j;
+}
+
+/* ----------------------------------------------------------------------
+   initialize one atom's array values, called when atom is created
+------------------------------------------------------------------------- */
+
+void FixRigidSmall::set_arrays(int i)
+{
+  bodytag[i] = 0;
+  bodyown[i] = -1;
+  atom2body[i] = -1;
+  bodymass[i] = 0.0;
+  displace[i][0] = 0.0;
+  displace[i][1] = 0.0;
+  displace[i][2] = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based arrays for exchange with another proc
+   an owning atom takes its body along and it is deleted here
+------------------------------------------------------------------------- */
+
+int FixRigidSmall::pack_exchange(int i, double *buf)
+{
+  buf[0] = bodytag[i];
+  buf[1] = displace[i][0];
+  buf[2] = displace[i][1];
+  buf[3] = displace[i][2];
+  if (bodyown[i] < 0) {
+    buf[4] = 0.0;
+    return 5;
+  }
+
+  Body *b = &bodies[bodyown[i]];
+  int m = 4;
+  buf[m++] = 1.0;
+  buf[m++] = b->mass;
+  memcpy(&buf[m],b->xcm,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->vcm,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->fcm,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->torque,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->angmom,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->omega,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->inertia,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->ex_space,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->ey_space,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->ez_space,3*sizeof(double));
+  m += 3;
+  memcpy(&buf[m],b->quat,4*sizeof(double));
+  m += 4;
+  memcpy(&buf[m],b->langextra,6*sizeof(double));
+  m += 6;
+  buf[m++] = b->image;
+  buf[m++] = b->natoms;
+
+  remove_body(bodyown[i]);
+  bodyown[i] = -1;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based arrays from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixRigidSmall::unpack_exchange(int nlocal, double *buf)
+{
+  bodytag[nlocal] = static_cast<int> (buf[0]);
+  displace[nlocal][0] = buf[1];
+  displace[nlocal][1] = buf[2];
+  displace[nlocal][2] = buf[3];
+  atom2body[nlocal] = -1;
+  bodymass[nlocal] = 0.0;
+  if (buf[4] == 0.0) {
+    bodyown[nlocal] = -1;
+    return 5;
+  }
+
+  bodyown[nlocal] = nlocal_body;
+  add_body();
+  Body *b = &bodies[bodyown[nlocal]];
+  int m = 5;
+  b->mass = buf[m++];
+  memcpy(b->xcm,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->vcm,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->fcm,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->torque,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->angmom,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->omega,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->inertia,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->ex_space,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->ey_space,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->ez_space,&buf[m],3*sizeof(double));
+  m += 3;
+  memcpy(b->quat,&buf[m],4*sizeof(double));
+  m += 4;
+  memcpy(b->langextra,&buf[m],6*sizeof(double));
+  m += 6;
+  b->image = static_cast<int> (buf[m++]);
+  b->natoms = static_cast<int> (buf[m++]);
+  b->remap[0] = b->remap[1] = b->remap[2] = 0;
+  b->ilocal = nlocal;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   pack body values of owning atoms for ghost copies of those atoms
+   FULL_BODY creates the ghost bodies, other flags update them
+   values are not shifted by PBC, since atom image flags are
+     relative to the image of the body, not the box
+------------------------------------------------------------------------- */
+
+int FixRigidSmall::pack_comm(int n, int *list, double *buf,
+			     int pbc_flag, int *pbc)
+{
+  int i,j,m,size;
+  Body *b;
+
+  if (commflag == BODYMASS) {
+    for (i = 0; i < n; i++) buf[i] = bodymass[list[i]];
+    return 1;
+  }
+
+  if (commflag == FULL_BODY) size = 23;
+  else if (commflag == INITIAL) size = 18;
+  else size = 6;
+
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    m = i*size;
+    if (commflag == FULL_BODY) {
+      if (bodyown[j] < 0) {
+	buf[m] = 0.0;
+	continue;
+      }
+      buf[m++] = 1.0;
+    } else if (bodyown[j] < 0) continue;
+
+    b = &bodies[bodyown[j]];
+    if (commflag == FULL_BODY) {
+      buf[m++] = b->mass;
+      buf[m++] = b->remap[0];
+      buf[m++] = b->remap[1];
+      buf[m++] = b->remap[2];
+    }
+    if (commflag != FINAL) {
+      memcpy(&buf[m],b->xcm,3*sizeof(double));
+      m += 3;
+      memcpy(&buf[m],b->ex_space,3*sizeof(double));
+      m += 3;
+      memcpy(&buf[m],b->ey_space,3*sizeof(double));
+      m += 3;
+      memcpy(&buf[m],b->ez_space,3*sizeof(double));
+      m += 3;
+    }
+    memcpy(&buf[m],b->vcm,3*sizeof(double));
+    m += 3;
+    memcpy(&buf[m],b->omega,3*sizeof(double));
+  }
+
+  return size;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::unpack_comm(int n, int first, double *buf)
+{
+  int i,m,size;
+  Body *b;
+
+  int last = first + n;
+  if (commflag == BODYMASS) {
+    for (i = first; i < last; i++) bodymass[i] = buf[i-first];
+    return;
+  }
+
+  if (commflag == FULL_BODY) size = 23;
+  else if (commflag == INITIAL) size = 18;
+  else size = 6;
+
+  for (i = first; i < last; i++) {
+    m = (i-first)*size;
+    if (commflag == FULL_BODY) {
+      if (buf[m++] == 0.0) {
+	bodyown[i] = -1;
+	continue;
+      }
+      if (nlocal_body+nghost_body == nmax_body) grow_body();
+      bodyown[i] = nlocal_body + nghost_body++;
+      b = &bodies[bodyown[i]];
+      b->ilocal = i;
+      b->mass = buf[m++];
+      b->remap[0] = static_cast<int> (buf[m++]);
+      b->remap[1] = static_cast<int> (buf[m++]);
+      b->remap[2] = static_cast<int> (buf[m++]);
+    } else if (bodyown[i] < 0) continue;
+    else b = &bodies[bodyown[i]];
+
+    if (commflag != FINAL) {
+      memcpy(b->xcm,&buf[m],3*sizeof(double));
+      m += 3;
+      memcpy(b->ex_space,&buf[m],3*sizeof(double));
+      m += 3;
+      memcpy(b->ey_space,&buf[m],3*sizeof(double));
+      m += 3;
+      memcpy(b->ez_space,&buf[m],3*sizeof(double));
+      m += 3;
+    }
+    memcpy(b->vcm,&buf[m],3*sizeof(double));
+    m += 3;
+    memcpy(b->omega,&buf[m],3*sizeof(double));
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack partial sums of ghost bodies for their owners
+------------------------------------------------------------------------- */
+
+int FixRigidSmall::pack_reverse_comm(int n, int first, double *buf)
+{
+  int i,m;
+  double *one,*two;
+  Body *b;
+
+  int last = first + n;
+  for (i = first; i < last; i++) {
+    m = (i-first)*6;
+    if (bodyown[i] < 0) continue;
+    b = &bodies[bodyown[i]];
+    if (commflag == FORCE_TORQUE) {
+      one = b->fcm;
+      two = b->torque;
+    } else if (commflag == MOMENTUM_FORCE) {
+      one = b->vcm;
+      two = b->fcm;
+    } else {
+      one = b->angmom;
+      two = b->torque;
+    }
+    memcpy(&buf[m],one,3*sizeof(double));
+    memcpy(&buf[m+3],two,3*sizeof(double));
+  }
+
+  return 6;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::unpack_reverse_comm(int n, int *list, double *buf)
+{
+  int i,j,m;
+  double *one,*two;
+  Body *b;
+
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    if (bodyown[j] < 0) continue;
+    m = i*6;
+    b = &bodies[bodyown[j]];
+    if (commflag == FORCE_TORQUE) {
+      one = b->fcm;
+      two = b->torque;
+    } else if (commflag == MOMENTUM_FORCE) {
+      one = b->vcm;
+      two = b->fcm;
+    } else {
+      one = b->angmom;
+      two = b->torque;
+    }
+    one[0] += buf[m];
+    one[1] += buf[m+1];
+    one[2] += buf[m+2];
+    two[0] += buf[m+3];
+    two[1] += buf[m+4];
+    two[2] += buf[m+5];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixRigidSmall::reset_dt()
+{
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+  dtq = 0.5 * update->dt;
+}
+
+/* ----------------------------------------------------------------------
+   return temperature of collection of rigid bodies
+   non-active DOF are removed by fflag/tflag and in tfactor
+------------------------------------------------------------------------- */
+
+double FixRigidSmall::compute_scalar()
+{
+  double wbody[3],rot[3][3];
+  Body *b;
+
+  double t = 0.0;
+
+  for (int ibody = 0; ibody < nlocal_body; ibody++) {
+    b = &bodies[ibody];
+
+    t += b->mass * (fflag[0]*b->vcm[0]*b->vcm[0] +
+		    fflag[1]*b->vcm[1]*b->vcm[1] +
+		    fflag[2]*b->vcm[2]*b->vcm[2]);
+
+    // wbody = angular velocity in body frame
+
+    MathExtra::quat_to_mat(b->quat,rot);
+    MathExtra::transpose_matvec(rot,b->angmom,wbody);
+    if (b->inertia[0] == 0.0) wbody[0] = 0.0;
+    else wbody[0] /= b->inertia[0];
+    if (b->inertia[1] == 0.0) wbody[1] = 0.0;
+    else wbody[1] /= b->inertia[1];
+    if (b->inertia[2] == 0.0) wbody[2] = 0.0;
+    else wbody[2] /= b->inertia[2];
+
+    t += tflag[0]*b->inertia[0]*wbody[0]*wbody[0] +
+      tflag[1]*b->inertia[1]*wbody[1]*wbody[1] +
+      tflag[2]*b->inertia[2]*wbody[2]*wbody[2];
+  }
+
+  double tall;
+  MPI_Allreduce(&t,&tall,1,MPI_DOUBLE,MPI_SUM,world);
+
+  tall *= tfactor;
+  return tall;
+}
@@ -0,0 +1,195 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(rigid/small,FixRigidSmall)
+
+#else
+
+#ifndef LMP_FIX_RIGID_SMALL_H
+#define LMP_FIX_RIGID_SMALL_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixRigidSmall : public Fix {
+ public:
+  FixRigidSmall(class LAMMPS *, int, char **);
+  ~FixRigidSmall();
+  int setmask();
+  void init();
+  void setup_pre_force(int);
+  void setup(int);
+  void initial_integrate(int);
+  void post_force(int);
+  void final_integrate();
+  double compute_scalar();
+
+  double memory_usage();
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  void set_arrays(int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+
+  void pre_neighbor();
+  int dof(int);
+  void deform(int);
+  void reset_dt();
+
+  double *bodymass;         // mass of body an owned or ghost atom is in
+                            //   0.0 if not in a body, set in pre_neighbor()
+
+ private:
+  int me,nprocs;
+  double dtv,dtf,dtq;
+  int triclinic;
+
+  // each rigid body is stored by the proc that owns its lowest-ID atom
+  // it migrates with that atom in Comm::exchange()
+  // procs with ghost copies of that atom also hold a ghost copy of body
+
+  struct Body {
+    double mass;            // total mass of body
+    double xcm[3];          // center-of-mass
+    double vcm[3];          // velocity of center-of-mass
+    double fcm[3];          // force on center-of-mass
+    double torque[3];       // torque around center-of-mass in space coords
+    double angmom[3];       // angular momentum in space coords
+    double omega[3];        // angular velocity in space coords
+    double inertia[3];      // 3 principal components of inertia
+    double ex_space[3];     // principal axes in space coords
+    double ey_space[3];
+    double ez_space[3];
+    double quat[4];         // orientation quaternion
+    double langextra[6];    // Langevin thermostat force and torque
+    int remap[3];           // image shift of xcm in last pre_neighbor()
+    int image;              // image flags of xcm
+    int natoms;             // # of atoms in body
+    int ilocal;             // index of owning atom
+  };
+
+  Body *bodies;             // owned bodies first, then ghost bodies
+  int nlocal_body;          // # of owned bodies
+  int nghost_body;          // # of ghost bodies
+  int nmax_body;            // size of bodies
+
+  int *bodytag;             // ID of owning atom of body each atom is in
+                            //   0 if not in a body
+  int *bodyown;             // index of body an owned or ghost atom owns
+                            //   -1 if it owns none
+  int *atom2body;           // index of body each owned atom is in
+  double **displace;        // displacement of each atom in body coords
+
+  int extended;             // 1 if any particles are finite-size spheres
+  double fflag[3];          // 0/1 for on/off of center-of-mass force
+  double tflag[3];          // 0/1 for on/off of torque
+
+  int commflag;             // which body values are communicated
+
+  double tfactor;           // scale factor on temperature of rigid bodies
+  int langflag;             // 0/1 = no/yes Langevin thermostat
+  double t_start,t_stop,t_period;
+  class RanMars *random;
+
+  void create_bodies();
+  void add_body();
+  void remove_body(int);
+  void grow_body();
+  void set_xv();
+  void set_v();
+  void reset_atom2body();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix rigid/small requires atom attribute molecule
+
+Self-explanatory.
+
+E: Fix rigid/small requires an atom map, see atom_modify
+
+Ghost copies of each body are found via the ID of its owning atom.
+
+E: Fix rigid/small does not support ellipsoid, line, tri or dipole particles
+
+Only point particles and finite-size spheres can be part of a
+rigid/small body.
+
+E: Fix rigid/small langevin period must be > 0.0
+
+Self-explanatory.
+
+E: Fix rigid/small atom has non-zero image flag in a non-periodic dimension
+
+You cannot set image flags for non-periodic dimensions.
+
+E: One or zero atoms in rigid body
+
+Any rigid body defined by the fix rigid/small command must contain 2
+or more atoms.
+
+E: No rigid bodies defined
+
+The fix specification did not end up defining any rigid bodies.
+
+E: Insufficient Jacobi rotations for rigid body
+
+Eigensolve for rigid body was not sufficiently accurate.
+
+E: Fix rigid/small: Bad principal moments
+
+The principal moments of inertia computed for a rigid body
+are not within the required tolerances.
+
+E: Fix rigid/small does not support run_style respa
+
+Self-explanatory.
+
+E: Rigid fix must come before NPT/NPH fix
+
+NPT/NPH fix must be defined in input script after all rigid fixes,
+else the rigid fix contribution to the pressure virial is
+incorrect.
+
+E: Rigid body atoms missing at pre_neighbor
+
+An atom of a body cannot see the atom that owns the body, not even as
+a ghost.  Every body must fit within the ghost cutoff, which can be
+increased with the communicate cutoff command.
+
+W: Computing temperature of portions of rigid bodies
+
+The group defined by the temperature compute does not encompass all
+the atoms in one or more rigid bodies, so the change in
+degrees-of-freedom for the atoms in those partial rigid bodies will
+not be accounted for.
+
+*/
@@ -15,8 +15,11 @@
 #include "stdio.h"
 #include "fix_shear_history.h"
 #include "atom.h"
+#include "comm.h"
+#include "domain.h"
 #include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_request.h"
 #include "force.h"
 #include "pair.h"
 #include "update.h"
@@ -27,26 +30,51 @@
 using namespace LAMMPS_NS;
 using namespace FixConst;
 
-#define MAXTOUCH 15
-
 /* ---------------------------------------------------------------------- */
 
 FixShearHistory::FixShearHistory(LAMMPS *lmp, int narg, char **arg) :
   Fix(lmp, narg, arg)
 {
+  if (narg < 3 || narg > 4) error->all(FLERR,"Illegal fix SHEAR_HISTORY command");
+
+  // # of history values per contact, default = 3 shear components
+
+  dnum = 3;
+  if (narg == 4) dnum = force->inumeric(arg[3]);
+  if (dnum <= 0) error->all(FLERR,"Illegal fix SHEAR_HISTORY command");
+
   // set time_depend so that history will be preserved correctly
   // across multiple runs via laststep setting in granular pair styles
 
+  restart_global = 1;
   restart_peratom = 1;
   create_attribute = 1;
   time_depend = 1;
 
+  persist = 0;
+  lastpack = -1;
+  oldflag = partial = 0;
+  maxold = 0;
+  oldtag = oldnum = NULL;
+  oldneigh = oldtouch = NULL;
+  oldshear = NULL;
+  spare = sparehistory = NULL;
+
+  // create pages for partner and shearpartner chunks
+  // must exist before restart data is unpacked
+
+  ipage = NULL;
+  dpage = NULL;
+  allocate_pages();
+  maxtouch = 0;
+
   // perform initial allocation of atom-based arrays
   // register with atom class
 
   npartner = NULL;
   partner = NULL;
   shearpartner = NULL;
+  oldindex = NULL;
   grow_arrays(atom->nmax);
   atom->add_callback(0);
   atom->add_callback(1);
@@ -54,7 +82,10 @@ FixShearHistory::FixShearHistory(LAMMPS *lmp, int narg, char **arg) :
   // initialize npartner to 0 so neighbor list creation is OK the 1st time
 
   int nlocal = atom->nlocal;
-  for (int i = 0; i < nlocal; i++) npartner[i] = 0;
+  for (int i = 0; i < nlocal; i++) {
+    npartner[i] = 0;
+    oldindex[i] = -1;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -69,8 +100,20 @@ FixShearHistory::~FixShearHistory()
   // delete locally stored arrays
 
   memory->destroy(npartner);
-  memory->destroy(partner);
-  memory->destroy(shearpartner);
+  memory->sfree(partner);
+  memory->sfree(shearpartner);
+  memory->destroy(oldindex);
+
+  memory->destroy(oldtag);
+  memory->destroy(oldnum);
+  memory->sfree(oldneigh);
+  memory->sfree(oldtouch);
+  memory->sfree(oldshear);
+
+  delete ipage;
+  delete dpage;
+  delete spare;
+  delete sparehistory;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -88,23 +131,147 @@ void FixShearHistory::init()
 {
   if (atom->tag_enable == 0) 
     error->all(FLERR,"Pair style granular with history requires atoms have IDs");
+
+  // history list pages of the pair are sized by the dnum of its request
+
+  if (pair) {
+    for (int i = 0; i < neighbor->nrequest; i++) {
+      NeighRequest *rq = neighbor->requests[i];
+      if (rq->requestor == (void *) pair && rq->granhistory &&
+	  rq->dnum != dnum)
+	error->all(FLERR,"Fix SHEAR_HISTORY dnum does not match "
+		   "pair history size");
+    }
+  }
+
+  // neigh_modify one or page may have changed since the pages were created
+
+  if (pgsize != neighbor->pgsize || oneatom != neighbor->oneatom)
+    allocate_pages();
+
+  // partners may have been read from a restart file since last pre_exchange
+
+  set_maxtouch();
+
+  // neighbor lists may be re-created, previous list is no longer valid
+
+  oldflag = 0;
+}
+
+/* ----------------------------------------------------------------------
+   max # of partners of any atom across all procs
+   used to size restart buffers
+------------------------------------------------------------------------- */
+
+void FixShearHistory::set_maxtouch()
+{
+  int mymax = set_maxexchange();
+  MPI_Allreduce(&mymax,&maxtouch,1,MPI_INT,MPI_MAX,world);
+}
+
+/* ----------------------------------------------------------------------
+   max # of values pack_exchange() packs for one of my atoms
+   lets Comm and Irregular size their send buffers for it
+   return max # of partners of my atoms
+------------------------------------------------------------------------- */
+
+int FixShearHistory::set_maxexchange()
+{
+  int nlocal = atom->nlocal;
+  int mymax = 0;
+  for (int i = 0; i < nlocal; i++) mymax = MAX(mymax,npartner[i]);
+  maxexchange = (dnum+1)*mymax + 1;
+  return mymax;
+}
+
+/* ----------------------------------------------------------------------
+   create pages sized by current neighbor settings
+   a chunk holds the partners of one atom, so at most oneatom of them
+   if pages already exist, move chunks of owned atoms to the new pages
+------------------------------------------------------------------------- */
+
+void FixShearHistory::allocate_pages()
+{
+  pgsize = neighbor->pgsize;
+  oneatom = neighbor->oneatom;
+
+  MyPage<int> *ipage_old = ipage;
+  MyPage<double> *dpage_old = dpage;
+  ipage = new MyPage<int>(oneatom,pgsize);
+  dpage = new MyPage<double>(dnum*oneatom,dnum*pgsize);
+
+  if (ipage_old) {
+    int nlocal = atom->nlocal;
+    for (int i = 0; i < nlocal; i++) {
+      int *ptr = ipage->get(npartner[i]);
+      double *dptr = dpage->get(dnum*npartner[i]);
+      if (!ptr || !dptr)
+	error->one(FLERR,"Shear history overflow, boost neigh_modify one");
+      memcpy(ptr,partner[i],npartner[i]*sizeof(int));
+      memcpy(dptr,shearpartner[i],dnum*npartner[i]*sizeof(double));
+      partner[i] = ptr;
+      shearpartner[i] = dptr;
+    }
+    delete ipage_old;
+    delete dpage_old;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
 
 void FixShearHistory::setup_pre_exchange()
 {
-  pre_exchange();
+  lastpack = -1;
+  oldflag = partial = 0;
+  pre_exchange_full();
+  set_maxtouch();
+}
+
+/* ----------------------------------------------------------------------
+   a fix that migrates atoms in its own pre_exchange() calls this first,
+   so skip the 2nd call on the same step, list indices are stale by then
+------------------------------------------------------------------------- */
+
+void FixShearHistory::pre_exchange()
+{
+  if (lastpack == update->ntimestep) return;
+  lastpack = update->ntimestep;
+
+  if (persist_check()) {
+    pre_exchange_persist();
+    set_maxexchange();
+  } else {
+    oldflag = partial = 0;
+    pre_exchange_full();
+    set_maxtouch();
+  }
+}
+
+/* ----------------------------------------------------------------------
+   commands between runs may migrate any atom, so all atoms need partners
+------------------------------------------------------------------------- */
+
+void FixShearHistory::post_run()
+{
+  if (partial) {
+    pre_exchange_full();
+    set_maxtouch();
+    partial = 0;
+  }
+  oldflag = 0;
 }
 
 /* ----------------------------------------------------------------------
    copy shear partner info from neighbor lists to atom arrays
    so can be exchanged with atoms
+   1st pass counts touching partners, 2nd pass fills per-atom chunks
+   chunks of atoms that migrated since the last call are orphaned,
+   they are all recycled here by resetting the pages
 ------------------------------------------------------------------------- */
 
-void FixShearHistory::pre_exchange()
+void FixShearHistory::pre_exchange_full()
 {
-  int i,j,ii,jj,m,inum,jnum;
+  int i,j,k,ii,jj,m,inum,jnum;
   int *ilist,*jlist,*numneigh,**firstneigh;
   int *touch,**firsttouch;
   double *shear,*allshear,**firstshear;
@@ -114,9 +281,7 @@ void FixShearHistory::pre_exchange()
   int nlocal = atom->nlocal;
   for (i = 0; i < nlocal; i++) npartner[i] = 0;
 
-  // copy shear info from neighbor list atoms to atom arrays
-
-  int *tag = atom->tag;
+  // count touching partners of owned atoms
 
   NeighList *list = pair->list;
   inum = list->inum;
@@ -126,6 +291,39 @@ void FixShearHistory::pre_exchange()
   firsttouch = list->listgranhistory->firstneigh;
   firstshear = list->listgranhistory->firstdouble;
 
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    touch = firsttouch[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      if (touch[jj]) {
+	npartner[i]++;
+	j = jlist[jj];
+	j &= NEIGHMASK;
+	if (j < nlocal) npartner[j]++;
+      }
+    }
+  }
+
+  // get a chunk of exactly the right size for each owned atom
+
+  ipage->reset();
+  dpage->reset();
+
+  for (i = 0; i < nlocal; i++) {
+    partner[i] = ipage->get(npartner[i]);
+    shearpartner[i] = dpage->get(dnum*npartner[i]);
+    if (!partner[i] || !shearpartner[i])
+      error->one(FLERR,"Shear history overflow, boost neigh_modify one");
+    npartner[i] = 0;
+  }
+
+  // copy shear info from neighbor list atoms to atom arrays
+
+  int *tag = atom->tag;
+
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
     jlist = firstneigh[i];
@@ -135,39 +333,300 @@ void FixShearHistory::pre_exchange()
 
     for (jj = 0; jj < jnum; jj++) {
       if (touch[jj]) {
-	shear = &allshear[3*jj];
+	shear = &allshear[dnum*jj];
 	j = jlist[jj];
 	j &= NEIGHMASK;
-	if (npartner[i] < MAXTOUCH) {
-	  m = npartner[i];
-	  partner[i][m] = tag[j];
-	  shearpartner[i][m][0] = shear[0];
-	  shearpartner[i][m][1] = shear[1];
-	  shearpartner[i][m][2] = shear[2];
+	m = npartner[i]++;
+	partner[i][m] = tag[j];
+	for (k = 0; k < dnum; k++)
+	  shearpartner[i][dnum*m+k] = shear[k];
+	if (j < nlocal) {
+	  m = npartner[j]++;
+	  partner[j][m] = tag[i];
+	  for (k = 0; k < dnum; k++)
+	    shearpartner[j][dnum*m+k] = -shear[k];
 	}
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   persistent mode requires that migrating atoms are known before
+   comm->exchange() and that the pair list is built directly
+------------------------------------------------------------------------- */
+
+int FixShearHistory::persist_check()
+{
+  if (!persist) return 0;
+  if (domain->triclinic || domain->box_change) return 0;
+
+  NeighList *list = pair->list;
+  if (list->listcopy || list->listskip || list->fix_history != this) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   keep current neighbor list alive for lookup() during the rebuild
+   instead of copying all contacts to the atoms
+   only contacts with an atom that will leave my sub-domain are copied,
+   so they can travel with the atom or be found when the atom returns
+   as a ghost of its partner
+------------------------------------------------------------------------- */
+
+void FixShearHistory::pre_exchange_persist()
+{
+  int i,j,k,ii,jj,m,inum,jnum,dim;
+  int *ilist,*jlist,*numneigh,**firstneigh;
+  int *touch,**firsttouch;
+  double coord;
+  double *shear,*allshear,**firstshear;
+
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+
+  if (atom->nmax > maxold) {
+    maxold = atom->nmax;
+    memory->destroy(oldtag);
+    memory->destroy(oldnum);
+    memory->sfree(oldneigh);
+    memory->sfree(oldtouch);
+    memory->sfree(oldshear);
+    memory->create(oldtag,maxold,"shear_history:oldtag");
+    memory->create(oldnum,maxold,"shear_history:oldnum");
+    oldneigh = (int **) 
+      memory->smalloc(maxold*sizeof(int *),"shear_history:oldneigh");
+    oldtouch = (int **) 
+      memory->smalloc(maxold*sizeof(int *),"shear_history:oldtouch");
+    oldshear = (double **) 
+      memory->smalloc(maxold*sizeof(double *),"shear_history:oldshear");
+  }
+
+  // flag atoms that comm->exchange() will send away with oldindex = -1
+  // remap coord the same way Domain::pbc() will before the test
+
+  double **x = atom->x;
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  double *prd = domain->prd;
+  int *periodicity = domain->periodicity;
+  int *procgrid = comm->procgrid;
+
+  for (i = 0; i < nlocal; i++) {
+    oldindex[i] = i;
+    oldnum[i] = 0;
+    for (dim = 0; dim < 3; dim++) {
+      if (procgrid[dim] == 1) continue;
+      coord = x[i][dim];
+      if (periodicity[dim]) {
+	if (coord < boxlo[dim]) coord += prd[dim];
+	if (coord >= boxhi[dim]) {
+	  coord -= prd[dim];
+	  coord = MAX(coord,boxlo[dim]);
+	}
+      }
+      if (coord < sublo[dim] || coord >= subhi[dim]) {
+	oldindex[i] = -1;
+	break;
+      }
+    }
+  }
+
+  // snapshot of current list, indexed by current local index
+
+  int *tag = atom->tag;
+  memcpy(oldtag,tag,nall*sizeof(int));
+
+  NeighList *list = pair->list;
+  NeighList *listgranhistory = list->listgranhistory;
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+  firsttouch = listgranhistory->firstneigh;
+  firstshear = listgranhistory->firstdouble;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    oldnum[i] = numneigh[i];
+    oldneigh[i] = firstneigh[i];
+    oldtouch[i] = firsttouch[i];
+    oldshear[i] = firstshear[i];
+  }
+
+  // count contacts that involve a migrating atom, on both sides
+
+  for (i = 0; i < nlocal; i++) npartner[i] = 0;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    touch = firsttouch[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      if (touch[jj]) {
+	j = jlist[jj];
+	j &= NEIGHMASK;
+	if (oldindex[i] >= 0 && (j >= nlocal || oldindex[j] >= 0)) continue;
 	npartner[i]++;
+	if (j < nlocal) npartner[j]++;
+      }
+    }
+  }
+
+  ipage->reset();
+  dpage->reset();
+
+  for (i = 0; i < nlocal; i++) {
+    partner[i] = ipage->get(npartner[i]);
+    shearpartner[i] = dpage->get(dnum*npartner[i]);
+    if (!partner[i] || !shearpartner[i])
+      error->one(FLERR,"Shear history overflow, boost neigh_modify one");
+    npartner[i] = 0;
+  }
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    allshear = firstshear[i];
+    jnum = numneigh[i];
+    touch = firsttouch[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      if (touch[jj]) {
+	j = jlist[jj];
+	j &= NEIGHMASK;
+	if (oldindex[i] >= 0 && (j >= nlocal || oldindex[j] >= 0)) continue;
+	shear = &allshear[dnum*jj];
+	m = npartner[i]++;
+	partner[i][m] = tag[j];
+	for (k = 0; k < dnum; k++)
+	  shearpartner[i][dnum*m+k] = shear[k];
 	if (j < nlocal) {
-	  if (npartner[j] < MAXTOUCH) {
-	    m = npartner[j];
-	    partner[j][m] = tag[i];
-	    shearpartner[j][m][0] = -shear[0];
-	    shearpartner[j][m][1] = -shear[1];
-	    shearpartner[j][m][2] = -shear[2];
-	  }
-	  npartner[j]++;
+	  m = npartner[j]++;
+	  partner[j][m] = tag[i];
+	  for (k = 0; k < dnum; k++)
+	    shearpartner[j][dnum*m+k] = -shear[k];
 	}
       }
     }
   }
 
-  // test for too many touching neighbors
+  // rebuild writes into the spare pages, current pages become the snapshot
+  // spare lists must match page size and dnum of the pair lists
+
+  if (spare == NULL || spare->pgsize != list->pgsize ||
+      sparehistory->dnum != listgranhistory->dnum) {
+    delete spare;
+    delete sparehistory;
+    spare = new NeighList(lmp,list->pgsize);
+    sparehistory = new NeighList(lmp,list->pgsize);
+    sparehistory->dnum = listgranhistory->dnum;
+  }
+
+  list->swap_pages(spare);
+  listgranhistory->swap_pages(sparehistory);
 
-  int flag = 0;
-  for (i = 0; i < nlocal; i++)
-    if (npartner[i] >= MAXTOUCH) flag = 1;
-  int flag_all;
-  MPI_Allreduce(&flag,&flag_all,1,MPI_INT,MPI_SUM,world);
-  if (flag_all) error->all(FLERR,"Too many touching neighbors - boost MAXTOUCH");
+  oldflag = 1;
+  partial = 1;
+}
+
+/* ----------------------------------------------------------------------
+   copy history of touching pair I,J into shear as seen from I
+   I is owned, J is owned or ghost, return 0 if pair has no history
+   previous list is searched for atoms that did not migrate,
+   partner chunks for those that did or touched one that did
+------------------------------------------------------------------------- */
+
+int FixShearHistory::lookup(int i, int j, double *shear)
+{
+  int m,d;
+  double *ptr;
+
+  int *tag = atom->tag;
+  int itag = tag[i];
+  int jtag = tag[j];
+  int jown = (j < atom->nlocal);
+
+  if (oldflag) {
+    if (oldindex[i] >= 0 && (m = oldfind(oldindex[i],jtag)) >= 0) {
+      ptr = &oldshear[oldindex[i]][dnum*m];
+      for (d = 0; d < dnum; d++) shear[d] = ptr[d];
+      return 1;
+    }
+    if (jown && oldindex[j] >= 0 && (m = oldfind(oldindex[j],itag)) >= 0) {
+      ptr = &oldshear[oldindex[j]][dnum*m];
+      for (d = 0; d < dnum; d++) shear[d] = -ptr[d];
+      return 1;
+    }
+  }
+
+  for (m = 0; m < npartner[i]; m++)
+    if (partner[i][m] == jtag) {
+      ptr = &shearpartner[i][dnum*m];
+      for (d = 0; d < dnum; d++) shear[d] = ptr[d];
+      return 1;
+    }
+
+  if (oldflag && jown)
+    for (m = 0; m < npartner[j]; m++)
+      if (partner[j][m] == itag) {
+	ptr = &shearpartner[j][dnum*m];
+	for (d = 0; d < dnum; d++) shear[d] = -ptr[d];
+	return 1;
+      }
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixShearHistory::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"persist") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal fix_modify command");
+    if (strcmp(arg[1],"yes") == 0) persist = 1;
+    else if (strcmp(arg[1],"no") == 0) persist = 0;
+    else error->all(FLERR,"Illegal fix_modify command");
+    return 2;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   pack entire state of Fix into one write
+   called on all procs before per-atom data is sized,
+   so partners of all atoms are restored here in persistent mode
+------------------------------------------------------------------------- */
+
+void FixShearHistory::write_restart(FILE *fp)
+{
+  if (partial) {
+    pre_exchange_full();
+    partial = 0;
+  }
+  set_maxtouch();
+
+  if (comm->me == 0) {
+    double list[1];
+    list[0] = persist;
+    int size = sizeof(double);
+    fwrite(&size,sizeof(int),1,fp);
+    fwrite(list,sizeof(double),1,fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   use state info from restart file to restart the Fix
+------------------------------------------------------------------------- */
+
+void FixShearHistory::restart(char *buf)
+{
+  double *list = (double *) buf;
+  persist = static_cast<int> (list[0]);
 }
 
 /* ----------------------------------------------------------------------
@@ -178,35 +637,46 @@ double FixShearHistory::memory_usage()
 {
   int nmax = atom->nmax;
   double bytes = nmax * sizeof(int);
-  bytes += nmax*MAXTOUCH * sizeof(int);
-  bytes += nmax*MAXTOUCH*3 * sizeof(double);
+  bytes += nmax * sizeof(int *);
+  bytes += nmax * sizeof(double *);
+  bytes += nmax * sizeof(int);
+  bytes += ipage->size();
+  bytes += dpage->size();
+  bytes += maxold * 2*sizeof(int);
+  bytes += maxold * 2*sizeof(int *);
+  bytes += maxold * sizeof(double *);
+  if (spare) bytes += spare->memory_usage() + sparehistory->memory_usage();
   return bytes;
 }
 
 /* ----------------------------------------------------------------------
    allocate local atom-based arrays
+   partner and shearpartner only hold pointers into ipage and dpage
 ------------------------------------------------------------------------- */
 
 void FixShearHistory::grow_arrays(int nmax)
 {
   memory->grow(npartner,nmax,"shear_history:npartner");
-  memory->grow(partner,nmax,MAXTOUCH,"shear_history:partner");
-  memory->grow(shearpartner,nmax,MAXTOUCH,3,"shear_history:shearpartner");
+  partner = (int **) memory->srealloc(partner,nmax*sizeof(int *),
+				      "shear_history:partner");
+  shearpartner = (double **) 
+    memory->srealloc(shearpartner,nmax*sizeof(double *),
+		     "shear_history:shearpartner");
+  memory->grow(oldindex,nmax,"shear_history:oldindex");
 }
 
 /* ----------------------------------------------------------------------
    copy values within local atom-based arrays
+   only the chunk pointers are copied, chunk of atom j is orphaned
+   until the pages are reset in the next pre_exchange()
 ------------------------------------------------------------------------- */
 
 void FixShearHistory::copy_arrays(int i, int j)
 {
   npartner[j] = npartner[i];
-  for (int m = 0; m < npartner[j]; m++) {
-    partner[j][m] = partner[i][m];
-    shearpartner[j][m][0] = shearpartner[i][m][0];
-    shearpartner[j][m][1] = shearpartner[i][m][1];
-    shearpartner[j][m][2] = shearpartner[i][m][2];
-  }
+  partner[j] = partner[i];
+  shearpartner[j] = shearpartner[i];
+  oldindex[j] = oldindex[i];
 }
 
 /* ----------------------------------------------------------------------
@@ -216,6 +686,7 @@ void FixShearHistory::copy_arrays(int i, int j)
 void FixShearHistory::set_arrays(int i)
 {
   npartner[i] = 0;
+  oldindex[i] = -1;
 }
 
 /* ----------------------------------------------------------------------
@@ -228,26 +699,32 @@ int FixShearHistory::pack_exchange(int i, double *buf)
   buf[m++] = npartner[i];
   for (int n = 0; n < npartner[i]; n++) {
     buf[m++] = partner[i][n];
-    buf[m++] = shearpartner[i][n][0];
-    buf[m++] = shearpartner[i][n][1];
-    buf[m++] = shearpartner[i][n][2];
+    for (int k = 0; k < dnum; k++)
+      buf[m++] = shearpartner[i][dnum*n+k];
   }
   return m;
 }
 
 /* ----------------------------------------------------------------------
    unpack values in local atom-based arrays from exchange with another proc
+   incoming atom grabs a new chunk of the right size
+   it may be sent on in the next dim of Comm::exchange(), so track its size
 ------------------------------------------------------------------------- */
 
 int FixShearHistory::unpack_exchange(int nlocal, double *buf)
 {
   int m = 0;
+  oldindex[nlocal] = -1;
   npartner[nlocal] = static_cast<int> (buf[m++]);
+  partner[nlocal] = ipage->get(npartner[nlocal]);
+  shearpartner[nlocal] = dpage->get(dnum*npartner[nlocal]);
+  if (!partner[nlocal] || !shearpartner[nlocal])
+    error->one(FLERR,"Shear history overflow, boost neigh_modify one");
+  maxexchange = MAX(maxexchange,(dnum+1)*npartner[nlocal] + 1);
   for (int n = 0; n < npartner[nlocal]; n++) {
     partner[nlocal][n] = static_cast<int> (buf[m++]);
-    shearpartner[nlocal][n][0] = buf[m++];
-    shearpartner[nlocal][n][1] = buf[m++];
-    shearpartner[nlocal][n][2] = buf[m++];
+    for (int k = 0; k < dnum; k++)
+      shearpartner[nlocal][dnum*n+k] = buf[m++];
   }
   return m;
 }
@@ -259,13 +736,12 @@ int FixShearHistory::unpack_exchange(int nlocal, double *buf)
 int FixShearHistory::pack_restart(int i, double *buf)
 {
   int m = 0;
-  buf[m++] = 4*npartner[i] + 2;
+  buf[m++] = (dnum+1)*npartner[i] + 2;
   buf[m++] = npartner[i];
   for (int n = 0; n < npartner[i]; n++) {
     buf[m++] = partner[i][n];
-    buf[m++] = shearpartner[i][n][0];
-    buf[m++] = shearpartner[i][n][1];
-    buf[m++] = shearpartner[i][n][2];
+    for (int k = 0; k < dnum; k++)
+      buf[m++] = shearpartner[i][dnum*n+k];
   }
   return m;
 }
@@ -284,12 +760,18 @@ void FixShearHistory::unpack_restart(int nlocal, int nth)
   for (int i = 0; i < nth; i++) m += static_cast<int> (extra[nlocal][m]);
   m++;
 
+  // allocate new chunks from ipage,dpage for incoming values
+
+  oldindex[nlocal] = -1;
   npartner[nlocal] = static_cast<int> (extra[nlocal][m++]);
+  partner[nlocal] = ipage->get(npartner[nlocal]);
+  shearpartner[nlocal] = dpage->get(dnum*npartner[nlocal]);
+  if (!partner[nlocal] || !shearpartner[nlocal])
+    error->one(FLERR,"Shear history overflow, boost neigh_modify one");
   for (int n = 0; n < npartner[nlocal]; n++) {
     partner[nlocal][n] = static_cast<int> (extra[nlocal][m++]);
-    shearpartner[nlocal][n][0] = extra[nlocal][m++];
-    shearpartner[nlocal][n][1] = extra[nlocal][m++];
-    shearpartner[nlocal][n][2] = extra[nlocal][m++];
+    for (int k = 0; k < dnum; k++)
+      shearpartner[nlocal][dnum*n+k] = extra[nlocal][m++];
   }
 }
 
@@ -299,7 +781,7 @@ void FixShearHistory::unpack_restart(int nlocal, int nth)
 
 int FixShearHistory::maxsize_restart()
 {
-  return 4*MAXTOUCH + 2;
+  return (dnum+1)*maxtouch + 2;
 }
 
 /* ----------------------------------------------------------------------
@@ -308,5 +790,5 @@ int FixShearHistory::maxsize_restart()
 
 int FixShearHistory::size_restart(int nlocal)
 {
-  return 4*npartner[nlocal] + 2;
+  return (dnum+1)*npartner[nlocal] + 2;
 }
@@ -21,6 +21,7 @@ FixStyle(SHEAR_HISTORY,FixShearHistory)
 #define LMP_FIX_SHEAR_HISTORY_H
 
 #include "fix.h"
+#include "my_page.h"
 
 namespace LAMMPS_NS {
 
@@ -28,6 +29,7 @@ class FixShearHistory : public Fix {
   friend class Neighbor;
   friend class PairGranHookeHistory;
   friend class FixPour;
+  friend class FixBalance;
 
  public:
   FixShearHistory(class LAMMPS *, int, char **);
@@ -35,7 +37,12 @@ class FixShearHistory : public Fix {
   int setmask();
   void init();
   void setup_pre_exchange();
-  virtual void pre_exchange();
+  void pre_exchange();
+  void post_run();
+  int modify_param(int, char **);
+  void write_restart(FILE *);
+  void restart(char *);
+  int lookup(int, int, double *);
 
   double memory_usage();
   void grow_arrays(int);
@@ -49,11 +56,50 @@ class FixShearHistory : public Fix {
   int maxsize_restart();
 
  protected:
+  int dnum;                     // # of history values per contact
   int *npartner;                // # of touching partners of each atom
   int **partner;                // tags for the partners
-  double ***shearpartner;       // 3 shear values with the partner
+  double **shearpartner;        // dnum history values with each partner
+  int maxtouch;                 // max # of touching partners of any atom
+
+  MyPage<int> *ipage;           // pages of partner tags
+  MyPage<double> *dpage;        // pages of history values
+  int pgsize,oneatom;           // neighbor settings the pages were built for
 
   class Pair *pair;
+  bigint lastpack;              // step contacts were last copied to atoms
+
+  // persistent mode, history of atoms that stay on this proc
+  // is read from the previous neighbor list by lookup()
+
+  int persist;                  // 1 if persistent mode was requested
+  int oldflag;                  // 1 if previous list can be searched
+  int partial;                  // 1 if only migrating atoms have partners
+  int *oldindex;                // local index of atom before exchange
+                                //   -1 if it migrated or was created
+  int maxold;                   // size of snapshot arrays
+  int *oldtag;                  // tags of owned+ghost atoms before exchange
+  int *oldnum;                  // snapshot of previous list per old index
+  int **oldneigh,**oldtouch;
+  double **oldshear;
+  class NeighList *spare;       // holds pages of previous list
+  class NeighList *sparehistory;
+
+  void allocate_pages();
+  void set_maxtouch();
+  int set_maxexchange();
+  int persist_check();
+  void pre_exchange_persist();
+  virtual void pre_exchange_full();
+
+  inline int oldfind(int i, int itag) {
+    int *jlist = oldneigh[i];
+    int *touch = oldtouch[i];
+    int jnum = oldnum[i];
+    for (int jj = 0; jj < jnum; jj++)
+      if (touch[jj] && oldtag[jlist[jj] & NEIGHMASK] == itag) return jj;
+    return -1;
+  }
 };
 
 }
@@ -68,10 +114,24 @@ E: Pair style granular with history requires atoms have IDs
 Atoms in the simulation do not have IDs, so history effects
 cannot be tracked by the granular pair potential.
 
-E: Too many touching neighbors - boost MAXTOUCH
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix SHEAR_HISTORY dnum does not match pair history size
+
+The number of history values per contact given to the fix must equal
+the number the pair style requested for its history neighbor list.
+
+E: Shear history overflow, boost neigh_modify one
+
+There are too many neighbors of a single atom.  Use the neigh_modify
+command to increase the max number of neighbors allowed for one atom.
+
+E: Illegal fix_modify command
 
-A granular simulation has too many neighbors touching one atom.  The
-MAXTOUCH parameter in fix_shear_history.cpp must be set larger and
-LAMMPS must be re-built.
+Self-explanatory.
 
 */
@@ -30,6 +30,8 @@ FixViscous::FixViscous(LAMMPS *lmp, int narg, char **arg) :
 {
   if (narg < 4) error->all(FLERR,"Illegal fix viscous command");
 
+  fuse_flag = 1;
+
   double gamma_one = atof(arg[3]);
   gamma = new double[atom->ntypes+1];
   for (int i = 1; i <= atom->ntypes; i++) gamma[i] = gamma_one;
@@ -99,6 +101,13 @@ void FixViscous::min_setup(int vflag)
 /* ---------------------------------------------------------------------- */
 
 void FixViscous::post_force(int vflag)
+{
+  post_force_range(0,atom->nlocal);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixViscous::post_force_range(int ifirst, int ilast)
 {
   // apply drag force to atoms in group
   // direction is opposed to velocity vector
@@ -108,11 +117,10 @@ void FixViscous::post_force(int vflag)
   double **f = atom->f;
   int *mask = atom->mask;
   int *type = atom->type;
-  int nlocal = atom->nlocal;
   
   double drag;
 
-  for (int i = 0; i < nlocal; i++)
+  for (int i = ifirst; i < ilast; i++)
     if (mask[i] & groupbit) {
       drag = gamma[type[i]];
       f[i][0] -= drag*v[i][0];
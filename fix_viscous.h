@@ -34,6 +34,7 @@ class FixViscous : public Fix {
   void min_setup(int);
   void post_force(int);
   void post_force_respa(int, int, int);
+  void post_force_range(int, int);
   void min_post_force(int);
 
  protected:
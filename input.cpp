@@ -43,6 +43,7 @@
 #include "special.h"
 #include "variable.h"
 #include "accelerator_cuda.h"
+#include "timer.h"
 #include "error.h"
 #include "memory.h"
 
@@ -488,6 +489,7 @@ int Input::execute_command()
   else if (!strcmp(command,"thermo")) thermo();
   else if (!strcmp(command,"thermo_modify")) thermo_modify();
   else if (!strcmp(command,"thermo_style")) thermo_style();
+  else if (!strcmp(command,"timer")) timer_command();
   else if (!strcmp(command,"timestep")) timestep();
   else if (!strcmp(command,"uncompute")) uncompute();
   else if (!strcmp(command,"undump")) undump();
@@ -1376,6 +1378,13 @@ void Input::thermo_style()
 
 /* ---------------------------------------------------------------------- */
 
+void Input::timer_command()
+{
+  timer->modify_params(narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Input::timestep()
 {
   if (narg != 1) error->all(FLERR,"Illegal timestep command");
@@ -20,6 +20,8 @@
 #include "atom_vec.h"
 #include "domain.h"
 #include "comm.h"
+#include "modify.h"
+#include "fix.h"
 #include "memory.h"
 
 using namespace LAMMPS_NS;
@@ -47,7 +49,8 @@ Irregular::Irregular(LAMMPS *lmp) : Pointers(lmp)
   // these can persist for multiple irregular operations
 
   maxsend = BUFMIN;
-  memory->create(buf_send,maxsend+BUFEXTRA,"comm:buf_send");
+  bufextra = BUFEXTRA;
+  memory->create(buf_send,maxsend+bufextra,"comm:buf_send");
   maxrecv = BUFMIN;
   memory->create(buf_recv,maxrecv,"comm:buf_recv");
 }
@@ -83,6 +86,17 @@ void Irregular::migrate_atoms()
   atom->nghost = 0;
   atom->avec->clear_bonus();
 
+  // insure buf_send has room past maxsend for the largest atom,
+  //   fixes like SHEAR_HISTORY can pack more than BUFEXTRA values for one
+
+  int extra = BUFEXTRA;
+  for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+    extra += modify->fix[atom->extra_grow[iextra]]->maxexchange;
+  if (extra > bufextra) {
+    bufextra = extra;
+    memory->grow(buf_send,maxsend+bufextra,"comm:buf_send");
+  }
+
   // subbox bounds for orthogonal or triclinic box
   // other comm/domain data used by coord2proc()
 
@@ -683,7 +697,7 @@ int Irregular::binary(double value, int n, double *vec)
 }
 
 /* ----------------------------------------------------------------------
-   realloc the size of the send buffer as needed with BUFFACTOR & BUFEXTRA 
+   realloc the size of the send buffer as needed with BUFFACTOR & bufextra
    if flag = 1, realloc
    if flag = 0, don't need to realloc with copy, just free/malloc
 ------------------------------------------------------------------------- */
@@ -692,10 +706,10 @@ void Irregular::grow_send(int n, int flag)
 {
   maxsend = static_cast<int> (BUFFACTOR * n);
   if (flag)
-    memory->grow(buf_send,maxsend+BUFEXTRA,"comm:buf_send");
+    memory->grow(buf_send,maxsend+bufextra,"comm:buf_send");
   else {
     memory->destroy(buf_send);
-    memory->create(buf_send,maxsend+BUFEXTRA,"comm:buf_send");
+    memory->create(buf_send,maxsend+bufextra,"comm:buf_send");
   }
 }
 
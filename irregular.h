@@ -40,6 +40,7 @@ class Irregular : protected Pointers {
   double *prd;                      // ptr to domain
 
   int maxsend,maxrecv;              // size of buffers in # of doubles
+  int bufextra;                     // extra space beyond maxsend in send buffer
   double *buf_send,*buf_recv;
 
   // plan for irregular communication of atoms
@@ -23,6 +23,7 @@
 #include "input.h"
 #include "atom.h"
 #include "domain.h"
+#include "neighbor.h"
 #include "update.h"
 #include "group.h"
 #include "input.h"
@@ -409,3 +410,134 @@ void lammps_put_coords(void *ptr, double *coords)
     }
   }
 }
+
+/* ----------------------------------------------------------------------
+   rank-local coupling interface, e.g. to a CFD solver
+   each proc only sees its owned atoms, no global gather of per-atom data
+------------------------------------------------------------------------- */
+
+int lammps_get_nlocal(void *ptr)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+  return lmp->atom->nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   return bounds of this proc's sub-domain in sublo,subhi
+   for triclinic boxes the bounds are in lamda coords (0-1)
+   returns 1 if box is triclinic, else 0
+------------------------------------------------------------------------- */
+
+int lammps_get_subdomain(void *ptr, double *sublo, double *subhi)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+  Domain *domain = lmp->domain;
+
+  for (int dim = 0; dim < 3; dim++) {
+    if (domain->triclinic) {
+      sublo[dim] = domain->sublo_lamda[dim];
+      subhi[dim] = domain->subhi_lamda[dim];
+    } else {
+      sublo[dim] = domain->sublo[dim];
+      subhi[dim] = domain->subhi[dim];
+    }
+  }
+
+  return domain->triclinic;
+}
+
+/* ----------------------------------------------------------------------
+   return pointers to this proc's per-atom arrays, no copy is made
+   x,v = 3 values per atom, radius,type,tag = 1 value per atom
+   any of the pointer args can be NULL if not wanted
+   radius is set to NULL if the atom style does not define it
+   returns nlocal = # of owned atoms, which come first in each array
+   IMPORTANT: atoms are only reordered or migrated when LAMMPS reneighbors,
+     so pointers and ordering are valid as long as
+     lammps_get_reneighbor_count() returns the same value
+------------------------------------------------------------------------- */
+
+int lammps_get_local(void *ptr, double **x, double **v, double **radius,
+                     int **type, int **tag)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+  Atom *atom = lmp->atom;
+
+  if (x) *x = atom->x ? atom->x[0] : NULL;
+  if (v) *v = atom->v ? atom->v[0] : NULL;
+  if (radius) *radius = atom->radius_flag ? atom->radius : NULL;
+  if (type) *type = atom->type;
+  if (tag) *tag = atom->tag;
+
+  return atom->nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   # of times neighbor lists have been built
+   a change means atoms may have been reordered or moved to other procs
+------------------------------------------------------------------------- */
+
+int lammps_get_reneighbor_count(void *ptr)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+  return lmp->neighbor->ncalls;
+}
+
+/* ----------------------------------------------------------------------
+   return pointer to per-atom exchange array of fix couple/cfd with ID
+   4 values per owned atom: drag force fx,fy,fz and heat source
+   caller writes into it directly, the fix adds the drag force every step
+   and migrates the values with their atoms
+   returns NULL if fix is not found or is not a fix couple/cfd
+   same validity rules as lammps_get_local()
+------------------------------------------------------------------------- */
+
+double *lammps_get_cfd_exchange(void *ptr, char *id)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+
+  int ifix = lmp->modify->find_fix(id);
+  if (ifix < 0) return NULL;
+  Fix *fix = lmp->modify->fix[ifix];
+  if (strcmp(fix->style,"couple/cfd") != 0) return NULL;
+
+  double **cfd = fix->array_atom;
+  if (cfd == NULL) return NULL;
+  return cfd[0];
+}
+
+/* ----------------------------------------------------------------------
+   map this proc's owned atoms to cells of a regular CFD grid
+   grid spans lo to hi with ncell[3] cells in each dim, x index fastest
+   cell[i] = index of cell containing atom i, -1 if outside grid
+   cell must have room for nlocal values
+   returns # of owned atoms outside the grid
+------------------------------------------------------------------------- */
+
+int lammps_map_cells(void *ptr, double *lo, double *hi, int *ncell, int *cell)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+
+  double **x = lmp->atom->x;
+  int nlocal = lmp->atom->nlocal;
+
+  double delinv[3];
+  for (int dim = 0; dim < 3; dim++)
+    delinv[dim] = ncell[dim] / (hi[dim] - lo[dim]);
+
+  int ix,iy,iz;
+  int nout = 0;
+
+  for (int i = 0; i < nlocal; i++) {
+    ix = static_cast<int> ((x[i][0] - lo[0]) * delinv[0]);
+    iy = static_cast<int> ((x[i][1] - lo[1]) * delinv[1]);
+    iz = static_cast<int> ((x[i][2] - lo[2]) * delinv[2]);
+    if (x[i][0] < lo[0] || x[i][1] < lo[1] || x[i][2] < lo[2] ||
+        ix >= ncell[0] || iy >= ncell[1] || iz >= ncell[2]) {
+      cell[i] = -1;
+      nout++;
+    } else cell[i] = (iz*ncell[1] + iy)*ncell[0] + ix;
+  }
+
+  return nout;
+}
@@ -41,6 +41,13 @@ int lammps_get_natoms(void *);
 void lammps_get_coords(void *, double *);
 void lammps_put_coords(void *, double *);
 
+int lammps_get_nlocal(void *);
+int lammps_get_subdomain(void *, double *, double *);
+int lammps_get_local(void *, double **, double **, double **, int **, int **);
+int lammps_get_reneighbor_count(void *);
+double *lammps_get_cfd_exchange(void *, char *);
+int lammps_map_cells(void *, double *, double *, int *, int *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
    See the README file in the top-level LAMMPS directory.
 ------------------------------------------------------------------------- */
 
+#include "mpi.h"
 #include "stdio.h"
 #include "string.h"
 #include "modify.h"
@@ -23,6 +24,7 @@
 #include "group.h"
 #include "update.h"
 #include "domain.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -33,6 +35,7 @@ using namespace FixConst;
 
 
 #define BIG 1.0e20
+#define FUSEBLOCK 256
 
 /* ---------------------------------------------------------------------- */
 
@@ -46,6 +49,7 @@ Modify::Modify(LAMMPS *lmp) : Pointers(lmp)
   n_initial_integrate_respa = n_post_integrate_respa = 0;
   n_pre_force_respa = n_post_force_respa = n_final_integrate_respa = 0;
   n_min_pre_exchange = n_min_pre_force = n_min_post_force = n_min_energy = 0;
+  fuse_any = 0;
 
   fix = NULL;
   fmask = NULL;
@@ -170,6 +174,19 @@ void Modify::init()
   for (i = 0; i < nfix; i++)
     if (fix[i]->restart_pbc) restart_pbc_any = 1;
 
+  // set global flag if all post_force and final_integrate fixes
+  //   can be applied to blocks of atoms in one loop
+  // not with full timing, which needs separate time for each fix
+
+  fuse_any = 0;
+  if (n_post_force && n_final_integrate && !timer->fullflag) {
+    fuse_any = 1;
+    for (i = 0; i < n_post_force; i++)
+      if (!fix[list_post_force[i]]->fuse_flag) fuse_any = 0;
+    for (i = 0; i < n_final_integrate; i++)
+      if (!fix[list_final_integrate[i]]->fuse_flag) fuse_any = 0;
+  }
+
   // create list of computes that store invocation times
 
   list_init_compute();
@@ -261,8 +278,13 @@ void Modify::setup_pre_force(int vflag)
 
 void Modify::initial_integrate(int vflag)
 {
-  for (int i = 0; i < n_initial_integrate; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_initial_integrate; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_initial_integrate[i]]->initial_integrate(vflag);
+    if (timer->fullflag)
+      fix[list_initial_integrate[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -271,8 +293,13 @@ void Modify::initial_integrate(int vflag)
 
 void Modify::post_integrate()
 {
-  for (int i = 0; i < n_post_integrate; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_post_integrate; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_post_integrate[i]]->post_integrate();
+    if (timer->fullflag)
+      fix[list_post_integrate[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -281,8 +308,13 @@ void Modify::post_integrate()
 
 void Modify::pre_exchange()
 {
-  for (int i = 0; i < n_pre_exchange; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_pre_exchange; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_pre_exchange[i]]->pre_exchange();
+    if (timer->fullflag)
+      fix[list_pre_exchange[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -291,8 +323,13 @@ void Modify::pre_exchange()
 
 void Modify::pre_neighbor()
 {
-  for (int i = 0; i < n_pre_neighbor; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_pre_neighbor; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_pre_neighbor[i]]->pre_neighbor();
+    if (timer->fullflag)
+      fix[list_pre_neighbor[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -301,8 +338,13 @@ void Modify::pre_neighbor()
 
 void Modify::pre_force(int vflag)
 {
-  for (int i = 0; i < n_pre_force; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_pre_force; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_pre_force[i]]->pre_force(vflag);
+    if (timer->fullflag)
+      fix[list_pre_force[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -311,8 +353,13 @@ void Modify::pre_force(int vflag)
 
 void Modify::post_force(int vflag)
 {
-  for (int i = 0; i < n_post_force; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_post_force; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_post_force[i]]->post_force(vflag);
+    if (timer->fullflag)
+      fix[list_post_force[i]]->time_total += MPI_Wtime() - tstart;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -321,8 +368,38 @@ void Modify::post_force(int vflag)
 
 void Modify::final_integrate()
 {
-  for (int i = 0; i < n_final_integrate; i++)
+  double tstart = 0.0;
+  for (int i = 0; i < n_final_integrate; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     fix[list_final_integrate[i]]->final_integrate();
+    if (timer->fullflag)
+      fix[list_final_integrate[i]]->time_total += MPI_Wtime() - tstart;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   post_force and 2nd half of integrate call in one pass over atoms
+   each block of atoms gets all fixes in the same order as the
+     separate calls, so results are identical
+   only called if fuse_any is set
+------------------------------------------------------------------------- */
+
+void Modify::post_force_final_integrate(int vflag)
+{
+  int i,ifirst,ilast;
+
+  for (i = 0; i < n_post_force; i++)
+    fix[list_post_force[i]]->post_force_setup(vflag);
+
+  int nlocal = atom->nlocal;
+
+  for (ifirst = 0; ifirst < nlocal; ifirst += FUSEBLOCK) {
+    ilast = MIN(ifirst+FUSEBLOCK,nlocal);
+    for (i = 0; i < n_post_force; i++)
+      fix[list_post_force[i]]->post_force_range(ifirst,ilast);
+    for (i = 0; i < n_final_integrate; i++)
+      fix[list_final_integrate[i]]->final_integrate_range(ifirst,ilast);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -332,9 +409,14 @@ void Modify::final_integrate()
 
 void Modify::end_of_step()
 {
+  double tstart = 0.0;
   for (int i = 0; i < n_end_of_step; i++)
-    if (update->ntimestep % end_of_step_every[i] == 0)
+    if (update->ntimestep % end_of_step_every[i] == 0) {
+      if (timer->fullflag) tstart = MPI_Wtime();
       fix[list_end_of_step[i]]->end_of_step();
+      if (timer->fullflag)
+	fix[list_end_of_step[i]]->time_total += MPI_Wtime() - tstart;
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -564,6 +646,20 @@ int Modify::min_reset_ref()
   return itmpall;
 }
 
+/* ----------------------------------------------------------------------
+   max distance any fix needs ghost atoms at, 0.0 if none
+------------------------------------------------------------------------- */
+
+double Modify::max_extend_cut_ghost()
+{
+  double cut = 0.0;
+  for (int i = 0; i < nfix; i++) {
+    double cut_one = fix[i]->extend_cut_ghost();
+    if (cut_one > cut) cut = cut_one;
+  }
+  return cut;
+}
+
 /* ----------------------------------------------------------------------
    add a new fix or replace one with same ID
 ------------------------------------------------------------------------- */
@@ -30,6 +30,8 @@ class Modify : protected Pointers {
   int n_min_pre_exchange,n_min_pre_force,n_min_post_force,n_min_energy;
 
   int restart_pbc_any;       // 1 if any fix sets restart_pbc
+  int fuse_any;              // 1 if post_force and final_integrate fixes
+                             //   can run as one blocked loop over atoms
   int nfix_restart_global;   // stored fix global info from restart file
   int nfix_restart_peratom;  // stored fix peratom info from restart file
 
@@ -55,6 +57,7 @@ class Modify : protected Pointers {
   virtual void pre_force(int);
   virtual void post_force(int);
   virtual void final_integrate();
+  void post_force_final_integrate(int);
   virtual void end_of_step();
   virtual double thermo_energy();
   virtual void post_run();
@@ -81,6 +84,8 @@ class Modify : protected Pointers {
   double max_alpha(double *);
   int min_dof();
 
+  double max_extend_cut_ghost();
+
   void add_fix(int, char **, char *suffix = NULL);
   void modify_fix(int, char **);
   void delete_fix(const char *);
@@ -0,0 +1,125 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+MyPage = templated class for storing chunks of datums in pages
+  chunks are not returned to the pool individually,
+    but all at once via reset()
+  usage:
+    request one chunk of N datums at a time via get(N)
+    call reset() to invalidate all chunks and start over
+  inputs:
+    template T = one datum, e.g. int, double, struct
+    maxchunk = max # of datums in one chunk
+    pagesize = # of datums in one page, must be >= maxchunk
+  methods:
+    T *get(N) = return ptr to N contiguous datums,
+                NULL if N > maxchunk or a new page cannot be allocated
+    void reset() = invalidate all chunks, keep pages allocated
+    double size() = return total size of allocated pages in bytes
+  public variables:
+    ndatum = total # of stored datums since last reset
+    nchunk = total # of stored chunks since last reset
+------------------------------------------------------------------------- */
+
+#ifndef LMP_MY_PAGE_H
+#define LMP_MY_PAGE_H
+
+#include "stdlib.h"
+
+namespace LAMMPS_NS {
+
+template<class T>
+class MyPage {
+ public:
+  int ndatum;
+  int nchunk;
+
+  MyPage(int user_maxchunk = 1, int user_pagesize = 1024) {
+    maxchunk = user_maxchunk;
+    pagesize = user_pagesize;
+    if (pagesize < maxchunk) pagesize = maxchunk;
+
+    pages = NULL;
+    npage = 0;
+    allocate();
+    reset();
+  }
+
+  ~MyPage() {
+    for (int i = 0; i < npage; i++) free(pages[i]);
+    free(pages);
+  }
+
+  // return ptr to N contiguous datums
+  // chunk does not span pages, so waste at end of page is at most maxchunk
+
+  T *get(int n) {
+    if (n > maxchunk) return NULL;
+    ndatum += n;
+    nchunk++;
+    if (index + n <= pagesize) {
+      index += n;
+      return &page[index-n];
+    }
+    ipage++;
+    if (ipage == npage && !allocate()) {
+      ipage--;
+      return NULL;
+    }
+    page = pages[ipage];
+    index = n;
+    return &page[0];
+  }
+
+  // reset index to beginning of first page, do not free any pages
+
+  void reset() {
+    ndatum = nchunk = 0;
+    ipage = 0;
+    index = 0;
+    page = pages[ipage];
+  }
+
+  // bytes of allocated memory
+
+  double size() const {
+    double bytes = npage*sizeof(T *);
+    bytes += (double) npage*pagesize*sizeof(T);
+    return bytes;
+  }
+
+ private:
+  T **pages;       // list of allocated pages
+  T *page;         // ptr to current page
+  int npage;       // # of allocated pages
+  int ipage;       // index of current page
+  int index;       // current index on current page
+
+  int maxchunk;    // max # of datums in one requested chunk
+  int pagesize;    // # of datums in one page
+
+  int allocate() {
+    T **newpages = (T **) realloc(pages,(npage+1)*sizeof(T *));
+    if (newpages == NULL) return 0;
+    pages = newpages;
+    pages[npage] = (T *) malloc(pagesize*sizeof(T));
+    if (pages[npage] == NULL) return 0;
+    npage++;
+    return 1;
+  }
+};
+
+}
+
+#endif
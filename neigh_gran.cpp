@@ -30,15 +30,13 @@ using namespace LAMMPS_NS;
 
 void Neighbor::granular_nsq_no_newton(NeighList *list)
 {
-  int i,j,m,n,nn,bitmask;
+  int i,j,n,nn,d,dnum,bitmask;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
   int *neighptr,*touchptr;
   double *shearptr;
 
   NeighList *listgranhistory;
-  int *npartner,**partner;
-  double ***shearpartner;
   int **firsttouch;
   double **firstshear;
   int **pages_touch;
@@ -46,7 +44,6 @@ void Neighbor::granular_nsq_no_newton(NeighList *list)
 
   double **x = atom->x;
   double *radius = atom->radius;
-  int *tag = atom->tag;
   int *type = atom->type;
   int *mask = atom->mask;
   int *molecule = atom->molecule;
@@ -64,9 +61,7 @@ void Neighbor::granular_nsq_no_newton(NeighList *list)
 
   FixShearHistory *fix_history = list->fix_history;
   if (fix_history) {
-    npartner = fix_history->npartner;
-    partner = fix_history->partner;
-    shearpartner = fix_history->shearpartner;
+    dnum = fix_history->dnum;
     listgranhistory = list->listgranhistory;
     firsttouch = listgranhistory->firstneigh;
     firstshear = listgranhistory->firstdouble;
@@ -97,7 +92,7 @@ void Neighbor::granular_nsq_no_newton(NeighList *list)
     if (fix_history) {
       nn = 0;
       touchptr = &pages_touch[npage][npnt];
-      shearptr = &pages_shear[npage][3*npnt];
+      shearptr = &pages_shear[npage][dnum*npnt];
     }
 
     xtmp = x[i][0];
@@ -122,25 +117,12 @@ void Neighbor::granular_nsq_no_newton(NeighList *list)
 	neighptr[n] = j;
 
 	if (fix_history) {
-	  if (rsq < radsum*radsum) {
-	    for (m = 0; m < npartner[i]; m++)
-	      if (partner[i][m] == tag[j]) break;
-	    if (m < npartner[i]) {
-	      touchptr[n] = 1;
-	      shearptr[nn++] = shearpartner[i][m][0];
-	      shearptr[nn++] = shearpartner[i][m][1];
-	      shearptr[nn++] = shearpartner[i][m][2];
-	    } else {
-	      touchptr[n] = 0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	    }
+	  if (rsq < radsum*radsum && fix_history->lookup(i,j,&shearptr[nn])) {
+	    touchptr[n] = 1;
+	    nn += dnum;
 	  } else {
 	    touchptr[n] = 0;
-	    shearptr[nn++] = 0.0;
-	    shearptr[nn++] = 0.0;
-	    shearptr[nn++] = 0.0;
+	    for (d = 0; d < dnum; d++) shearptr[nn++] = 0.0;
 	  }
 	}
 
@@ -272,15 +254,13 @@ void Neighbor::granular_nsq_newton(NeighList *list)
 
 void Neighbor::granular_bin_no_newton(NeighList *list)
 {
-  int i,j,k,m,n,nn,ibin;
+  int i,j,k,n,nn,d,dnum,ibin;
   double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
   double radi,radsum,cutsq;
   int *neighptr,*touchptr;
   double *shearptr;
 
   NeighList *listgranhistory;
-  int *npartner,**partner;
-  double ***shearpartner;
   int **firsttouch;
   double **firstshear;
   int **pages_touch;
@@ -294,7 +274,6 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
 
   double **x = atom->x;
   double *radius = atom->radius;
-  int *tag = atom->tag;
   int *type = atom->type;
   int *mask = atom->mask;
   int *molecule = atom->molecule;
@@ -310,9 +289,7 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
 
   FixShearHistory *fix_history = list->fix_history;
   if (fix_history) {
-    npartner = fix_history->npartner;
-    partner = fix_history->partner;
-    shearpartner = fix_history->shearpartner;
+    dnum = fix_history->dnum;
     listgranhistory = list->listgranhistory;
     firsttouch = listgranhistory->firstneigh;
     firstshear = listgranhistory->firstdouble;
@@ -343,7 +320,7 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
     if (fix_history) {
       nn = 0;
       touchptr = &pages_touch[npage][npnt];
-      shearptr = &pages_shear[npage][3*npnt];
+      shearptr = &pages_shear[npage][dnum*npnt];
     }
 
     xtmp = x[i][0];
@@ -373,25 +350,13 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
 	  neighptr[n] = j;
 
 	  if (fix_history) {
-	    if (rsq < radsum*radsum) {
-	      for (m = 0; m < npartner[i]; m++)
-		if (partner[i][m] == tag[j]) break;
-	      if (m < npartner[i]) {
-		touchptr[n] = 1;
-		shearptr[nn++] = shearpartner[i][m][0];
-		shearptr[nn++] = shearpartner[i][m][1];
-		shearptr[nn++] = shearpartner[i][m][2];
-	      } else {
-		touchptr[n] = 0;
-		shearptr[nn++] = 0.0;
-		shearptr[nn++] = 0.0;
-		shearptr[nn++] = 0.0;
-	      }
+	    if (rsq < radsum*radsum && 
+		fix_history->lookup(i,j,&shearptr[nn])) {
+	      touchptr[n] = 1;
+	      nn += dnum;
 	    } else {
 	      touchptr[n] = 0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
+	      for (d = 0; d < dnum; d++) shearptr[nn++] = 0.0;
 	    }
 	  }
 
@@ -622,3 +587,384 @@ void Neighbor::granular_bin_newton_tri(NeighList *list)
 
   list->inum = inum;
 }
+
+/* ----------------------------------------------------------------------
+   granular particles
+   multi-type binned neighbor list construction with partial Newton's 3rd law
+   atom types act as size classes, type pair cutoff is sum of max radii
+   shear history must be accounted for when a neighbor pair is added
+   each owned atom i checks own bin and surrounding bins in non-Newton stencil
+   multi-type stencil is itype dependent and is distance checked
+   pair stored once if i,j are both owned and i < j
+   pair stored by me if j is ghost (also stored by proc owning j)
+------------------------------------------------------------------------- */
+
+void Neighbor::granular_multi_no_newton(NeighList *list)
+{
+  int i,j,k,n,nn,d,dnum,itype,jtype,ibin,ns;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  double radi,radsum,cutsq;
+  int *neighptr,*touchptr,*s;
+  double *shearptr,*cutnsq,*distsq;
+
+  NeighList *listgranhistory;
+  int **firsttouch;
+  double **firstshear;
+  int **pages_touch;
+  double **pages_shear;
+
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int **pages = list->pages;
+  int *nstencil_multi = list->nstencil_multi;
+  int **stencil_multi = list->stencil_multi;
+  double **distsq_multi = list->distsq_multi;
+
+  FixShearHistory *fix_history = list->fix_history;
+  if (fix_history) {
+    dnum = fix_history->dnum;
+    listgranhistory = list->listgranhistory;
+    firsttouch = listgranhistory->firstneigh;
+    firstshear = listgranhistory->firstdouble;
+    pages_touch = listgranhistory->pages;
+    pages_shear = listgranhistory->dpages;
+  }
+
+  int inum = 0;
+  int npage = 0;
+  int npnt = 0;
+
+  for (i = 0; i < nlocal; i++) {
+
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage++;
+      if (npage == list->maxpage) {
+	pages = list->add_pages();
+	if (fix_history) {
+	  pages_touch = listgranhistory->add_pages();
+	  pages_shear = listgranhistory->dpages;
+	}
+      }
+    }
+
+    n = 0;
+    neighptr = &pages[npage][npnt];
+    if (fix_history) {
+      nn = 0;
+      touchptr = &pages_touch[npage][npnt];
+      shearptr = &pages_shear[npage][dnum*npnt];
+    }
+
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    radi = radius[i];
+
+    // loop over all atoms in other bins in stencil including self
+    // only store pair if i < j
+    // skip if i,j neighbor cutoff is less than bin distance
+    // stores own/own pairs only once
+    // stores own/ghost pairs on both procs
+
+    ibin = coord2bin(x[i]);
+    s = stencil_multi[itype];
+    distsq = distsq_multi[itype];
+    cutnsq = cutneighsq[itype];
+    ns = nstencil_multi[itype];
+    for (k = 0; k < ns; k++) {
+      for (j = binhead[ibin+s[k]]; j >= 0; j = bins[j]) {
+	if (j <= i) continue;
+	jtype = type[j];
+	if (cutnsq[jtype] < distsq[k]) continue;
+	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	delx = xtmp - x[j][0];
+	dely = ytmp - x[j][1];
+	delz = ztmp - x[j][2];
+	rsq = delx*delx + dely*dely + delz*delz;
+	radsum = radi + radius[j];
+	cutsq = (radsum+skin) * (radsum+skin);
+
+	if (rsq <= cutsq) {
+	  neighptr[n] = j;
+
+	  if (fix_history) {
+	    if (rsq < radsum*radsum && 
+		fix_history->lookup(i,j,&shearptr[nn])) {
+	      touchptr[n] = 1;
+	      nn += dnum;
+	    } else {
+	      touchptr[n] = 0;
+	      for (d = 0; d < dnum; d++) shearptr[nn++] = 0.0;
+	    }
+	  }
+
+	  n++;
+	}
+      }
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    if (fix_history) {
+      firsttouch[i] = touchptr;
+      firstshear[i] = shearptr;
+    }
+    npnt += n;
+    if (n > oneatom)
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+  }
+
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   granular particles
+   multi-type binned neighbor list construction with full Newton's 3rd law
+   no shear history is allowed for this option
+   each owned atom i checks its own bin and other bins in Newton stencil
+   multi-type stencil is itype dependent and is distance checked
+   every pair stored exactly once by some processor
+------------------------------------------------------------------------- */
+
+void Neighbor::granular_multi_newton(NeighList *list)
+{
+  int i,j,k,n,itype,jtype,ibin,ns;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  double radi,radsum,cutsq;
+  int *neighptr,*s;
+  double *cutnsq,*distsq;
+
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int **pages = list->pages;
+  int *nstencil_multi = list->nstencil_multi;
+  int **stencil_multi = list->stencil_multi;
+  double **distsq_multi = list->distsq_multi;
+
+  int inum = 0;
+  int npage = 0;
+  int npnt = 0;
+
+  for (i = 0; i < nlocal; i++) {
+
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage++;
+      if (npage == list->maxpage) pages = list->add_pages();
+    }
+
+    n = 0;
+    neighptr = &pages[npage][npnt];
+
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    radi = radius[i];
+
+    // loop over rest of atoms in i's bin, ghosts are at end of linked list
+    // if j is owned atom, store it, since j is beyond i in linked list
+    // if j is ghost, only store if j coords are "above and to the right" of i
+
+    for (j = bins[i]; j >= 0; j = bins[j]) {
+      if (j >= nlocal) {
+	if (x[j][2] < ztmp) continue;
+	if (x[j][2] == ztmp) {
+	  if (x[j][1] < ytmp) continue;
+	  if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	}
+      }
+
+      jtype = type[j];
+      if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      radsum = radi + radius[j];
+      cutsq = (radsum+skin) * (radsum+skin);
+
+      if (rsq <= cutsq) neighptr[n++] = j;
+    }
+
+    // loop over all atoms in other bins in stencil, store every pair
+    // skip if i,j neighbor cutoff is less than bin distance
+
+    ibin = coord2bin(x[i]);
+    s = stencil_multi[itype];
+    distsq = distsq_multi[itype];
+    cutnsq = cutneighsq[itype];
+    ns = nstencil_multi[itype];
+    for (k = 0; k < ns; k++) {
+      for (j = binhead[ibin+s[k]]; j >= 0; j = bins[j]) {
+	jtype = type[j];
+	if (cutnsq[jtype] < distsq[k]) continue;
+	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	delx = xtmp - x[j][0];
+	dely = ytmp - x[j][1];
+	delz = ztmp - x[j][2];
+	rsq = delx*delx + dely*dely + delz*delz;
+	radsum = radi + radius[j];
+	cutsq = (radsum+skin) * (radsum+skin);
+
+	if (rsq <= cutsq) neighptr[n++] = j;
+      }
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    npnt += n;
+    if (n > oneatom)
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+  }
+
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   granular particles
+   multi-type binned neighbor list construction with Newton's 3rd law
+     for triclinic
+   no shear history is allowed for this option
+   each owned atom i checks its own bin and other bins in triclinic stencil
+   multi-type stencil is itype dependent and is distance checked
+   every pair stored exactly once by some processor
+------------------------------------------------------------------------- */
+
+void Neighbor::granular_multi_newton_tri(NeighList *list)
+{
+  int i,j,k,n,itype,jtype,ibin,ns;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  double radi,radsum,cutsq;
+  int *neighptr,*s;
+  double *cutnsq,*distsq;
+
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int **pages = list->pages;
+  int *nstencil_multi = list->nstencil_multi;
+  int **stencil_multi = list->stencil_multi;
+  double **distsq_multi = list->distsq_multi;
+
+  int inum = 0;
+  int npage = 0;
+  int npnt = 0;
+
+  for (i = 0; i < nlocal; i++) {
+
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage++;
+      if (npage == list->maxpage) pages = list->add_pages();
+    }
+
+    n = 0;
+    neighptr = &pages[npage][npnt];
+
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    radi = radius[i];
+
+    // loop over all atoms in bins, including self, in stencil
+    // skip if i,j neighbor cutoff is less than bin distance
+    // bins below self are excluded from stencil
+    // pairs for atoms j "below" i are excluded
+    // below = lower z or (equal z and lower y) or (equal zy and lower x)
+    //         (equal zyx and j <= i)
+    // latter excludes self-self interaction but allows superposed atoms
+
+    ibin = coord2bin(x[i]);
+    s = stencil_multi[itype];
+    distsq = distsq_multi[itype];
+    cutnsq = cutneighsq[itype];
+    ns = nstencil_multi[itype];
+    for (k = 0; k < ns; k++) {
+      for (j = binhead[ibin+s[k]]; j >= 0; j = bins[j]) {
+	jtype = type[j];
+	if (cutnsq[jtype] < distsq[k]) continue;
+	if (x[j][2] < ztmp) continue;
+	if (x[j][2] == ztmp) {
+	  if (x[j][1] < ytmp) continue;
+	  if (x[j][1] == ytmp) {
+	    if (x[j][0] < xtmp) continue;
+	    if (x[j][0] == xtmp && j <= i) continue;
+	  }
+	}
+
+	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	delx = xtmp - x[j][0];
+	dely = ytmp - x[j][1];
+	delz = ztmp - x[j][2];
+	rsq = delx*delx + dely*dely + delz*delz;
+	radsum = radi + radius[j];
+	cutsq = (radsum+skin) * (radsum+skin);
+
+	if (rsq <= cutsq) neighptr[n++] = j;
+      }
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    npnt += n;
+    if (n > oneatom)
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+  }
+
+  list->inum = inum;
+}
@@ -200,6 +200,29 @@ int **NeighList::add_pages(int howmany)
   return pages;
 }
 
+/* ----------------------------------------------------------------------
+   trade pages with another list with same pgsize and dnum
+   lets a caller keep the pages of this list alive while it is rebuilt
+   other list gets a page first, so this list always has one to build in
+------------------------------------------------------------------------- */
+
+void NeighList::swap_pages(NeighList *other)
+{
+  if (other->maxpage == 0) other->add_pages();
+
+  int **ptmp = pages;
+  pages = other->pages;
+  other->pages = ptmp;
+
+  double **dtmp = dpages;
+  dpages = other->dpages;
+  other->dpages = dtmp;
+
+  int ntmp = maxpage;
+  maxpage = other->maxpage;
+  other->maxpage = ntmp;
+}
+
 /* ----------------------------------------------------------------------
    copy skip info from request rq into list's iskip,ijskip
 ------------------------------------------------------------------------- */
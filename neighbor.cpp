@@ -469,7 +469,8 @@ void Neighbor::init()
     // skip: point this list at request->otherlist, copy skip info from request
     // half_from_full: point this list at preceeding full list
     // granhistory: set preceeding list's listgranhistory to this list
-    //   also set preceeding list's ptr to FixShearHistory
+    //   also set preceeding list's ptr to FixShearHistory,
+    //   matched by prefix so suffixed variants like SHEAR_HISTORY/omp work
     // respaouter: point this list at preceeding 1/2 inner/middle lists
     // pair and half: if there is a full non-occasional non-skip list
     //   change this list to half_from_full and point at the full list
@@ -499,7 +500,7 @@ void Neighbor::init()
       else if (requests[i]->granhistory) {
 	lists[i-1]->listgranhistory = lists[i];
 	for (int ifix = 0; ifix < modify->nfix; ifix++)
-	  if (strcmp(modify->fix[ifix]->style,"SHEAR_HISTORY") == 0) 
+	  if (strncmp(modify->fix[ifix]->style,"SHEAR_HISTORY",13) == 0) 
 	    lists[i-1]->fix_history = (FixShearHistory *) modify->fix[ifix];
  
       } else if (requests[i]->respaouter) {
@@ -879,8 +880,11 @@ void Neighbor::choose_build(int index, NeighRequest *rq)
 	if (newton_pair == 0) pb = &Neighbor::granular_bin_no_newton;
 	else if (triclinic == 0) pb = &Neighbor::granular_bin_newton;
 	else if (triclinic == 1) pb = &Neighbor::granular_bin_newton_tri;
-      } else if (style == MULTI)
-	error->all(FLERR,"Neighbor multi not yet enabled for granular");
+      } else if (style == MULTI) {
+	if (newton_pair == 0) pb = &Neighbor::granular_multi_no_newton;
+	else if (triclinic == 0) pb = &Neighbor::granular_multi_newton;
+	else if (triclinic == 1) pb = &Neighbor::granular_multi_newton_tri;
+      }
 
     } else if (rq->respaouter) {
       if (style == NSQ) {
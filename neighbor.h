@@ -205,6 +205,9 @@ class Neighbor : protected Pointers {
   void granular_bin_no_newton(class NeighList *);
   void granular_bin_newton(class NeighList *);
   void granular_bin_newton_tri(class NeighList *);
+  void granular_multi_no_newton(class NeighList *);
+  void granular_multi_newton(class NeighList *);
+  void granular_multi_newton_tri(class NeighList *);
 
   void respa_nsq_no_newton(class NeighList *);
   void respa_nsq_newton(class NeighList *);
@@ -326,7 +329,8 @@ This is a current restriction within LAMMPS.
 
 E: Neighbor multi not yet enabled for granular
 
-Self-explanatory.
+This is a current restriction of the OpenMP versions of the granular
+neighbor list builds.
 
 E: Neighbor multi not yet enabled for rRESPA
 
@@ -56,6 +56,10 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   one_coeff = 0;
   no_virial_fdotr_compute = 0;
   ghostneigh = 0;
+  overlap_flag = 0;
+  overlap_pass = 0;
+  ninterior = 0;
+  overlap_ncalls = -1;
 
   nextra = 0;
   pvector = NULL;
@@ -155,6 +159,7 @@ void Pair::init()
   // style-specific initialization
 
   init_style();
+  overlap_ncalls = -1;
 
   // call init_one() for each I,J
   // set cutsq for each I,J, used to neighbor
@@ -229,6 +234,41 @@ void Pair::init_list(int which, NeighList *ptr)
   list = ptr;
 }
 
+/* ----------------------------------------------------------------------
+   reorder ilist of the standard neighbor list so atoms with no ghost
+     neighbors come first, their count is ninterior
+   forces on them can be computed before ghost coords arrive
+     and while ghost forces are sent back
+   only redone after the neighbor lists are rebuilt
+------------------------------------------------------------------------- */
+
+void Pair::overlap_partition()
+{
+  if (overlap_ncalls == neighbor->ncalls) return;
+  overlap_ncalls = neighbor->ncalls;
+
+  int i,ii,jj,jnum;
+  int *jlist;
+
+  int nlocal = atom->nlocal;
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+
+  ninterior = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++)
+      if ((jlist[jj] & NEIGHMASK) >= nlocal) break;
+    if (jj < jnum) continue;
+    ilist[ii] = ilist[ninterior];
+    ilist[ninterior++] = i;
+  }
+}
+
 /* ----------------------------------------------------------------------
    mixing of pair potential prefactors (epsilon)
 ------------------------------------------------------------------------- */
@@ -48,6 +48,11 @@ class Pair : protected Pointers {
   int one_coeff;                 // 1 if allows only one coeff * * call
   int no_virial_fdotr_compute;   // 1 if does not invoke virial_fdotr_compute()
   int ghostneigh;                // 1 if pair style needs neighbors of ghosts
+  int overlap_flag;              // 1 if compute() can be split over ilist
+                                 //   cleared by derived styles that
+                                 //   override compute()
+  int overlap_pass;              // which split call this is, 0 if not split
+  int ninterior;                 // # of leading ilist atoms w/out ghost neighs
   double **cutghost;             // cutoff for each ghost pair
 
   int tail_flag;                 // pair_modify flag for LJ tail correction
@@ -84,6 +89,7 @@ class Pair : protected Pointers {
   void write_file(int, char **);
   void init_bitmap(double, double, int, int &, int &, int &, int &);
   virtual void modify_params(int, char **);
+  void overlap_partition();
 
   // need to be public, so can be called by pair_style reaxc
 
@@ -149,6 +155,7 @@ class Pair : protected Pointers {
   double THIRD;
 
   int vflag_fdotr;
+  int overlap_ncalls;            // neighbor build that ninterior is valid for
   int maxeatom,maxvatom;
 
   virtual void ev_setup(int, int);
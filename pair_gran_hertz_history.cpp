@@ -47,6 +47,36 @@ PairGranHertzHistory::PairGranHertzHistory(LAMMPS *lmp) :
     charVelflag = 0;
 }
 
+/* ----------------------------------------------------------------------
+   pre-calculate the material dependent part of the hertz model
+   unit conversion of kn, kt and dampflag are folded in here as well
+------------------------------------------------------------------------- */
+
+void PairGranHertzHistory::deriveContactModelPrefactors()
+{
+    #define LMP_GRAN_DEFS_DEFINE
+    #include "pair_gran_defs.h"
+    #undef LMP_GRAN_DEFS_DEFINE
+
+    int max_type = mpg->max_type();
+
+    for(int i=1;i< max_type+1; i++)
+    {
+        for(int j=1;j<max_type+1;j++)
+        {
+            knPrefactor[i][j] = 4./3.*Yeff[i][j] / force->nktv2p;
+            ktPrefactor[i][j] = 8.*Geff[i][j] / force->nktv2p;
+            gammanPrefactor[i][j] = -2.*sqrtFiveOverSix*betaeff[i][j]*sqrt(2.*Yeff[i][j]);
+            if (dampflag == 0) gammatPrefactor[i][j] = 0.0;
+            else gammatPrefactor[i][j] = -2.*sqrtFiveOverSix*betaeff[i][j]*sqrt(8.*Geff[i][j]);
+        }
+    }
+
+    #define LMP_GRAN_DEFS_UNDEFINE
+    #include "pair_gran_defs.h"
+    #undef LMP_GRAN_DEFS_UNDEFINE
+}
+
 /* ----------------------------------------------------------------------
    contact model parameters derived for hertz model 
 ------------------------------------------------------------------------- */
@@ -57,35 +87,24 @@ inline void PairGranHertzHistory::deriveContactModelParams(int &ip, int &jp,doub
     #include "pair_gran_defs.h"
     #undef LMP_GRAN_DEFS_DEFINE
 
+    // Sn = 2 Yeff sqrtval, St = 8 Geff sqrtval
+    // gamman = -2 sqrt(5/6) betaeff sqrt(Sn meff), same for gammat with St
+
     double reff=ri*rj/(ri+rj);
 
     double sqrtval = sqrt(reff*deltan);
+    double sqrtmeff = sqrt(sqrtval*meff);
 
-    double Sn=2.*Yeff[itype][jtype]*sqrtval;
-    double St=8.*Geff[itype][jtype]*sqrtval;
-
-    kn=4./3.*Yeff[itype][jtype]*sqrtval;
-    kt=St;
-    gamman=-2.*sqrtFiveOverSix*betaeff[itype][jtype]*sqrt(Sn*meff);
-    gammat=-2.*sqrtFiveOverSix*betaeff[itype][jtype]*sqrt(St*meff);
+    kn = knPrefactor[itype][jtype]*sqrtval;
+    kt = ktPrefactor[itype][jtype]*sqrtval;
+    gamman = gammanPrefactor[itype][jtype]*sqrtmeff;
+    gammat = gammatPrefactor[itype][jtype]*sqrtmeff;
     xmu=coeffFrict[itype][jtype];
     if(rollingflag)rmu=coeffRollFrict[itype][jtype];
 
-    if (dampflag == 0) gammat = 0.0;
-
-    // convert Kn and Kt from pressure units to force/distance^2
-    kn /= force->nktv2p;
-    kt /= force->nktv2p;
-    /* NP
-    char *testmsg=new char[200];
-    sprintf(testmsg,"Yeff=%f,reff=%f,deltan=%f, kn=%f, kt=%f, gamman=%f, gammat=%f, xmu=%f\n",Yeff, reff,deltan, kn,kt,gamman,gammat,xmu);
-    error->warning(testmsg);
-    delete []testmsg;*/
-
     #define LMP_GRAN_DEFS_UNDEFINE
     #include "pair_gran_defs.h"
     #undef LMP_GRAN_DEFS_UNDEFINE
 
     return;
 }
-
@@ -43,6 +43,7 @@ class PairGranHertzHistory : public PairGranHookeHistory {
   PairGranHertzHistory(class LAMMPS *);
 
  protected:
+   virtual void deriveContactModelPrefactors();
    virtual void deriveContactModelParams(int &, int &,double &, double &, double &,double &, double &, double &, double &,double &);
 };
 
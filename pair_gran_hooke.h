@@ -39,7 +39,6 @@ class PairGranHooke : public PairGranHookeHistory {
  public:
   friend class FixWallGranHooke;
   PairGranHooke(class LAMMPS *);
-  void compute(int, int, int);
 };
 
 }
@@ -42,6 +42,7 @@ See the README file in the top-level LAMMPS directory.
 #include "memory.h"
 #include "error.h"
 #include "fix_rigid.h"
+#include "fix_rigid_small.h"
 #include "fix_property_global.h"
 #include "mech_param_gran.h"
 #include "compute_pair_gran_local.h"
@@ -52,6 +53,16 @@ using namespace LAMMPS_NS;
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 
+#define GRAN_BLOCK 64      // neighbors per block of the contact kernel
+
+// vectorize the lane loops of the contact kernel if OpenMP 4.0 is available
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define GRAN_SIMD _Pragma("omp simd")
+#else
+#define GRAN_SIMD
+#endif
+
 /* ---------------------------------------------------------------------- */
 
 PairGranHookeHistory::PairGranHookeHistory(LAMMPS *lmp) : PairGran(lmp)
@@ -59,6 +70,7 @@ PairGranHookeHistory::PairGranHookeHistory(LAMMPS *lmp) : PairGran(lmp)
     //flag that we intend to use contact history
     history = 1;
     dnum = 3;
+    overlap_flag = 1;
 
     Yeff = NULL;
     Geff = NULL;
@@ -69,7 +81,14 @@ PairGranHookeHistory::PairGranHookeHistory(LAMMPS *lmp) : PairGran(lmp)
     coeffFrict = NULL;
     coeffRollFrict = NULL;
 
+    knPrefactor = NULL;
+    ktPrefactor = NULL;
+    gammanPrefactor = NULL;
+    gammatPrefactor = NULL;
+
     charVelflag = 1;
+
+    frs = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -110,18 +129,20 @@ inline void PairGranHookeHistory::addCohesionForce(int &ip, int &jp,double &r, d
 
 inline void PairGranHookeHistory::deriveContactModelParams(int &ip, int &jp,double &meff,double &deltan, double &kn, double &kt, double &gamman, double &gammat, double &xmu, double &rmu) 
 {
+    // kn = 16/15 Yeff sqrt(reff) (15 meff charVel^2 / (16 sqrt(reff) Yeff))^(1/5)
+    //    = knPrefactor * (reff^2 meff)^(1/5)
+    // gamman = sqrt(4 meff kn / (1 + (pi/log(e))^2)) factorizes the same way
+
     double reff=ri*rj/(ri+rj);
-    kn = 16./15.*sqrt(reff)*(Yeff[itype][jtype])*pow(15.*meff*charVel*charVel/(16.*sqrt(reff)*Yeff[itype][jtype]),0.2);
-    kt = kn;
-    gamman=sqrt(4.*meff*kn/(1.+(M_PI/coeffRestLog[itype][jtype])*(M_PI/coeffRestLog[itype][jtype])));
-    gammat=gamman;
+    double polyhooke = pow(reff*reff*meff,0.2);
+    double sqrtmeff = sqrt(meff*polyhooke);
+
+    kn = knPrefactor[itype][jtype]*polyhooke;
+    kt = ktPrefactor[itype][jtype]*polyhooke;
+    gamman = gammanPrefactor[itype][jtype]*sqrtmeff;
+    gammat = gammatPrefactor[itype][jtype]*sqrtmeff;
     xmu=coeffFrict[itype][jtype];
     if(rollingflag)rmu=coeffRollFrict[itype][jtype];
-    if (dampflag == 0) gammat = 0.0;
-
-    // convert Kn and Kt from pressure units to force/distance^2
-    kn /= force->nktv2p;
-    kt /= force->nktv2p;
 
     return;
 }
@@ -133,26 +154,110 @@ inline void PairGranHookeHistory::deriveContactModelParams(int &ip, int &jp,doub
 /* ---------------------------------------------------------------------- */
 
 void PairGranHookeHistory::compute(int eflag, int vflag,int addflag)
+{
+  if (eflag || vflag) ev_setup(eflag,vflag);
+  else evflag = vflag_fdotr = 0;
+
+  // later calls of a compute split by communicate overlap
+  // still have to update the shear of their own contacts
+
+  if (update->ntimestep > laststep || overlap_pass > 1) shearupdate = 1;
+  else shearupdate = 0;
+
+  // choose the kernel instantiation once per call
+  // so the model options do not branch inside the neighbor loop
+
+  if (history) {
+    if (evflag) {
+      if (shearupdate) compute_dispatch<1,1,1>(addflag);
+      else compute_dispatch<1,1,0>(addflag);
+    } else {
+      if (shearupdate) compute_dispatch<1,0,1>(addflag);
+      else compute_dispatch<1,0,0>(addflag);
+    }
+    laststep = update->ntimestep;
+  } else {
+    if (evflag) compute_dispatch<0,1,0>(addflag);
+    else compute_dispatch<0,0,0>(addflag);
+    if (vflag_fdotr) virial_compute();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE>
+void PairGranHookeHistory::compute_dispatch(int addflag)
+{
+  if (rollingflag) {
+    if (cohesionflag) compute_dispatch_mass<HISTORYFLAG,EVFLAG,SHEARUPDATE,1,1>(addflag);
+    else compute_dispatch_mass<HISTORYFLAG,EVFLAG,SHEARUPDATE,1,0>(addflag);
+  } else {
+    if (cohesionflag) compute_dispatch_mass<HISTORYFLAG,EVFLAG,SHEARUPDATE,0,1>(addflag);
+    else compute_dispatch_mass<HISTORYFLAG,EVFLAG,SHEARUPDATE,0,0>(addflag);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE, int ROLLINGFLAG, int COHESIONFLAG>
+void PairGranHookeHistory::compute_dispatch_mass(int addflag)
+{
+  if (atom->rmass) {
+    if (fr) compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,1,1>(addflag);
+    else if (frs) compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,1,2>(addflag);
+    else compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,1,0>(addflag);
+  } else {
+    if (fr) compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,0,1>(addflag);
+    else if (frs) compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,0,2>(addflag);
+    else compute_eval<HISTORYFLAG,EVFLAG,SHEARUPDATE,ROLLINGFLAG,COHESIONFLAG,0,0>(addflag);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   granular force kernel shared by gran/hooke, gran/hooke/history and
+   gran/hertz/history and their derived styles
+   HISTORYFLAG = 1 for shear history, 0 for velocity based friction (hooke)
+   RMASSFLAG = 1 for per-atom mass
+   RIGIDFLAG = 1 if fix rigid is present, 2 if fix rigid/small is,
+     then atoms in a body use the mass of the whole body
+   the neighbors of each atom are processed in blocks of GRAN_BLOCK:
+   (1) overlap test for all lanes of the block, vectorized
+   (2) touching lanes are packed into contiguous arrays, and the
+       per-contact model parameters are evaluated via the virtual hooks
+   (3) contact forces and torques of the packed lanes, vectorized
+   (4) forces, torques and shear history are scattered back in neighbor
+       order, so results match the one-neighbor-at-a-time loop
+------------------------------------------------------------------------- */
+
+template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE, int ROLLINGFLAG,
+          int COHESIONFLAG, int RMASSFLAG, int RIGIDFLAG>
+void PairGranHookeHistory::compute_eval(int addflag)
 {
   //calculated from the material properties 
   double kn,kt,gamman,gammat,xmu,rmu; 
   double Fn_coh;
 
-  int i,j,ii,jj,inum,jnum,itype,jtype;
-  double xtmp,ytmp,ztmp,delx,dely,delz,fx,fy,fz;
-  double radi,radj,radsum,rsq,r,rinv,rsqinv,reff;
-  double vr1,vr2,vr3,vnnr,vn1,vn2,vn3,vt1,vt2,vt3,wrmag;
-  double wr1,wr2,wr3;
-  double vtr1,vtr2,vtr3,vrel;
-  double meff,damp,ccel,tor1,tor2,tor3,r_torque[3],r_torque_n[3];
-  double fn,fs,fs1,fs2,fs3;
-  double shrmag,rsht, cri, crj;
+  int i,j,ii,jj,k,c,inum,jnum,jb,nb,ncontact;
+  double xtmp,ytmp,ztmp,radi,mi,mj,meff,deltan,r;
+  double vi1,vi2,vi3,wi1,wi2,wi3;
   int *ilist,*jlist,*numneigh,**firstneigh;
   int *touch,**firsttouch;
   double *shear,*allshear,**firstshear;
 
-  if (eflag || vflag) ev_setup(eflag,vflag);
-  else evflag = vflag_fdotr = 0;
+  // lanes of one neighbor block and its packed contacts
+
+  double bdelx[GRAN_BLOCK],bdely[GRAN_BLOCK],bdelz[GRAN_BLOCK];
+  double brsq[GRAN_BLOCK],bradj[GRAN_BLOCK];
+  int btouch[GRAN_BLOCK];
+
+  int cj[GRAN_BLOCK],cjj[GRAN_BLOCK];
+  double cdel[3][GRAN_BLOCK],crsq[GRAN_BLOCK],cr[GRAN_BLOCK],cradj[GRAN_BLOCK];
+  double cvj[3][GRAN_BLOCK],cwj[3][GRAN_BLOCK],cshear[3][GRAN_BLOCK];
+  double ckn[GRAN_BLOCK],ckt[GRAN_BLOCK],cgamman[GRAN_BLOCK];
+  double cgammat[GRAN_BLOCK],cxmu[GRAN_BLOCK],crmu[GRAN_BLOCK];
+  double ccoh[GRAN_BLOCK];
+  double cf[3][GRAN_BLOCK],ctor[3][GRAN_BLOCK],crtorque[3][GRAN_BLOCK];
+  double ccri[GRAN_BLOCK],ccrj[GRAN_BLOCK];
 
   double **x = atom->x;
   double **v = atom->v;
@@ -165,16 +270,26 @@ void PairGranHookeHistory::compute(int eflag, int vflag,int addflag)
   int *type = atom->type;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
 
   inum = list->inum;
+  if (inum == 0) return;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
-  firsttouch = listgranhistory->firstneigh;
-  firstshear = listgranhistory->firstdouble;
+  if (HISTORYFLAG) {
+    firsttouch = listgranhistory->firstneigh;
+    firstshear = listgranhistory->firstdouble;
+  }
 
-  if (update->ntimestep > laststep) shearupdate = 1;
-  else shearupdate = 0;
+  // per-atom 3-vectors are allocated contiguously,
+  // so neighbor lanes gather straight from the flat array
+
+  const double *xflat = x[0];
+
+  touch = NULL;
+  shear = allshear = NULL;
+  kn = kt = gamman = gammat = xmu = rmu = Fn_coh = 0.0;
 
   // loop over neighbors of my atoms
 
@@ -184,184 +299,288 @@ void PairGranHookeHistory::compute(int eflag, int vflag,int addflag)
     ytmp = x[i][1];
     ztmp = x[i][2];
     radi = radius[i];
-    touch = firsttouch[i];
-    allshear = firstshear[i];
+    vi1 = v[i][0];
+    vi2 = v[i][1];
+    vi3 = v[i][2];
+    wi1 = omega[i][0];
+    wi2 = omega[i][1];
+    wi3 = omega[i][2];
+
+    if (RMASSFLAG) mi = rmass[i];
+    else mi = mass[type[i]];
+    if (RIGIDFLAG == 1 && fr->body[i] >= 0) mi = fr->masstotal[fr->body[i]];
+    if (RIGIDFLAG == 2 && frs->bodymass[i] > 0.0) mi = frs->bodymass[i];
+
+    if (HISTORYFLAG) {
+      touch = firsttouch[i];
+      allshear = firstshear[i];
+    }
     jlist = firstneigh[i];
     jnum = numneigh[i];
 
-    for (jj = 0; jj < jnum; jj++) {
-      j = jlist[jj];
+    for (jb = 0; jb < jnum; jb += GRAN_BLOCK) {
+      nb = MIN(GRAN_BLOCK,jnum-jb);
+
+      // (1) overlap test, one lane per neighbor
+
+      GRAN_SIMD
+      for (k = 0; k < nb; k++) {
+        const int jk = jlist[jb+k];
+        const double dx = xtmp - xflat[3*jk];
+        const double dy = ytmp - xflat[3*jk+1];
+        const double dz = ztmp - xflat[3*jk+2];
+        const double rsq = dx*dx + dy*dy + dz*dz;
+        const double radsum = radi + radius[jk];
+        bdelx[k] = dx;
+        bdely[k] = dy;
+        bdelz[k] = dz;
+        brsq[k] = rsq;
+        bradj[k] = radius[jk];
+        btouch[k] = rsq < radsum*radsum;
+      }
 
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx*delx + dely*dely + delz*delz;
-      radj = radius[j];
-      radsum = radi + radj;
+      // (2) pack touching lanes, unset non-touching neighbors
+
+      ncontact = 0;
+      for (k = 0; k < nb; k++) {
+        jj = jb + k;
+        if (!btouch[k]) {
+          if (HISTORYFLAG) {
+            touch[jj] = 0;
+            shear = &allshear[dnum*jj];
+            shear[0] = 0.0;
+            shear[1] = 0.0;
+            shear[2] = 0.0;
+          }
+          continue;
+        }
 
-      if (rsq >= radsum*radsum) {
+        j = jlist[jj];
+        cj[ncontact] = j;
+        cjj[ncontact] = jj;
+        cdel[0][ncontact] = bdelx[k];
+        cdel[1][ncontact] = bdely[k];
+        cdel[2][ncontact] = bdelz[k];
+        crsq[ncontact] = brsq[k];
+        cradj[ncontact] = bradj[k];
+        r = sqrt(brsq[k]);
+        cr[ncontact] = r;
+        deltan = radi + bradj[k] - r;
+
+        cvj[0][ncontact] = v[j][0];
+        cvj[1][ncontact] = v[j][1];
+        cvj[2][ncontact] = v[j][2];
+        cwj[0][ncontact] = omega[j][0];
+        cwj[1][ncontact] = omega[j][1];
+        cwj[2][ncontact] = omega[j][2];
+        if (HISTORYFLAG) {
+          shear = &allshear[dnum*jj];
+          cshear[0][ncontact] = shear[0];
+          cshear[1][ncontact] = shear[1];
+          cshear[2][ncontact] = shear[2];
+        }
 
-	// unset non-touching neighbors
+        // model parameters stay scalar, derived styles override them
 
-        touch[jj] = 0;
-        shear = &allshear[dnum*jj];
-        shear[0] = 0.0;
-        shear[1] = 0.0;
-        shear[2] = 0.0;
+        if (RMASSFLAG) mj = rmass[j];
+        else mj = mass[type[j]];
+        if (RIGIDFLAG == 1 && fr->body[j] >= 0) mj = fr->masstotal[fr->body[j]];
+        if (RIGIDFLAG == 2 && frs->bodymass[j] > 0.0) mj = frs->bodymass[j];
 
-      } else {
-        r = sqrt(rsq);
-        rinv = 1.0/r;
-        rsqinv = 1.0/rsq;
+        meff = mi*mj/(mi+mj);
+        if (mask[i] & freeze_group_bit) meff = mj;
+        if (mask[j] & freeze_group_bit) meff = mi;
+
+        deriveContactModelParams(i,j,meff,deltan,kn,kt,gamman,gammat,xmu,rmu);	 //modified C.K
+        ckn[ncontact] = kn;
+        ckt[ncontact] = kt;
+        cgamman[ncontact] = gamman;
+        cgammat[ncontact] = gammat;
+        cxmu[ncontact] = xmu;
+        crmu[ncontact] = rmu;
+
+        if (COHESIONFLAG) {
+          addCohesionForce(i,j,r,Fn_coh);
+          ccoh[ncontact] = Fn_coh;
+        }
+
+        ncontact++;
+      }
+
+      // (3) contact forces and torques, one lane per contact
+
+      GRAN_SIMD
+      for (c = 0; c < ncontact; c++) {
+        const double delx = cdel[0][c];
+        const double dely = cdel[1][c];
+        const double delz = cdel[2][c];
+        const double rc = cr[c];
+        const double rinv = 1.0/rc;
+        const double rsqinv = 1.0/crsq[c];
 
         // relative translational velocity
 
-        vr1 = v[i][0] - v[j][0];
-        vr2 = v[i][1] - v[j][1];
-        vr3 = v[i][2] - v[j][2];
+        const double vr1 = vi1 - cvj[0][c];
+        const double vr2 = vi2 - cvj[1][c];
+        const double vr3 = vi3 - cvj[2][c];
 
         // normal component
 
-        vnnr = vr1*delx + vr2*dely + vr3*delz;
-        vn1 = delx*vnnr * rsqinv;
-        vn2 = dely*vnnr * rsqinv;
-        vn3 = delz*vnnr * rsqinv;
+        const double vnnr = vr1*delx + vr2*dely + vr3*delz;
+        const double vn1 = delx*vnnr * rsqinv;
+        const double vn2 = dely*vnnr * rsqinv;
+        const double vn3 = delz*vnnr * rsqinv;
 
         // tangential component
 
-        vt1 = vr1 - vn1;
-        vt2 = vr2 - vn2;
-        vt3 = vr3 - vn3;
+        const double vt1 = vr1 - vn1;
+        const double vt2 = vr2 - vn2;
+        const double vt3 = vr3 - vn3;
 
         // relative rotational velocity
 
-        double deltan=radsum-r;
-        cri = radi-0.5*deltan;
-        crj = radj-0.5*deltan;
-        wr1 = (cri*omega[i][0] + crj*omega[j][0]) * rinv;
-        wr2 = (cri*omega[i][1] + crj*omega[j][1]) * rinv;
-        wr3 = (cri*omega[i][2] + crj*omega[j][2]) * rinv;
+        const double dn = radi + cradj[c] - rc;
+        const double cri = radi-0.5*dn;
+        const double crj = cradj[c]-0.5*dn;
+        const double wr1 = (cri*wi1 + crj*cwj[0][c]) * rinv;
+        const double wr2 = (cri*wi2 + crj*cwj[1][c]) * rinv;
+        const double wr3 = (cri*wi3 + crj*cwj[2][c]) * rinv;
 
         // normal forces = Hookian contact + normal velocity damping
 
-        double mi,mj;
-        if (rmass) {
-          mi = rmass[i];
-          mj = rmass[j];
-        } else {
-          itype = type[i];
-          jtype = type[j];
-          mi = mass[itype];
-          mj = mass[jtype];
-        }
-        if (fr)
-        {
-           if(fr->body[i] >= 0) mi = fr->masstotal[fr->body[i]];  
-           if(fr->body[j] >= 0) mj = fr->masstotal[fr->body[j]];  
-        }
-
-        meff = mi*mj/(mi+mj);
-        if (mask[i] & freeze_group_bit) meff = mj;
-        if (mask[j] & freeze_group_bit) meff = mi;
-
-        deriveContactModelParams(i,j,meff,deltan,kn,kt,gamman,gammat,xmu,rmu);	 //modified C.K
-
-        damp = gamman*vnnr*rsqinv;  
-        ccel = kn*(radsum-r)*rinv - damp;
-        
-        if (cohesionflag) { 
-            addCohesionForce(i,j,r,Fn_coh);
-            ccel-=Fn_coh*rinv;
-        }
+        const double damp = cgamman[c]*vnnr*rsqinv;
+        double ccel = ckn[c]*dn*rinv - damp;
+        if (COHESIONFLAG) ccel -= ccoh[c]*rinv;
 
         // relative velocities
 
-        vtr1 = vt1 - (delz*wr2-dely*wr3);
-        vtr2 = vt2 - (delx*wr3-delz*wr1);
-        vtr3 = vt3 - (dely*wr1-delx*wr2);
-        vrel = vtr1*vtr1 + vtr2*vtr2 + vtr3*vtr3;
-        vrel = sqrt(vrel);
+        const double vtr1 = vt1 - (delz*wr2-dely*wr3);
+        const double vtr2 = vt2 - (delx*wr3-delz*wr1);
+        const double vtr3 = vt3 - (dely*wr1-delx*wr2);
 
-        // shear history effects
+        double fs1,fs2,fs3;
+        const double fn = cxmu[c] * fabs(ccel*rc);
 
-        touch[jj] = 1;
+        if (HISTORYFLAG) {
 
-        shear = &allshear[dnum*jj];
+          // shear history effects
 
-        if (shearupdate && addflag)
-        {
-            shear[0] += vtr1*dt;
-            shear[1] += vtr2*dt;
-            shear[2] += vtr3*dt;
+          double sh1 = cshear[0][c];
+          double sh2 = cshear[1][c];
+          double sh3 = cshear[2][c];
+
+          if (SHEARUPDATE && addflag) {
+            sh1 += vtr1*dt;
+            sh2 += vtr2*dt;
+            sh3 += vtr3*dt;
 
             // rotate shear displacements
 
-            rsht = shear[0]*delx + shear[1]*dely + shear[2]*delz;
-            rsht *= rsqinv;
-            shear[0] -= rsht*delx;
-            shear[1] -= rsht*dely;
-            shear[2] -= rsht*delz;
-        }
+            const double rsht = (sh1*delx + sh2*dely + sh3*delz) * rsqinv;
+            sh1 -= rsht*delx;
+            sh2 -= rsht*dely;
+            sh3 -= rsht*delz;
+          }
 
-        shrmag = sqrt(shear[0]*shear[0] + shear[1]*shear[1] +  shear[2]*shear[2]);
+          const double shrmag = sqrt(sh1*sh1 + sh2*sh2 + sh3*sh3);
 
-        // tangential forces = shear + tangential velocity damping
+          // tangential forces = shear + tangential velocity damping
 
-        fs1 = - (kt*shear[0]);
-        fs2 = - (kt*shear[1]);
-        fs3 = - (kt*shear[2]);
+          fs1 = - (ckt[c]*sh1);
+          fs2 = - (ckt[c]*sh2);
+          fs3 = - (ckt[c]*sh3);
 
-        // rescale frictional displacements and forces if needed
+          // rescale frictional displacements and forces if needed
 
-        fs = sqrt(fs1*fs1 + fs2*fs2 + fs3*fs3);
-        fn = xmu * fabs(ccel*r);
+          const double fs = sqrt(fs1*fs1 + fs2*fs2 + fs3*fs3);
 
-        // energy loss from sliding or damping
-        if (fs > fn) {
+          if (fs > fn) {
             if (shrmag != 0.0) {
-                fs1 *= fn/fs;
-                fs2 *= fn/fs;
-                fs3 *= fn/fs;
-                shear[0] = -fs1/kt;
-                shear[1] = -fs2/kt;
-                shear[2] = -fs3/kt;
-            }
-            else fs1 = fs2 = fs3 = 0.0;
-        }
-        else
-        {
-            fs1 -= (gammat*vtr1);
-            fs2 -= (gammat*vtr2);
-            fs3 -= (gammat*vtr3);
+              fs1 *= fn/fs;
+              fs2 *= fn/fs;
+              fs3 *= fn/fs;
+              sh1 = -fs1/ckt[c];
+              sh2 = -fs2/ckt[c];
+              sh3 = -fs3/ckt[c];
+            } else fs1 = fs2 = fs3 = 0.0;
+          } else {
+            fs1 -= (cgammat[c]*vtr1);
+            fs2 -= (cgammat[c]*vtr2);
+            fs3 -= (cgammat[c]*vtr3);
+          }
+
+          cshear[0][c] = sh1;
+          cshear[1][c] = sh2;
+          cshear[2][c] = sh3;
+
+        } else {
+
+          // force normalization
+
+          const double vrel = sqrt(vtr1*vtr1 + vtr2*vtr2 + vtr3*vtr3);
+          const double fs = cgammat[c]*vrel;
+          double ft = 0.0;
+          if (vrel != 0.0) ft = MIN(fn,fs) / vrel;
+
+          // tangential force due to tangential velocity damping
+
+          fs1 = -ft*vtr1;
+          fs2 = -ft*vtr2;
+          fs3 = -ft*vtr3;
         }
 
         // forces & torques
 
-        fx = delx*ccel + fs1;
-        fy = dely*ccel + fs2;
-        fz = delz*ccel + fs3;
-
-        tor1 = rinv * (dely*fs3 - delz*fs2);
-        tor2 = rinv * (delz*fs1 - delx*fs3);
-        tor3 = rinv * (delx*fs2 - dely*fs1);
+        cf[0][c] = delx*ccel + fs1;
+        cf[1][c] = dely*ccel + fs2;
+        cf[2][c] = delz*ccel + fs3;
+
+        ctor[0][c] = rinv * (dely*fs3 - delz*fs2);
+        ctor[1][c] = rinv * (delz*fs1 - delx*fs3);
+        ctor[2][c] = rinv * (delx*fs2 - dely*fs1);
+        ccri[c] = cri;
+        ccrj[c] = crj;
+
+        // add rolling friction torque, without its normal (torsion) part
+
+        if (ROLLINGFLAG) {
+          const double reff = radi*cradj[c]/(radi+cradj[c]);
+          const double wrmag = sqrt(wr1*wr1+wr2*wr2+wr3*wr3);
+          double rt1 = 0.0, rt2 = 0.0, rt3 = 0.0;
+          if (wrmag > 0.) {
+            const double rscale = crmu[c]*ckn[c]*dn/wrmag*reff;
+            rt1 = rscale*wr1;
+            rt2 = rscale*wr2;
+            rt3 = rscale*wr3;
+          }
+          crtorque[0][c] = rt1 - rt1 * delx * rinv;
+          crtorque[1][c] = rt2 - rt2 * dely * rinv;
+          crtorque[2][c] = rt3 - rt3 * delz * rinv;
+        } else {
+          crtorque[0][c] = 0.0;
+          crtorque[1][c] = 0.0;
+          crtorque[2][c] = 0.0;
+        }
+      }
 
-        // add rolling friction torque
-        vectorZeroize3D(r_torque);
-        if(rollingflag)
-        {
-            reff=radi*radj/(radi+radj);
-            wrmag = sqrt(wr1*wr1+wr2*wr2+wr3*wr3);
-            if (wrmag > 0.)
-            {
-                r_torque[0] = rmu*kn*deltan*wr1/wrmag*reff;
-                r_torque[1] = rmu*kn*deltan*wr2/wrmag*reff;
-                r_torque[2] = rmu*kn*deltan*wr3/wrmag*reff;
-            }
-            // remove normal (torsion) part of torque
-            r_torque_n[0] = r_torque[0] * delx * rinv;
-            r_torque_n[1] = r_torque[1] * dely * rinv;
-            r_torque_n[2] = r_torque[2] * delz * rinv;
-            vectorSubtract3D(r_torque,r_torque_n,r_torque);
+      // (4) scatter in neighbor order
+
+      for (c = 0; c < ncontact; c++) {
+        j = cj[c];
+        const double fx = cf[0][c];
+        const double fy = cf[1][c];
+        const double fz = cf[2][c];
+        const double tor1 = ctor[0][c];
+        const double tor2 = ctor[1][c];
+        const double tor3 = ctor[2][c];
+
+        if (HISTORYFLAG) {
+          jj = cjj[c];
+          touch[jj] = 1;
+          shear = &allshear[dnum*jj];
+          shear[0] = cshear[0][c];
+          shear[1] = cshear[1][c];
+          shear[2] = cshear[2][c];
         }
 
         if(addflag)
@@ -369,28 +588,30 @@ void PairGranHookeHistory::compute(int eflag, int vflag,int addflag)
             f[i][0] += fx;
             f[i][1] += fy;
             f[i][2] += fz;
-            torque[i][0] -= cri*tor1 + r_torque[0];
-            torque[i][1] -= cri*tor2 + r_torque[1];
-            torque[i][2] -= cri*tor3 + r_torque[2];
+            torque[i][0] -= ccri[c]*tor1 + crtorque[0][c];
+            torque[i][1] -= ccri[c]*tor2 + crtorque[1][c];
+            torque[i][2] -= ccri[c]*tor3 + crtorque[2][c];
         }
 
-        if (j < nlocal && addflag) {
+        // history styles require newton pair off
+
+        if (addflag && ((!HISTORYFLAG && newton_pair) || j < nlocal)) {
           f[j][0] -= fx;
           f[j][1] -= fy;
           f[j][2] -= fz;
-          torque[j][0] -= crj*tor1 + r_torque[0];
-          torque[j][1] -= crj*tor2 + r_torque[1];
-          torque[j][2] -= crj*tor3 + r_torque[2];
+          torque[j][0] -= ccrj[c]*tor1 + crtorque[0][c];
+          torque[j][1] -= ccrj[c]*tor2 + crtorque[1][c];
+          torque[j][2] -= ccrj[c]*tor3 + crtorque[2][c];
         }
 
         if(cpl && !addflag) cpl->add_pair(i,j,fx,fy,fz,tor1,tor2,tor3,shear);
 
-        if (evflag) ev_tally_xyz(i,j,nlocal,0,0.0,0.0,fx,fy,fz,delx,dely,delz);
+        if (EVFLAG) ev_tally_xyz(i,j,nlocal,HISTORYFLAG ? 0 : newton_pair,
+                                 0.0,0.0,fx,fy,fz,
+                                 cdel[0][c],cdel[1][c],cdel[2][c]);
       }
     }
   }
-
-  laststep = update->ntimestep;
 }
 
 /* ----------------------------------------------------------------------
@@ -463,6 +684,46 @@ void PairGranHookeHistory::init_substyle()
   }
 
   if(charVelflag) charVel = charVel1->compute_scalar();
+
+  // bodies of fix rigid/small set the effective mass of their atoms
+  // bodymass of ghost atoms is valid once the fix ran pre_neighbor()
+
+  frs = NULL;
+  for(int ifix = 0; ifix < modify->nfix; ifix++)
+      if(strcmp(modify->fix[ifix]->style,"rigid/small") == 0)
+          frs = static_cast<FixRigidSmall*>(modify->fix[ifix]);
+
+  // init_substyle() is invoked on every init, so the prefactors
+  // are rebuilt whenever the property/global fixes are redefined
+
+  deriveContactModelPrefactors();
+}
+
+/* ----------------------------------------------------------------------
+   pre-calculate the material dependent part of the contact model
+   so that deriveContactModelParams() only has to apply the size
+   and mass dependence for each contact
+   unit conversion of kn, kt and dampflag are folded in here as well
+------------------------------------------------------------------------- */
+
+void PairGranHookeHistory::deriveContactModelPrefactors()
+{
+  int max_type = mpg->max_type();
+
+  for(int i=1;i< max_type+1; i++)
+  {
+      for(int j=1;j<max_type+1;j++)
+      {
+          double kn_raw = 16./15.*Yeff[i][j]*pow(15.*charVel*charVel/(16.*Yeff[i][j]),0.2);
+          double pilog = M_PI/coeffRestLog[i][j];
+
+          knPrefactor[i][j] = kn_raw / force->nktv2p;
+          ktPrefactor[i][j] = knPrefactor[i][j];
+          gammanPrefactor[i][j] = sqrt(4.*kn_raw/(1.+pilog*pilog));
+          if (dampflag == 0) gammatPrefactor[i][j] = 0.0;
+          else gammatPrefactor[i][j] = gammanPrefactor[i][j];
+      }
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -479,6 +740,10 @@ void PairGranHookeHistory::allocate_properties(int size)
     memory->destroy_2d_double_array(coeffRestLog);
     memory->destroy_2d_double_array(coeffFrict);
     memory->destroy_2d_double_array(coeffRollFrict);
+    memory->destroy_2d_double_array(knPrefactor);
+    memory->destroy_2d_double_array(ktPrefactor);
+    memory->destroy_2d_double_array(gammanPrefactor);
+    memory->destroy_2d_double_array(gammatPrefactor);
     Yeff = memory->create_2d_double_array(size+1,size+1,"Yeff");
     Geff = memory->create_2d_double_array(size+1,size+1,"Geff");
     betaeff = memory->create_2d_double_array(size+1,size+1,"betaeff");
@@ -487,6 +752,10 @@ void PairGranHookeHistory::allocate_properties(int size)
     coeffRestLog = memory->create_2d_double_array(size+1,size+1,"coeffRestLog");
     coeffFrict = memory->create_2d_double_array(size+1,size+1,"coeffFrict");
     coeffRollFrict = memory->create_2d_double_array(size+1,size+1,"coeffRollFrict");
+    knPrefactor = memory->create_2d_double_array(size+1,size+1,"knPrefactor");
+    ktPrefactor = memory->create_2d_double_array(size+1,size+1,"ktPrefactor");
+    gammanPrefactor = memory->create_2d_double_array(size+1,size+1,"gammanPrefactor");
+    gammatPrefactor = memory->create_2d_double_array(size+1,size+1,"gammatPrefactor");
 }
 
 /* ----------------------------------------------------------------------
@@ -68,11 +68,28 @@ class PairGranHookeHistory : public PairGran {
 
   double **Yeff,**Geff,**betaeff,**veff,**cohEnergyDens,**coeffRestLog,**coeffFrict,charVel,**coeffRollFrict;
 
+  // per type pair prefactors of kn, kt, gamman, gammat
+  // only the size dependent part is evaluated per contact
+  double **knPrefactor,**ktPrefactor,**gammanPrefactor,**gammatPrefactor;
+
+  virtual void deriveContactModelPrefactors();
   virtual void deriveContactModelParams(int &, int &,double &, double &, double &,double &, double &, double &, double &,double &);
   virtual void addCohesionForce(int &, int &,double &,double &);
 
   int cohesionflag; 
   int dampflag,rollingflag; 
+
+  class FixRigidSmall *frs;   // fix rigid/small, bodies set effective mass
+
+  // force kernel, specialized at compile time for the model options
+
+  template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE>
+  void compute_dispatch(int);
+  template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE, int ROLLINGFLAG, int COHESIONFLAG>
+  void compute_dispatch_mass(int);
+  template <int HISTORYFLAG, int EVFLAG, int SHEARUPDATE, int ROLLINGFLAG,
+            int COHESIONFLAG, int RMASSFLAG, int RIGIDFLAG>
+  void compute_eval(int);
 };
 
 }
@@ -35,6 +35,7 @@
 #include "error.h"
 #include "memory.h"
 #include "special.h"
+#include "irregular.h"
 
 using namespace LAMMPS_NS;
 
@@ -115,10 +116,12 @@ void ReadData::command(int narg, char **arg)
 
   // read header info
 
+  datafile = arg[0];
   if (me == 0) {
     if (screen) fprintf(screen,"Reading data file ...\n");
     open(arg[0]);
   }
+  MPI_Bcast(&compressed,1,MPI_INT,0,world);
   header(1);
   domain->box_exist = 1;
 
@@ -476,24 +479,29 @@ void ReadData::atoms()
   bigint nread = 0;
   bigint natoms = atom->natoms;
 
-  while (nread < natoms) {
-    if (natoms-nread > CHUNK) nchunk = CHUNK;
-    else nchunk = natoms-nread;
-    if (me == 0) {
-      char *eof;
-      m = 0;
-      for (i = 0; i < nchunk; i++) {
-	eof = fgets(&buffer[m],MAXLINE,fp);
-	if (eof == NULL) error->one(FLERR,"Unexpected end of data file");
-	m += strlen(&buffer[m]);
+  // uncompressed file can be read in parallel, else proc 0 reads and bcasts
+
+  if (comm->nprocs > 1 && !compressed) atoms_parallel();
+  else {
+    while (nread < natoms) {
+      if (natoms-nread > CHUNK) nchunk = CHUNK;
+      else nchunk = natoms-nread;
+      if (me == 0) {
+	char *eof;
+	m = 0;
+	for (i = 0; i < nchunk; i++) {
+	  eof = fgets(&buffer[m],MAXLINE,fp);
+	  if (eof == NULL) error->one(FLERR,"Unexpected end of data file");
+	  m += strlen(&buffer[m]);
+	}
+	m++;
       }
-      m++;
-    }
-    MPI_Bcast(&m,1,MPI_INT,0,world);
-    MPI_Bcast(buffer,m,MPI_CHAR,0,world);
+      MPI_Bcast(&m,1,MPI_INT,0,world);
+      MPI_Bcast(buffer,m,MPI_CHAR,0,world);
 
-    atom->data_atoms(nchunk,buffer);
-    nread += nchunk;
+      atom->data_atoms(nchunk,buffer,1);
+      nread += nchunk;
+    }
   }
 
   // check that all atoms were assigned correctly
@@ -548,6 +556,119 @@ void ReadData::atoms()
   }
 }
 
+/* ----------------------------------------------------------------------
+   read all atoms with every proc reading part of the file
+   each proc reads 1/P of the bytes from start of section to end of file,
+     a line belongs to the proc whose byte range holds its 1st char
+   scan of line counts numbers the lines, first natoms of them are atoms
+   each proc creates atoms from its lines, wherever they are in the box,
+     Irregular then migrates them to the procs that own them
+   proc 0 moves its file ptr after the last atom line for next section
+------------------------------------------------------------------------- */
+
+void ReadData::atoms_parallel()
+{
+  int nprocs = comm->nprocs;
+  bigint natoms = atom->natoms;
+
+  bigint range[2];
+  if (me == 0) {
+    range[0] = ftell(fp);
+    fseek(fp,0,SEEK_END);
+    range[1] = ftell(fp);
+  }
+  MPI_Bcast(range,2,MPI_LMP_BIGINT,0,world);
+
+  bigint lo = range[0] + (range[1]-range[0]) * me/nprocs;
+  bigint hi = range[0] + (range[1]-range[0]) * (me+1)/nprocs;
+
+  // read my range, plus preceding char to see if range starts a line,
+  //   plus upto MAXLINE chars to finish my last line
+
+  bigint start = lo;
+  if (lo > range[0]) start--;
+  bigint stop = hi + MAXLINE;
+  if (stop > range[1]) stop = range[1];
+  if (stop-start > MAXSMALLINT-2)
+    error->one(FLERR,"Data file too large to read in parallel");
+  int nchar = stop - start;
+
+  char *chunk;
+  memory->create(chunk,nchar+2,"read_data:chunk");
+  FILE *fpme = fopen(datafile,"r");
+  if (fpme == NULL) {
+    char str[128];
+    sprintf(str,"Cannot open file %s",datafile);
+    error->one(FLERR,str);
+  }
+  fseek(fpme,start,SEEK_SET);
+  nchar = fread(chunk,sizeof(char),nchar,fpme);
+  fclose(fpme);
+  if (stop == range[1] && (nchar == 0 || chunk[nchar-1] != '\n'))
+    chunk[nchar++] = '\n';
+  chunk[nchar] = '\0';
+
+  // first = offset in chunk of my first line
+  // count my lines, whose first char is before hi
+
+  int first = 0;
+  if (lo > range[0]) {
+    while (first < nchar && chunk[first] != '\n') first++;
+    first++;
+  }
+
+  int nlines = 0;
+  int next = first;
+  while (next < nchar && start+next < hi) {
+    char *ptr = strchr(&chunk[next],'\n');
+    if (ptr == NULL) error->one(FLERR,"Unexpected end of data file");
+    next = ptr - chunk + 1;
+    nlines++;
+  }
+
+  // nbefore = # of lines in ranges of lower procs
+
+  bigint nme = nlines;
+  bigint nbefore,ntotal;
+  MPI_Scan(&nme,&nbefore,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  nbefore -= nme;
+  MPI_Allreduce(&nme,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (ntotal < natoms) error->all(FLERR,"Unexpected end of data file");
+
+  // nkeep = # of my lines that are atoms
+  // proc with last atom line sets where rest of file starts
+
+  int nkeep = 0;
+  if (nbefore < natoms) {
+    if (natoms-nbefore < nlines) nkeep = natoms-nbefore;
+    else nkeep = nlines;
+  }
+
+  bigint offset = 0;
+  if (nkeep && nbefore+nkeep == natoms) {
+    next = first;
+    for (int i = 0; i < nkeep; i++)
+      next = strchr(&chunk[next],'\n') - chunk + 1;
+    offset = start + next;
+  }
+  bigint offset_all;
+  MPI_Allreduce(&offset,&offset_all,1,MPI_LMP_BIGINT,MPI_MAX,world);
+  if (me == 0) fseek(fp,offset_all,SEEK_SET);
+
+  if (nkeep) atom->data_atoms(nkeep,&chunk[first],0);
+  memory->destroy(chunk);
+
+  // move atoms to procs that own them
+  // map_init() since irregular->migrate_atoms() will do map_clear()
+
+  if (atom->map_style) atom->map_init();
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  Irregular *irregular = new Irregular(lmp);
+  irregular->migrate_atoms();
+  delete irregular;
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+}
+
 /* ----------------------------------------------------------------------
    read all velocities
    to find atoms, must build atom map if not a molecular system 
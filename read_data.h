@@ -36,6 +36,7 @@ class ReadData : protected Pointers {
   char *line,*keyword,*buffer;
   FILE *fp;
   int narg,maxarg,compressed;
+  char *datafile;            // name of data file
   char **arg;
 
   bigint nellipsoids;
@@ -54,6 +55,7 @@ class ReadData : protected Pointers {
   void parse_coeffs(char *, const char *, int);
 
   void atoms();
+  void atoms_parallel();
   void velocities();
   void bonus(bigint, class AtomVec *, const char *);
 
@@ -278,6 +280,12 @@ E: No atoms in data file
 The header of the data file indicated that atoms would be included,
 but they were not present.
 
+E: Data file too large to read in parallel
+
+The part of the data file that one processor reads, starting at the
+Atoms section, must be smaller than 2 GB.  Use more processors or a
+gzipped data file, which is read by a single processor.
+
 E: Unexpected end of data file
 
 LAMMPS hit the end of the data file while attempting to read a
@@ -55,7 +55,7 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
        BOXLO_0,BOXHI_0,BOXLO_1,BOXHI_1,BOXLO_2,BOXHI_2,
        SPECIAL_LJ_1,SPECIAL_LJ_2,SPECIAL_LJ_3,
        SPECIAL_COUL_1,SPECIAL_COUL_2,SPECIAL_COUL_3,
-       XY,XZ,YZ};
+       XY,XZ,YZ,PROCBLOCKS};
 enum{MASS};
 enum{PAIR,BOND,ANGLE,DIHEDRAL,IMPROPER};
 
@@ -120,6 +120,7 @@ void ReadRestart::command(int narg, char **arg)
   }
 
   MPI_Bcast(&swapflag,1,MPI_INT,0,world);
+  blockflag = 0;
 
   // read header info and create atom style and simulation box
 
@@ -153,6 +154,21 @@ void ReadRestart::command(int narg, char **arg)
   atom->nextra_store = nextra;
   memory->create(atom->extra,n,nextra,"atom:extra");
 
+  // file with per-proc blocks stores their sizes and offsets next
+
+  int *blocksize = NULL;
+  bigint *blockoffset = NULL;
+  if (blockflag) {
+    blocksize = new int[nprocs_file];
+    blockoffset = new bigint[nprocs_file];
+    if (me == 0) {
+      nread_int(blocksize,nprocs_file,fp);
+      nread_bigint(blockoffset,nprocs_file,fp);
+    }
+    MPI_Bcast(blocksize,nprocs_file,MPI_INT,0,world);
+    MPI_Bcast(blockoffset,nprocs_file,MPI_LMP_BIGINT,0,world);
+  }
+
   // single file:
   // nprocs_file = # of chunks in file
   // proc 0 reads chunks one at a time and bcasts it to other procs
@@ -166,7 +182,7 @@ void ReadRestart::command(int narg, char **arg)
   double *buf = NULL;
   int m;
 
-  if (multiproc == 0) {
+  if (multiproc == 0 && blockflag == 0) {
     int triclinic = domain->triclinic;
     double *x,lamda[3];
     double *coord,*sublo,*subhi;
@@ -210,12 +226,37 @@ void ReadRestart::command(int narg, char **arg)
 
     if (me == 0) fclose(fp);
 
-  // one file per proc:
-  // nprocs_file = # of files
-  // each proc reads 1/P fraction of files, keeping all atoms in the files
+  // one file per proc or single file with one block per proc:
+  // nprocs_file = # of files or blocks
+  // each proc reads 1/P fraction of files or blocks, keeping all their atoms
+  //   if same # of procs, proc reads the block it wrote
   // perform irregular comm to migrate atoms to correct procs
   // close restart file when done
 
+  } else if (blockflag) {
+    if (me == 0) fclose(fp);
+    fp = fopen(file,"rb");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open restart file %s",file);
+      error->one(FLERR,str);
+    }
+
+    for (int iproc = me; iproc < nprocs_file; iproc += nprocs) {
+      n = blocksize[iproc];
+      if (n > maxbuf) {
+	maxbuf = n;
+	memory->destroy(buf);
+	memory->create(buf,maxbuf,"read_restart:buf");
+      }
+      fseek(fp,blockoffset[iproc],SEEK_SET);
+      if (n > 0) nread_double(buf,n,fp);
+
+      m = 0;
+      while (m < n) m += avec->unpack_restart(&buf[m]);
+    }
+    fclose(fp);
+
   } else {
     if (me == 0) fclose(fp);
     char *perproc = new char[strlen(file) + 16];
@@ -246,6 +287,11 @@ void ReadRestart::command(int narg, char **arg)
     }
 
     delete [] perproc;
+  }
+
+  // migrate atoms read from per-proc files or blocks to their owners
+
+  if (multiproc || blockflag) {
 
     // create a temporary fix to hold and migrate extra atom info
     // necessary b/c irregular will migrate atoms
@@ -297,6 +343,8 @@ void ReadRestart::command(int narg, char **arg)
   // clean-up memory
 
   delete [] file;
+  delete [] blocksize;
+  delete [] blockoffset;
   memory->destroy(buf);
 
   // check that all atoms were assigned to procs
@@ -696,6 +744,9 @@ void ReadRestart::header()
       domain->triclinic = 1;
       domain->yz = read_double();
 
+    } else if (flag == PROCBLOCKS) {
+      blockflag = read_int();
+
     } else error->all(FLERR,"Invalid flag in header section of restart file");
 
     flag = read_int();
@@ -826,6 +877,17 @@ void ReadRestart::nread_char(char *buf, int n, FILE *fp)
   fread(buf,sizeof(char),n,fp);
 }
 
+/* ----------------------------------------------------------------------
+   read N bigints from restart file
+   do not bcast them, caller does that if required
+------------------------------------------------------------------------- */
+
+void ReadRestart::nread_bigint(bigint *buf, int n, FILE *fp)
+{
+  fread(buf,sizeof(bigint),n,fp);
+  if (swapflag) {}
+}
+
 /* ----------------------------------------------------------------------
    read an int from restart file and bcast it
 ------------------------------------------------------------------------- */
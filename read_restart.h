@@ -35,6 +35,7 @@ class ReadRestart : protected Pointers {
   FILE *fp;
   int nfix_restart_global,nfix_restart_peratom;
   int swapflag;
+  int blockflag;                   // 1 if file has table of per-proc blocks
 
   void file_search(char *, char *);
   void header();
@@ -44,6 +45,7 @@ class ReadRestart : protected Pointers {
   void nread_int(int *, int, FILE *);
   void nread_double(double *, int, FILE *);
   void nread_char(char *, int, FILE *);
+  void nread_bigint(bigint *, int, FILE *);
   int read_int();
   double read_double();
   char *read_char();
@@ -88,6 +88,10 @@ Thermo::Thermo(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   lostflag = ERROR;
   lostbefore = 0;
   flushflag = 0;
+  reduceflag = 1;
+
+  maxreduce = 0;
+  reduce_send = reduce_recv = NULL;
 
   // set style and corresponding lineflag
   // custom style builds its own line of keywords
@@ -160,6 +164,9 @@ Thermo::~Thermo()
 
   deallocate();
 
+  memory->destroy(reduce_send);
+  memory->destroy(reduce_recv);
+
   // format strings
 
   delete [] format_float_user;
@@ -288,15 +295,19 @@ void Thermo::compute(int flag)
   bigint ntimestep = update->ntimestep;
 
   // check for lost atoms
+  // computes that can defer their global sums share the atom count Allreduce
   // turn off normflag if natoms = 0 to avoid divide by 0
 
-  natoms = lost_check();
+  if (reduceflag) natoms = lost_check(reduce_computes());
+  else natoms = lost_check();
   if (natoms == 0) normflag = 0;
   else normflag = normvalue;
 
   // invoke Compute methods needed for thermo keywords
 
-  for (i = 0; i < ncompute; i++)
+  double tstart = 0.0;
+  for (i = 0; i < ncompute; i++) {
+    if (timer->fullflag) tstart = MPI_Wtime();
     if (compute_which[i] == SCALAR) {
       if (!(computes[i]->invoked_flag & INVOKED_SCALAR)) {
 	computes[i]->compute_scalar();
@@ -313,6 +324,8 @@ void Thermo::compute(int flag)
 	computes[i]->invoked_flag |= INVOKED_ARRAY;
       }
     }
+    if (timer->fullflag) computes[i]->time_total += MPI_Wtime() - tstart;
+  }
 
   // if lineflag = MULTILINE, prepend step/cpu header line
 
@@ -362,6 +375,15 @@ bigint Thermo::lost_check()
   bigint ntotal;
   bigint nblocal = atom->nlocal;
   MPI_Allreduce(&nblocal,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  return lost_check(ntotal);
+}
+
+/* ----------------------------------------------------------------------
+   check for lost atoms, given current number of atoms ntotal
+------------------------------------------------------------------------- */
+
+bigint Thermo::lost_check(bigint ntotal)
+{
   if (ntotal < 0 || ntotal > MAXBIGINT) 
     error->all(FLERR,"Too many total atoms");
   if (ntotal == atom->natoms) return ntotal;
@@ -400,6 +422,67 @@ bigint Thermo::lost_check()
   return ntotal;
 }
 
+/* ----------------------------------------------------------------------
+   invoke computes whose global sum can be deferred
+   their local sums and the atom count are reduced with one Allreduce
+   return current # of atoms
+------------------------------------------------------------------------- */
+
+bigint Thermo::reduce_computes()
+{
+  int i,flag;
+
+  int n = 1;
+  double tstart = 0.0;
+
+  if (maxreduce == 0) {
+    maxreduce = 1;
+    memory->grow(reduce_send,maxreduce,"thermo:reduce_send");
+    memory->grow(reduce_recv,maxreduce,"thermo:reduce_recv");
+  }
+  reduce_send[0] = atom->nlocal;
+
+  for (i = 0; i < ncompute; i++) {
+    reduce_which[i] = 0;
+    if (compute_which[i] == SCALAR) flag = INVOKED_SCALAR;
+    else if (compute_which[i] == VECTOR) flag = INVOKED_VECTOR;
+    else continue;
+    if (!(computes[i]->reduceflag & flag)) continue;
+    if (computes[i]->invoked_flag & flag) continue;
+
+    if (n + 6 + computes[i]->size_vector > maxreduce) {
+      maxreduce = n + 6 + computes[i]->size_vector;
+      memory->grow(reduce_send,maxreduce,"thermo:reduce_send");
+      memory->grow(reduce_recv,maxreduce,"thermo:reduce_recv");
+    }
+
+    if (timer->fullflag) tstart = MPI_Wtime();
+    reduce_which[i] = flag;
+    reduce_offset[i] = n;
+    n += computes[i]->reduce_pack(flag,&reduce_send[n]);
+    if (timer->fullflag) computes[i]->time_total += MPI_Wtime() - tstart;
+  }
+
+  MPI_Allreduce(reduce_send,reduce_recv,n,MPI_DOUBLE,MPI_SUM,world);
+
+  // unpack pressure computes last, since they use the temperature
+  //   computes they reference, which may be part of this batch
+
+  int pass;
+  for (pass = 0; pass < 2; pass++)
+    for (i = 0; i < ncompute; i++) {
+      if (!reduce_which[i]) continue;
+      if (computes[i]->pressflag != pass) continue;
+      if (timer->fullflag) tstart = MPI_Wtime();
+      computes[i]->reduce_unpack(reduce_which[i],
+				 &reduce_recv[reduce_offset[i]]);
+      computes[i]->invoked_flag |= reduce_which[i];
+      if (timer->fullflag) computes[i]->time_total += MPI_Wtime() - tstart;
+    }
+
+  return static_cast<bigint> (reduce_recv[0]);
+}
+
 /* ----------------------------------------------------------------------
    modify thermo parameters
 ------------------------------------------------------------------------- */
@@ -510,6 +593,13 @@ void Thermo::modify_params(int narg, char **arg)
       else error->all(FLERR,"Illegal thermo_modify command");
       iarg += 2;
 
+    } else if (strcmp(arg[iarg],"reduce") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal thermo_modify command");
+      if (strcmp(arg[iarg+1],"no") == 0) reduceflag = 0;
+      else if (strcmp(arg[iarg+1],"yes") == 0) reduceflag = 1;
+      else error->all(FLERR,"Illegal thermo_modify command");
+      iarg += 2;
+
     } else if (strcmp(arg[iarg],"line") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal thermo_modify command");
       if (strcmp(arg[iarg+1],"one") == 0) lineflag = ONELINE;
@@ -585,6 +675,8 @@ void Thermo::allocate()
   id_compute = new char*[3*n];
   compute_which = new int[3*n];
   computes = new Compute*[3*n];
+  reduce_which = new int[3*n];
+  reduce_offset = new int[3*n];
 
   nfix = 0;
   id_fix = new char*[n];
@@ -621,6 +713,8 @@ void Thermo::deallocate()
   delete [] id_compute;
   delete [] compute_which;
   delete [] computes;
+  delete [] reduce_which;
+  delete [] reduce_offset;
 
   for (int i = 0; i < nfix; i++) delete [] id_fix[i];
   delete [] id_fix;
@@ -59,6 +59,7 @@ class Thermo : protected Pointers {
   int firststep;
   int lostflag,lostbefore;
   int flushflag,lineflag;
+  int reduceflag;        // 1 if compute sums share one Allreduce
 
   double last_tpcpu,last_spcpu;
   double last_time;
@@ -87,6 +88,10 @@ class Thermo : protected Pointers {
   char **id_compute;           // their IDs
   int *compute_which;          // 0/1/2 if should call scalar,vector,array
   class Compute **computes;    // list of ptrs to the Compute objects
+  int *reduce_which;           // INVOKED_SCALAR/VECTOR if sum is batched
+  int *reduce_offset;          // where its sums start in reduce buffers
+  int maxreduce;               // size of reduce buffers
+  double *reduce_send,*reduce_recv;
 
   int nfix;                    // # of Fix objects called by thermo
   char **id_fix;               // their IDs
@@ -106,6 +111,9 @@ class Thermo : protected Pointers {
   int add_fix(const char *);
   int add_variable(const char *);
 
+  bigint lost_check(bigint);
+  bigint reduce_computes();
+
   typedef void (Thermo::*FnPtr)();
   void addfield(const char *, FnPtr, int);
   FnPtr *vfunc;                // list of ptrs to functions
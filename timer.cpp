@@ -12,8 +12,14 @@
 ------------------------------------------------------------------------- */
 
 #include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
 #include "timer.h"
+#include "modify.h"
+#include "fix.h"
+#include "compute.h"
 #include "memory.h"
+#include "error.h"
 
 using namespace LAMMPS_NS;
 
@@ -21,7 +27,12 @@ using namespace LAMMPS_NS;
 
 Timer::Timer(LAMMPS *lmp) : Pointers(lmp)
 {
+  MPI_Comm_rank(world,&me);
   memory->create(array,TIME_N,"array");
+
+  fullflag = 0;
+  logevery = 0;
+  logfp = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -29,13 +40,19 @@ Timer::Timer(LAMMPS *lmp) : Pointers(lmp)
 Timer::~Timer()
 {
   memory->destroy(array);
+  if (logfp) fclose(logfp);
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   zero all timers, including the per-fix and per-compute ones
+------------------------------------------------------------------------- */
 
 void Timer::init()
 {
   for (int i = 0; i < TIME_N; i++) array[i] = 0.0;
+  for (int i = 0; i < modify->nfix; i++) modify->fix[i]->time_total = 0.0;
+  for (int i = 0; i < modify->ncompute; i++)
+    modify->compute[i]->time_total = 0.0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -82,3 +99,105 @@ double Timer::elapsed(int which)
   double current_time = MPI_Wtime();
   return (current_time - array[which]);
 }
+
+/* ----------------------------------------------------------------------
+   timer command
+   normal = only the fixed sections are timed
+   full = also time each fix callback and each compute invoked for output
+   log N file = write cumulative timings of this run every N steps,
+     as CSV with one line per section, fix or compute
+------------------------------------------------------------------------- */
+
+void Timer::modify_params(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal timer command");
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"normal") == 0) {
+      fullflag = 0;
+      iarg++;
+    } else if (strcmp(arg[iarg],"full") == 0) {
+      fullflag = 1;
+      iarg++;
+    } else if (strcmp(arg[iarg],"log") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal timer command");
+      if (logfp) fclose(logfp);
+      logfp = NULL;
+      if (strcmp(arg[iarg+1],"none") == 0) {
+	logevery = 0;
+	iarg += 2;
+	continue;
+      }
+      if (iarg+3 > narg) error->all(FLERR,"Illegal timer command");
+      logevery = atoi(arg[iarg+1]);
+      if (logevery <= 0) error->all(FLERR,"Illegal timer command");
+      if (me == 0) {
+	logfp = fopen(arg[iarg+2],"w");
+	if (logfp == NULL) {
+	  char str[128];
+	  sprintf(str,"Cannot open timer log file %s",arg[iarg+2]);
+	  error->one(FLERR,str);
+	}
+	fprintf(logfp,"step,kind,id,style,min,avg,max\n");
+      }
+      iarg += 3;
+    } else error->all(FLERR,"Illegal timer command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   min, average and max of a time across procs
+------------------------------------------------------------------------- */
+
+void Timer::reduce(double time, double &tmin, double &tavg, double &tmax)
+{
+  int nprocs;
+  MPI_Comm_size(world,&nprocs);
+  MPI_Allreduce(&time,&tmin,1,MPI_DOUBLE,MPI_MIN,world);
+  MPI_Allreduce(&time,&tavg,1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&time,&tmax,1,MPI_DOUBLE,MPI_MAX,world);
+  tavg /= nprocs;
+}
+
+/* ----------------------------------------------------------------------
+   append cumulative timings of the current run to the timing log
+   called by all procs on multiples of logevery
+------------------------------------------------------------------------- */
+
+void Timer::write_log(bigint ntimestep)
+{
+  const char *names[TIME_N] = {"loop","pair","bond","kspace","neigh",
+			       "comm","output"};
+  double time,tmin,tavg,tmax;
+
+  // loop timer holds its start time until the run ends
+
+  for (int i = 0; i < TIME_N; i++) {
+    if (i == TIME_LOOP) time = elapsed(TIME_LOOP);
+    else time = array[i];
+    reduce(time,tmin,tavg,tmax);
+    if (me == 0)
+      fprintf(logfp,BIGINT_FORMAT ",section,%s,,%g,%g,%g\n",
+	      ntimestep,names[i],tmin,tavg,tmax);
+  }
+
+  if (fullflag) {
+    for (int i = 0; i < modify->nfix; i++) {
+      Fix *fix = modify->fix[i];
+      reduce(fix->time_total,tmin,tavg,tmax);
+      if (me == 0)
+	fprintf(logfp,BIGINT_FORMAT ",fix,%s,%s,%g,%g,%g\n",
+		ntimestep,fix->id,fix->style,tmin,tavg,tmax);
+    }
+    for (int i = 0; i < modify->ncompute; i++) {
+      Compute *compute = modify->compute[i];
+      reduce(compute->time_total,tmin,tavg,tmax);
+      if (me == 0)
+	fprintf(logfp,BIGINT_FORMAT ",compute,%s,%s,%g,%g,%g\n",
+		ntimestep,compute->id,compute->style,tmin,tavg,tmax);
+    }
+  }
+
+  if (me == 0) fflush(logfp);
+}
@@ -14,6 +14,7 @@
 #ifndef LMP_TIMER_H
 #define LMP_TIMER_H
 
+#include "stdio.h"
 #include "pointers.h"
 
 enum{TIME_LOOP,TIME_PAIR,TIME_BOND,TIME_KSPACE,TIME_NEIGHBOR,
@@ -24,6 +25,8 @@ namespace LAMMPS_NS {
 class Timer : protected Pointers {
  public:
   double *array;
+  int fullflag;                  // 1 if each fix and compute is timed
+  int logevery;                  // write timing log every this many steps
 
   Timer(class LAMMPS *);
   ~Timer();
@@ -33,11 +36,31 @@ class Timer : protected Pointers {
   void barrier_start(int);
   void barrier_stop(int);
   double elapsed(int);
+  void modify_params(int, char **);
+  void reduce(double, double &, double &, double &);
+  void write_log(bigint);
 
  private:
+  int me;
   double previous_time;
+  FILE *logfp;                   // timing log, only open on proc 0
 };
 
 }
 
 #endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Cannot open timer log file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+*/
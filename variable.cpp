@@ -38,6 +38,8 @@ using namespace MathConst;
 
 #define VARDELTA 4
 #define MAXLEVEL 4
+#define VARBLOCK 256        // atoms per block in compiled atom-style formulas
+#define PROGDELTA 16        // growth of compiled program
 
 #define MYROUND(a) (( a-floor(a) ) >= .5) ? ceil(a) : floor(a)
 
@@ -51,7 +53,7 @@ enum{DONE,ADD,SUBTRACT,MULTIPLY,DIVIDE,CARAT,UNARY,
        SQRT,EXP,LN,LOG,SIN,COS,TAN,ASIN,ACOS,ATAN,ATAN2,
        RANDOM,NORMAL,CEIL,FLOOR,ROUND,RAMP,STAGGER,LOGFREQ,
        VDISPLACE,SWIGGLE,CWIGGLE,GMASK,RMASK,GRMASK,
-       VALUE,ATOMARRAY,TYPEARRAY,INTARRAY};
+       VALUE,ATOMARRAY,TYPEARRAY,INTARRAY,SUBTREE,SELAND,SELOR};
 
 // customize by adding a special function
 
@@ -81,6 +83,13 @@ Variable::Variable(LAMMPS *lmp) : Pointers(lmp)
   randomequal = NULL;
   randomatom = NULL;
 
+  program = NULL;
+  nprogram = maxprogram = 0;
+  registers = NULL;
+  nregister = maxregister = 0;
+  selects = NULL;
+  nselect = maxselect = 0;
+
   precedence[DONE] = 0;
   precedence[OR] = 1;
   precedence[AND] = 2;
@@ -111,6 +120,10 @@ Variable::~Variable()
 
   delete randomequal;
   delete randomatom;
+
+  memory->sfree(program);
+  memory->destroy(registers);
+  memory->destroy(selects);
 }
 
 /* ----------------------------------------------------------------------
@@ -491,23 +504,51 @@ void Variable::compute_atom(int ivar, int igroup,
   double tmp = evaluate(data[ivar][0],&tree);
   tmp = collapse_tree(tree);
 
+  // flatten the tree into a program that works on blocks of atoms
+  // random numbers must be drawn atom by atom in tree order,
+  //   so a tree with RANDOM or NORMAL is evaluated per atom as a whole
+
+  nprogram = nregister = 0;
+  nselect = 1;
+  if (random_tree(tree)) add_instruction(SUBTREE,0,-1,-1,-1,0,tree);
+  else compile_tree(tree,0,0);
+
+  if (nregister > maxregister) {
+    maxregister = nregister;
+    memory->destroy(registers);
+    memory->create(registers,maxregister,VARBLOCK,"variable:registers");
+  }
+  if (nselect > maxselect) {
+    maxselect = nselect;
+    memory->destroy(selects);
+    memory->create(selects,maxselect,VARBLOCK,"variable:selects");
+  }
+
   int groupbit = group->bitmask[igroup];
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  if (sumflag == 0) {
-    int m = 0;
-    for (int i = 0; i < nlocal; i++) {
-      if (mask[i] & groupbit) result[m] = eval_tree(tree,i);
-      else result[m] = 0.0;
-      m += stride;
-    }
-
-  } else {
-    int m = 0;
-    for (int i = 0; i < nlocal; i++) {
-      if (mask[i] && groupbit) result[m] += eval_tree(tree,i);
-      m += stride;
+  int k,n,sel[VARBLOCK];
+  double *value = registers[0];
+  int m = 0;
+
+  for (int ifirst = 0; ifirst < nlocal; ifirst += VARBLOCK) {
+    n = nlocal - ifirst;
+    if (n > VARBLOCK) n = VARBLOCK;
+    for (k = 0; k < n; k++) sel[k] = mask[ifirst+k] & groupbit;
+    eval_program(ifirst,n,sel);
+
+    if (sumflag == 0) {
+      for (k = 0; k < n; k++) {
+	if (sel[k]) result[m] = value[k];
+	else result[m] = 0.0;
+	m += stride;
+      }
+    } else {
+      for (k = 0; k < n; k++) {
+	if (sel[k]) result[m] += value[k];
+	m += stride;
+      }
     }
   }
 
@@ -2035,6 +2076,346 @@ double Variable::eval_tree(Tree *tree, int i)
   return 0.0;
 }
 
+/* ----------------------------------------------------------------------
+   return 1 if tree contains a random number function, else 0
+------------------------------------------------------------------------- */
+
+int Variable::random_tree(Tree *tree)
+{
+  if (tree->type == RANDOM || tree->type == NORMAL) return 1;
+  if (tree->left && random_tree(tree->left)) return 1;
+  if (tree->middle && random_tree(tree->middle)) return 1;
+  if (tree->right && random_tree(tree->right)) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   append instructions that leave the value of tree in register reg
+   operands of a node go to registers reg, reg+1, reg+2
+   nodes not compiled here are evaluated per atom via eval_tree()
+   isel = selection of atoms the value is needed for, 0 = atoms in group
+------------------------------------------------------------------------- */
+
+void Variable::compile_tree(Tree *tree, int reg, int isel)
+{
+  int inarrow;
+
+  switch (tree->type) {
+  case VALUE:
+  case ATOMARRAY:
+  case TYPEARRAY:
+  case INTARRAY:
+  case GMASK:
+  case RMASK:
+  case GRMASK:
+    add_instruction(tree->type,reg,-1,-1,-1,isel,tree);
+    break;
+
+  case UNARY: case NOT:
+  case SQRT: case EXP: case LN: case LOG:
+  case SIN: case COS: case TAN: case ASIN: case ACOS: case ATAN:
+  case CEIL: case FLOOR: case ROUND:
+    compile_tree(tree->left,reg,isel);
+    add_instruction(tree->type,reg,reg,-1,-1,isel,tree);
+    break;
+
+  case ADD: case SUBTRACT: case MULTIPLY: case DIVIDE: case CARAT:
+  case EQ: case NE: case LT: case LE: case GT: case GE:
+  case ATAN2: case RAMP: case VDISPLACE:
+    compile_tree(tree->left,reg,isel);
+    compile_tree(tree->right,reg+1,isel);
+    add_instruction(tree->type,reg,reg,reg+1,-1,isel,tree);
+    break;
+
+  // right operand only for atoms where left one does not decide result,
+  //   as in eval_tree(), so it can guard against domain errors
+
+  case AND: case OR:
+    compile_tree(tree->left,reg,isel);
+    inarrow = nselect++;
+    add_instruction(tree->type == AND ? SELAND : SELOR,
+		    inarrow,reg,-1,-1,isel,tree);
+    compile_tree(tree->right,reg+1,inarrow);
+    add_instruction(tree->type,reg,reg,reg+1,-1,isel,tree);
+    break;
+
+  case SWIGGLE: case CWIGGLE:
+    compile_tree(tree->left,reg,isel);
+    compile_tree(tree->middle,reg+1,isel);
+    compile_tree(tree->right,reg+2,isel);
+    add_instruction(tree->type,reg,reg,reg+1,reg+2,isel,tree);
+    break;
+
+  default:
+    add_instruction(SUBTREE,reg,-1,-1,-1,isel,tree);
+    break;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   for SELAND and SELOR, dest is the selection they create
+------------------------------------------------------------------------- */
+
+void Variable::add_instruction(int op, int dest, int src1, int src2, int src3,
+			       int isel, Tree *tree)
+{
+  if (nprogram == maxprogram) {
+    maxprogram += PROGDELTA;
+    program = (Instruction *)
+      memory->srealloc(program,maxprogram*sizeof(Instruction),
+		       "variable:program");
+  }
+
+  Instruction *in = &program[nprogram++];
+  in->op = op;
+  in->dest = dest;
+  in->src1 = src1;
+  in->src2 = src2;
+  in->src3 = src3;
+  in->sel = isel;
+  in->tree = tree;
+
+  if (op == SELAND || op == SELOR) {
+    if (src1+1 > nregister) nregister = src1+1;
+    return;
+  }
+
+  int maxreg = dest;
+  if (src1 > maxreg) maxreg = src1;
+  if (src2 > maxreg) maxreg = src2;
+  if (src3 > maxreg) maxreg = src3;
+  if (maxreg+1 > nregister) nregister = maxreg+1;
+}
+
+/* ----------------------------------------------------------------------
+   run the compiled program for N atoms starting at ifirst
+   result is left in register 0
+   sel = 1 for atoms in the group, only they are checked for domain errors,
+     results for other atoms are discarded by the caller
+   AND/OR narrow the selection their right operand is evaluated for
+------------------------------------------------------------------------- */
+
+void Variable::eval_program(int ifirst, int n, int *sel)
+{
+  int k,bad;
+  double delta,omega;
+  double *a,*b,*c,*r;
+  int *s,*snew;
+
+  int *type = atom->type;
+  int *mask = atom->mask;
+  double **x = atom->x;
+
+  for (int ip = 0; ip < nprogram; ip++) {
+    Instruction *in = &program[ip];
+    Tree *tree = in->tree;
+    if (in->op == SELAND || in->op == SELOR) r = NULL;
+    else r = registers[in->dest];
+    a = in->src1 >= 0 ? registers[in->src1] : NULL;
+    b = in->src2 >= 0 ? registers[in->src2] : NULL;
+    c = in->src3 >= 0 ? registers[in->src3] : NULL;
+    s = in->sel ? selects[in->sel] : sel;
+    bad = 0;
+
+    switch (in->op) {
+    case SELAND:
+      snew = selects[in->dest];
+      for (k = 0; k < n; k++) snew[k] = s[k] && a[k] != 0.0;
+      break;
+    case SELOR:
+      snew = selects[in->dest];
+      for (k = 0; k < n; k++) snew[k] = s[k] && a[k] == 0.0;
+      break;
+
+    case VALUE:
+      for (k = 0; k < n; k++) r[k] = tree->value;
+      break;
+    case ATOMARRAY: {
+      double *array = &tree->array[ifirst*tree->nstride];
+      int nstride = tree->nstride;
+      for (k = 0; k < n; k++) r[k] = array[k*nstride];
+      break;
+    }
+    case TYPEARRAY:
+      for (k = 0; k < n; k++) r[k] = tree->array[type[ifirst+k]];
+      break;
+    case INTARRAY: {
+      int *iarray = &tree->iarray[ifirst*tree->nstride];
+      int nstride = tree->nstride;
+      for (k = 0; k < n; k++) r[k] = (double) iarray[k*nstride];
+      break;
+    }
+
+    case ADD:
+      for (k = 0; k < n; k++) r[k] = a[k] + b[k];
+      break;
+    case SUBTRACT:
+      for (k = 0; k < n; k++) r[k] = a[k] - b[k];
+      break;
+    case MULTIPLY:
+      for (k = 0; k < n; k++) r[k] = a[k] * b[k];
+      break;
+    case DIVIDE:
+      for (k = 0; k < n; k++) if (s[k] && b[k] == 0.0) bad = 1;
+      if (bad) error->one(FLERR,"Divide by 0 in variable formula");
+      for (k = 0; k < n; k++) r[k] = a[k] / b[k];
+      break;
+    case CARAT:
+      for (k = 0; k < n; k++) if (s[k] && b[k] == 0.0) bad = 1;
+      if (bad) error->one(FLERR,"Power by 0 in variable formula");
+      for (k = 0; k < n; k++) r[k] = pow(a[k],b[k]);
+      break;
+    case UNARY:
+      for (k = 0; k < n; k++) r[k] = -a[k];
+      break;
+
+    case NOT:
+      for (k = 0; k < n; k++) r[k] = (a[k] == 0.0) ? 1.0 : 0.0;
+      break;
+    case EQ:
+      for (k = 0; k < n; k++) r[k] = (a[k] == b[k]) ? 1.0 : 0.0;
+      break;
+    case NE:
+      for (k = 0; k < n; k++) r[k] = (a[k] != b[k]) ? 1.0 : 0.0;
+      break;
+    case LT:
+      for (k = 0; k < n; k++) r[k] = (a[k] < b[k]) ? 1.0 : 0.0;
+      break;
+    case LE:
+      for (k = 0; k < n; k++) r[k] = (a[k] <= b[k]) ? 1.0 : 0.0;
+      break;
+    case GT:
+      for (k = 0; k < n; k++) r[k] = (a[k] > b[k]) ? 1.0 : 0.0;
+      break;
+    case GE:
+      for (k = 0; k < n; k++) r[k] = (a[k] >= b[k]) ? 1.0 : 0.0;
+      break;
+    case AND:
+      for (k = 0; k < n; k++) 
+	r[k] = (a[k] != 0.0 && b[k] != 0.0) ? 1.0 : 0.0;
+      break;
+    case OR:
+      for (k = 0; k < n; k++) 
+	r[k] = (a[k] != 0.0 || b[k] != 0.0) ? 1.0 : 0.0;
+      break;
+
+    case SQRT:
+      for (k = 0; k < n; k++) if (s[k] && a[k] < 0.0) bad = 1;
+      if (bad) error->one(FLERR,"Sqrt of negative value in variable formula");
+      for (k = 0; k < n; k++) r[k] = sqrt(a[k]);
+      break;
+    case EXP:
+      for (k = 0; k < n; k++) r[k] = exp(a[k]);
+      break;
+    case LN:
+      for (k = 0; k < n; k++) if (s[k] && a[k] <= 0.0) bad = 1;
+      if (bad) 
+	error->one(FLERR,"Log of zero/negative value in variable formula");
+      for (k = 0; k < n; k++) r[k] = log(a[k]);
+      break;
+    case LOG:
+      for (k = 0; k < n; k++) if (s[k] && a[k] <= 0.0) bad = 1;
+      if (bad) 
+	error->one(FLERR,"Log of zero/negative value in variable formula");
+      for (k = 0; k < n; k++) r[k] = log10(a[k]);
+      break;
+
+    case SIN:
+      for (k = 0; k < n; k++) r[k] = sin(a[k]);
+      break;
+    case COS:
+      for (k = 0; k < n; k++) r[k] = cos(a[k]);
+      break;
+    case TAN:
+      for (k = 0; k < n; k++) r[k] = tan(a[k]);
+      break;
+    case ASIN:
+      for (k = 0; k < n; k++) 
+	if (s[k] && (a[k] < -1.0 || a[k] > 1.0)) bad = 1;
+      if (bad) error->one(FLERR,"Arcsin of invalid value in variable formula");
+      for (k = 0; k < n; k++) r[k] = asin(a[k]);
+      break;
+    case ACOS:
+      for (k = 0; k < n; k++) 
+	if (s[k] && (a[k] < -1.0 || a[k] > 1.0)) bad = 1;
+      if (bad) error->one(FLERR,"Arccos of invalid value in variable formula");
+      for (k = 0; k < n; k++) r[k] = acos(a[k]);
+      break;
+    case ATAN:
+      for (k = 0; k < n; k++) r[k] = atan(a[k]);
+      break;
+    case ATAN2:
+      for (k = 0; k < n; k++) r[k] = atan2(a[k],b[k]);
+      break;
+
+    case CEIL:
+      for (k = 0; k < n; k++) r[k] = ceil(a[k]);
+      break;
+    case FLOOR:
+      for (k = 0; k < n; k++) r[k] = floor(a[k]);
+      break;
+    case ROUND:
+      for (k = 0; k < n; k++) r[k] = MYROUND(a[k]);
+      break;
+
+    case RAMP:
+      delta = update->ntimestep - update->beginstep;
+      delta /= update->endstep - update->beginstep;
+      for (k = 0; k < n; k++) r[k] = a[k] + delta*(b[k]-a[k]);
+      break;
+    case VDISPLACE:
+      delta = update->ntimestep - update->beginstep;
+      for (k = 0; k < n; k++) r[k] = a[k] + b[k]*delta*update->dt;
+      break;
+    case SWIGGLE:
+      for (k = 0; k < n; k++) if (s[k] && c[k] == 0.0) bad = 1;
+      if (bad) error->one(FLERR,"Invalid math function in variable formula");
+      delta = update->ntimestep - update->beginstep;
+      for (k = 0; k < n; k++) {
+	omega = 2.0*MY_PI/c[k];
+	r[k] = a[k] + b[k]*sin(omega*delta*update->dt);
+      }
+      break;
+    case CWIGGLE:
+      for (k = 0; k < n; k++) if (s[k] && c[k] == 0.0) bad = 1;
+      if (bad) error->one(FLERR,"Invalid math function in variable formula");
+      delta = update->ntimestep - update->beginstep;
+      for (k = 0; k < n; k++) {
+	omega = 2.0*MY_PI/c[k];
+	r[k] = a[k] + b[k]*(1.0-cos(omega*delta*update->dt));
+      }
+      break;
+
+    case GMASK:
+      for (k = 0; k < n; k++) 
+	r[k] = (mask[ifirst+k] & tree->ivalue1) ? 1.0 : 0.0;
+      break;
+    case RMASK: {
+      Region *region = domain->regions[tree->ivalue1];
+      for (k = 0; k < n; k++) {
+	double *xk = x[ifirst+k];
+	r[k] = region->inside(xk[0],xk[1],xk[2]) ? 1.0 : 0.0;
+      }
+      break;
+    }
+    case GRMASK: {
+      Region *region = domain->regions[tree->ivalue2];
+      for (k = 0; k < n; k++) {
+	double *xk = x[ifirst+k];
+	r[k] = ((mask[ifirst+k] & tree->ivalue1) && 
+		region->inside(xk[0],xk[1],xk[2])) ? 1.0 : 0.0;
+      }
+      break;
+    }
+
+    case SUBTREE:
+      for (k = 0; k < n; k++) 
+	r[k] = s[k] ? eval_tree(tree,ifirst+k) : 0.0;
+      break;
+    }
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Variable::free_tree(Tree *tree)
@@ -61,6 +61,24 @@ class Variable : protected Pointers {
     Tree *left,*middle,*right;
   };
 
+  // flattened parse tree, evaluated for a block of atoms at a time
+  // each instruction applies one tree node to whole registers
+
+  struct Instruction {
+    int op;                // node type, SUBTREE = evaluate node per atom
+    int dest;              // register that receives the result
+    int src1,src2,src3;    // registers that hold the operands
+    int sel;               // selection of atoms it is needed for
+    Tree *tree;            // node the instruction was compiled from
+  };
+
+  Instruction *program;    // current program
+  int nprogram,maxprogram;
+  double **registers;      // values of each register for one block of atoms
+  int nregister,maxregister;
+  int **selects;           // atoms each selection holds, 0 = caller's sel
+  int nselect,maxselect;
+
   void remove(int);
   void extend();
   void copy(int, char **, char **);
@@ -68,6 +86,10 @@ class Variable : protected Pointers {
   double collapse_tree(Tree *);
   double eval_tree(Tree *, int);
   void free_tree(Tree *);
+  int random_tree(Tree *);
+  void compile_tree(Tree *, int, int);
+  void add_instruction(int, int, int, int, int, int, Tree *);
+  void eval_program(int, int, int *);
   int find_matching_paren(char *, int, char *&);
   int math_function(char *, char *, Tree **, Tree **, int &, double *, int &);
   int group_function(char *, char *, Tree **, Tree **, int &, double *, int &);
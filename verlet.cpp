@@ -19,6 +19,7 @@
 #include "atom.h"
 #include "force.h"
 #include "pair.h"
+#include "neigh_list.h"
 #include "bond.h"
 #include "angle.h"
 #include "dihedral.h"
@@ -38,7 +39,21 @@ using namespace LAMMPS_NS;
 /* ---------------------------------------------------------------------- */
 
 Verlet::Verlet(LAMMPS *lmp, int narg, char **arg) :
-  Integrate(lmp, narg, arg) {}
+  Integrate(lmp, narg, arg)
+{
+  fuseflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"fuse") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal run_style verlet command");
+      if (strcmp(arg[iarg+1],"yes") == 0) fuseflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) fuseflag = 0;
+      else error->all(FLERR,"Illegal run_style verlet command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal run_style verlet command");
+  }
+}
 
 /* ----------------------------------------------------------------------
    initialization before run
@@ -199,7 +214,7 @@ void Verlet::setup_minimal(int flag)
 void Verlet::run(int n)
 {
   bigint ntimestep;
-  int nflag,sortflag;
+  int nflag,sortflag,overlap;
 
   int n_post_integrate = modify->n_post_integrate;
   int n_pre_exchange = modify->n_pre_exchange;
@@ -223,11 +238,17 @@ void Verlet::run(int n)
 
     // regular communication vs neighbor list rebuild
 
+    // overlap ghost comm with pair forces on steps without tallies
+
     nflag = neighbor->decide();
+    overlap = 0;
+    if (nflag == 0 && comm->overlap && force->pair && 
+	force->pair->overlap_flag && !eflag && !vflag) overlap = 1;
 
     if (nflag == 0) {
       timer->stamp();
-      comm->forward_comm();
+      if (overlap) comm->forward_comm_start();
+      else comm->forward_comm();
       timer->stamp(TIME_COMM);
     } else {
       if (n_pre_exchange) modify->pre_exchange();
@@ -251,40 +272,54 @@ void Verlet::run(int n)
 
     // force computations
 
+    // fixes may need ghost coords in pre_force()
+
     force_clear();
+    if (overlap && n_pre_force) {
+      timer->stamp();
+      comm->forward_comm_finish();
+      timer->stamp(TIME_COMM);
+    }
     if (n_pre_force) modify->pre_force(vflag);
 
     timer->stamp();
 
-    if (force->pair) {
-      force->pair->compute(eflag,vflag);
-      timer->stamp(TIME_PAIR);
-    }
+    if (overlap) force_overlap(n_pre_force == 0);
+    else {
+      if (force->pair) {
+	force->pair->compute(eflag,vflag);
+	timer->stamp(TIME_PAIR);
+      }
 
-    if (atom->molecular) {
-      if (force->bond) force->bond->compute(eflag,vflag);
-      if (force->angle) force->angle->compute(eflag,vflag);
-      if (force->dihedral) force->dihedral->compute(eflag,vflag);
-      if (force->improper) force->improper->compute(eflag,vflag);
-      timer->stamp(TIME_BOND);
-    }
+      if (atom->molecular) {
+	if (force->bond) force->bond->compute(eflag,vflag);
+	if (force->angle) force->angle->compute(eflag,vflag);
+	if (force->dihedral) force->dihedral->compute(eflag,vflag);
+	if (force->improper) force->improper->compute(eflag,vflag);
+	timer->stamp(TIME_BOND);
+      }
 
-    if (force->kspace) {
-      force->kspace->compute(eflag,vflag);
-      timer->stamp(TIME_KSPACE);
-    }
+      if (force->kspace) {
+	force->kspace->compute(eflag,vflag);
+	timer->stamp(TIME_KSPACE);
+      }
 
-    // reverse communication of forces
+      // reverse communication of forces
 
-    if (force->newton) {
-      comm->reverse_comm();
-      timer->stamp(TIME_COMM);
+      if (force->newton) {
+	comm->reverse_comm();
+	timer->stamp(TIME_COMM);
+      }
     }
 
     // force modifications, final time integration, diagnostics
+    // fused = both applied block by block in a single pass over atoms
 
-    if (n_post_force) modify->post_force(vflag);
-    modify->final_integrate();
+    if (fuseflag && modify->fuse_any) modify->post_force_final_integrate(vflag);
+    else {
+      if (n_post_force) modify->post_force(vflag);
+      modify->final_integrate();
+    }
     if (n_end_of_step) modify->end_of_step();
 
     // all output
@@ -294,9 +329,94 @@ void Verlet::run(int n)
       output->write(ntimestep);
       timer->stamp(TIME_OUTPUT);
     }
+
+    if (timer->logevery && ntimestep % timer->logevery == 0)
+      timer->write_log(ntimestep);
   }
 }
 
+/* ----------------------------------------------------------------------
+   force computation with ghost comm in flight
+   pair forces on atoms w/out ghost neighbors are split in two parts,
+     one computed before forward comm of ghost coords is completed,
+     one after reverse comm of ghost forces is posted
+   forward_pending = 1 if forward comm was started but not completed
+   only used when no energy/virial is tallied on this step,
+     since each split call of pair compute() resets the tallies
+------------------------------------------------------------------------- */
+
+void Verlet::force_overlap(int forward_pending)
+{
+  Pair *pair = force->pair;
+  pair->overlap_partition();
+
+  int inum = pair->list->inum;
+  int ninterior = pair->ninterior;
+
+  int nfirst = 0;
+  if (forward_pending) {
+    if (force->newton) nfirst = ninterior/2;
+    else nfirst = ninterior;
+  }
+
+  pair->overlap_pass = 0;
+  pair_compute_range(0,nfirst);
+  timer->stamp(TIME_PAIR);
+
+  if (forward_pending) {
+    comm->forward_comm_finish();
+    timer->stamp(TIME_COMM);
+  }
+
+  pair_compute_range(ninterior,inum-ninterior);
+  if (!force->newton) pair_compute_range(nfirst,ninterior-nfirst);
+  timer->stamp(TIME_PAIR);
+
+  if (atom->molecular) {
+    if (force->bond) force->bond->compute(eflag,vflag);
+    if (force->angle) force->angle->compute(eflag,vflag);
+    if (force->dihedral) force->dihedral->compute(eflag,vflag);
+    if (force->improper) force->improper->compute(eflag,vflag);
+    timer->stamp(TIME_BOND);
+  }
+
+  // kspace does its own comm, so it is done before reverse comm is posted
+
+  if (force->kspace) {
+    force->kspace->compute(eflag,vflag);
+    timer->stamp(TIME_KSPACE);
+  }
+
+  if (force->newton) {
+    comm->reverse_comm_start();
+    timer->stamp(TIME_COMM);
+    pair_compute_range(nfirst,ninterior-nfirst);
+    timer->stamp(TIME_PAIR);
+    comm->reverse_comm_finish();
+    timer->stamp(TIME_COMM);
+  }
+
+  pair->overlap_pass = 0;
+}
+
+/* ----------------------------------------------------------------------
+   invoke pair compute() on N atoms of ilist starting at FIRST
+------------------------------------------------------------------------- */
+
+void Verlet::pair_compute_range(int first, int n)
+{
+  NeighList *list = force->pair->list;
+  int inum = list->inum;
+  int *ilist = list->ilist;
+
+  list->inum = n;
+  list->ilist = &ilist[first];
+  force->pair->overlap_pass++;
+  force->pair->compute(eflag,vflag);
+  list->inum = inum;
+  list->ilist = ilist;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Verlet::cleanup()
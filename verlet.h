@@ -40,8 +40,12 @@ class Verlet : public Integrate {
   int triclinic;                    // 0 if domain is orthog, 1 if triclinic
   int torqueflag,erforceflag;
   int e_flag,rho_flag;
+  int fuseflag;                     // 1 if fixes may fuse post_force
+                                    //   and final_integrate atom loops
 
   void force_clear();
+  void force_overlap(int);
+  void pair_compute_range(int, int);
 };
 
 }
@@ -51,6 +55,11 @@ class Verlet : public Integrate {
 
 /* ERROR/WARNING messages:
 
+E: Illegal run_style verlet command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
 W: No fixes defined, atoms won't move
 
 If you are not using a fix like nve, nvt, npt then atom velocities and
@@ -52,7 +52,7 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
        BOXLO_0,BOXHI_0,BOXLO_1,BOXHI_1,BOXLO_2,BOXHI_2,
        SPECIAL_LJ_1,SPECIAL_LJ_2,SPECIAL_LJ_3,
        SPECIAL_COUL_1,SPECIAL_COUL_2,SPECIAL_COUL_3,
-       XY,XZ,YZ};
+       XY,XZ,YZ,PROCBLOCKS};
 enum{MASS};
 enum{PAIR,BOND,ANGLE,DIHEDRAL,IMPROPER};
 
@@ -140,6 +140,14 @@ void WriteRestart::write(char *file)
   if (strchr(file,'%')) multiproc = 1;
   else multiproc = 0;
 
+  // check if single file ends in ".par"
+  // if so, each proc writes its own block at an offset set by proc 0
+
+  blockflag = 0;
+  char *suffix = file + strlen(file) - strlen(".par");
+  if (multiproc == 0 && suffix > file && strcmp(suffix,".par") == 0)
+    blockflag = 1;
+
   // open single restart file or base file for multiproc case
 
   if (me == 0) {
@@ -238,6 +246,9 @@ void WriteRestart::write(char *file)
     }
   }
 
+  // if single file with blocks:
+  //   proc 0 gathers chunk sizes, writes table of sizes and offsets
+  //   each proc then writes its chunk at its offset in the same file
   // if single file:
   //   write one chunk of atoms per proc to file
   //   proc 0 pings each proc, receives its chunk, writes to file
@@ -245,7 +256,55 @@ void WriteRestart::write(char *file)
   // else if one file per proc:
   //   each proc opens its own file and writes its chunk directly
 
-  if (multiproc == 0) {
+  if (blockflag) {
+    int *sizes = NULL;
+    bigint *offsets = NULL;
+    int *counts = NULL;
+    int *displs = NULL;
+    if (me == 0) {
+      sizes = new int[nprocs];
+      offsets = new bigint[nprocs];
+      counts = new int[nprocs];
+      displs = new int[nprocs];
+      for (int iproc = 0; iproc < nprocs; iproc++) {
+	counts[iproc] = 1;
+	displs[iproc] = iproc;
+      }
+    }
+    MPI_Gather(&send_size,1,MPI_INT,sizes,1,MPI_INT,0,world);
+
+    if (me == 0) {
+      bigint offset = ftell(fp) + nprocs*(sizeof(int) + sizeof(bigint));
+      for (int iproc = 0; iproc < nprocs; iproc++) {
+	offsets[iproc] = offset;
+	offset += (bigint) sizes[iproc] * sizeof(double);
+      }
+      fwrite(sizes,sizeof(int),nprocs,fp);
+      fwrite(offsets,sizeof(bigint),nprocs,fp);
+      fclose(fp);
+    }
+
+    // proc 0 closed file before scatter, so others can now open it
+
+    bigint myoffset;
+    MPI_Scatterv(offsets,counts,displs,MPI_LMP_BIGINT,
+		 &myoffset,1,MPI_LMP_BIGINT,0,world);
+    delete [] sizes;
+    delete [] offsets;
+    delete [] counts;
+    delete [] displs;
+
+    fp = fopen(file,"r+b");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open restart file %s",file);
+      error->one(FLERR,str);
+    }
+    fseek(fp,myoffset,SEEK_SET);
+    fwrite(buf,sizeof(double),send_size,fp);
+    fclose(fp);
+
+  } else if (multiproc == 0) {
     int tmp,recv_size;
     MPI_Status status;
     MPI_Request request;
@@ -374,6 +433,8 @@ void WriteRestart::header()
     write_double(YZ,domain->yz);
   }
 
+  if (blockflag) write_int(PROCBLOCKS,blockflag);
+
   // -1 flag signals end of header
 
   int flag = -1;
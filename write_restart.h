@@ -35,6 +35,7 @@ class WriteRestart : protected Pointers {
   int me,nprocs;
   FILE *fp;
   bigint natoms;         // natoms (sum of nlocal) to write into file
+  int blockflag;         // 1 if procs write own block of single file
 
   void header();
   void type_arrays();